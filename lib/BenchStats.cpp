@@ -0,0 +1,143 @@
+#include "BenchStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <sstream>
+
+namespace benchstats
+{
+double tQuantile95(int degrees_of_freedom)
+{
+	// Two-sided 95% quantiles of the Student t distribution
+	static const double table[] = {
+		12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+		2.262,	2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+		2.110,	2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+		2.060,	2.056, 2.052, 2.048, 2.045, 2.042};
+	if (degrees_of_freedom < 1)
+		return 0.0;
+	if (degrees_of_freedom <= 30)
+		return table[degrees_of_freedom - 1];
+	return 1.96;
+}
+
+Summary summarize(std::vector<double> samples)
+{
+	Summary summary;
+	if (samples.empty())
+		return summary;
+	std::sort(samples.begin(), samples.end());
+	const size_t n = samples.size();
+	summary.samples = static_cast<int>(n);
+	summary.min = samples.front();
+	summary.max = samples.back();
+	summary.median =
+		(n % 2 == 1) ? samples[n / 2]
+					 : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+	summary.mean =
+		std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+	if (n > 1)
+	{
+		double squares = 0.0;
+		for (double sample : samples)
+			squares +=
+				(sample - summary.mean) * (sample - summary.mean);
+		summary.stddev = std::sqrt(squares / (n - 1));
+	}
+	const double half_width = tQuantile95(static_cast<int>(n) - 1) *
+							  summary.stddev / std::sqrt(n);
+	summary.ci_low = summary.mean - half_width;
+	summary.ci_high = summary.mean + half_width;
+	return summary;
+}
+
+std::string csvHeaderColumns(const std::string &unit)
+{
+	const std::string suffix = " (" + unit + ")";
+	return ",Samples,Median" + suffix + ",Min" + suffix + ",Max" +
+		   suffix + ",Mean" + suffix + ",Stddev" + suffix +
+		   ",CI95 low" + suffix + ",CI95 high" + suffix;
+}
+
+std::string csvColumns(const Summary &summary)
+{
+	std::ostringstream columns;
+	columns << "," << summary.samples << "," << summary.median
+			<< "," << summary.min << "," << summary.max << ","
+			<< summary.mean << "," << summary.stddev << ","
+			<< summary.ci_low << "," << summary.ci_high;
+	return columns.str();
+}
+
+ScalingPoint scalingPoint(int workers, double baseline_seconds,
+						  double seconds, bool weak)
+{
+	ScalingPoint point;
+	point.workers = workers;
+	point.seconds = seconds;
+	if (seconds <= 0.0 || workers < 1)
+		return point;
+	point.speedup = baseline_seconds / seconds;
+	if (weak)
+		point.speedup *= workers;
+	point.efficiency = point.speedup / workers;
+	if (workers > 1 && point.speedup > 0.0)
+		point.karp_flatt = (1.0 / point.speedup - 1.0 / workers) /
+						   (1.0 - 1.0 / workers);
+	return point;
+}
+
+Comparison compare(const Summary &baseline,
+				   const Summary &candidate)
+{
+	Comparison comparison;
+	if (baseline.samples == 0 || candidate.samples == 0 ||
+		baseline.median <= 0.0)
+		return comparison;
+	comparison.change = candidate.median / baseline.median - 1.0;
+	const double difference = candidate.mean - baseline.mean;
+	double standard_error = 0.0;
+	double degrees_of_freedom = 0.0;
+	if (baseline.samples > 1 && candidate.samples > 1)
+	{
+		// Welch, unequal variances and sample sizes
+		const double vb =
+			baseline.stddev * baseline.stddev / baseline.samples;
+		const double vc =
+			candidate.stddev * candidate.stddev / candidate.samples;
+		standard_error = std::sqrt(vb + vc);
+		if (vb + vc > 0.0)
+			degrees_of_freedom =
+				(vb + vc) * (vb + vc) /
+				(vb * vb / (baseline.samples - 1) +
+				 vc * vc / (candidate.samples - 1));
+	}
+	else if (baseline.samples > 1 || candidate.samples > 1)
+	{
+		const Summary &spread =
+			baseline.samples > 1 ? baseline : candidate;
+		standard_error = spread.stddev / std::sqrt(spread.samples);
+		degrees_of_freedom = spread.samples - 1;
+	}
+	else
+	{
+		comparison.significant = true;
+		return comparison;
+	}
+	comparison.tested = true;
+	comparison.degrees_of_freedom =
+		std::max(1, static_cast<int>(degrees_of_freedom));
+	if (standard_error <= 0.0)
+	{
+		// No spread at all, any difference is significant
+		comparison.significant = difference != 0.0;
+		return comparison;
+	}
+	comparison.t = difference / standard_error;
+	comparison.significant =
+		std::fabs(comparison.t) >
+		tQuantile95(comparison.degrees_of_freedom);
+	return comparison;
+}
+} // namespace benchstats
\ No newline at end of file
@@ -0,0 +1,102 @@
+// BenchStats.h
+#pragma once
+#include <string>
+#include <vector>
+
+namespace benchstats
+{
+/**
+ * @brief Summary statistics of repeated measurements.
+ */
+struct Summary
+{
+	int samples = 0;
+	double median = 0.0;
+	double min = 0.0;
+	double max = 0.0;
+	double mean = 0.0;
+	// Sample standard deviation (n - 1)
+	double stddev = 0.0;
+	// 95% confidence interval of the mean (Student t)
+	double ci_low = 0.0;
+	double ci_high = 0.0;
+};
+
+/**
+ * @brief Two-sided 95% Student t quantile for the given degrees of
+ * freedom, 1.96 for large samples.
+ */
+double tQuantile95(int degrees_of_freedom);
+
+/**
+ * @brief Computes the summary of a set of samples.
+ *
+ * @param samples The measurements, any order.
+ * @return The summary, all zero if `samples` is empty.
+ */
+Summary summarize(std::vector<double> samples);
+
+/**
+ * @brief CSV header columns of a summary, each prefixed with a
+ * comma, e.g. ",Median (s),Min (s),...".
+ *
+ * @param unit The unit written in parentheses after every column.
+ */
+std::string csvHeaderColumns(const std::string &unit = "s");
+
+/**
+ * @brief CSV values matching `csvHeaderColumns`, each prefixed with
+ * a comma.
+ */
+std::string csvColumns(const Summary &summary);
+
+/**
+ * @brief Parallel metrics of one point of a scaling series.
+ *
+ * Strong scaling keeps the problem fixed, the speedup is T1 / Tp.
+ * Weak scaling grows the problem with the workers, the scaled
+ * speedup is p * T1 / Tp. In both cases the efficiency is the
+ * speedup over p and the Karp-Flatt metric, the experimentally
+ * determined serial fraction, is (1/S - 1/p) / (1 - 1/p); it is
+ * undefined for p = 1 and reported as 0 there.
+ */
+struct ScalingPoint
+{
+	int workers = 1;
+	double seconds = 0.0;
+	double speedup = 0.0;
+	double efficiency = 0.0;
+	double karp_flatt = 0.0;
+};
+
+/**
+ * @brief Metrics of `seconds` on `workers` against the
+ * single-worker `baseline_seconds`.
+ *
+ * @param weak Use the scaled speedup of weak scaling.
+ */
+ScalingPoint scalingPoint(int workers, double baseline_seconds,
+						  double seconds, bool weak);
+
+/**
+ * @brief Candidate timing against a baseline.
+ *
+ * `change` is the relative change of the medians, positive when the
+ * candidate is slower. The significance comes from a Welch t-test
+ * on the means at 95%; when one side has a single sample it is a
+ * one-sample t-test of the other side against that value. Without
+ * two samples on either side nothing is tested, `tested` is false
+ * and `significant` true, so that only the threshold decides.
+ */
+struct Comparison
+{
+	double change = 0.0;
+	double t = 0.0;
+	int degrees_of_freedom = 0;
+	bool tested = false;
+	bool significant = false;
+};
+
+Comparison compare(const Summary &baseline,
+				   const Summary &candidate);
+} // namespace benchstats
\ No newline at end of file
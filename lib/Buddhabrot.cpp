@@ -0,0 +1,308 @@
+#include "Buddhabrot.h"
+
+#include <Random.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace buddhabrot
+{
+namespace
+{
+// Escape iteration of c, 0 if it stays bounded
+int escapeIteration(double cr, double ci, int iterations)
+{
+	double zr = 0.0, zi = 0.0;
+	for (int i = 1; i <= iterations; i++)
+	{
+		const double next_r = zr * zr - zi * zi + cr;
+		zi = 2 * zr * zi + ci;
+		zr = next_r;
+		if (zr * zr + zi * zi >= 4)
+			return i;
+	}
+	return 0;
+}
+
+// Main cardioid and period-2 bulb, bounded without iterating
+bool knownInterior(double cr, double ci)
+{
+	const double x = cr - 0.25;
+	const double q = x * x + ci * ci;
+	if (q * (q + x) <= 0.25 * ci * ci)
+		return true;
+	return (cr + 1) * (cr + 1) + ci * ci <= 0.0625;
+}
+} // namespace
+
+Importance buildImportance(int iterations)
+{
+	constexpr int cells = IMPORTANCE_GRID * IMPORTANCE_GRID;
+	constexpr double cell_size = SAMPLE_SPAN / IMPORTANCE_GRID;
+	// A probe this late is taken as close to the boundary
+	const int late = std::max(1, iterations / 4);
+	std::vector<double> density(cells);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) default(none)           \
+	shared(density, iterations, late, cell_size)
+#endif
+	for (int cell = 0; cell < cells; cell++)
+	{
+		const double x0 =
+			SAMPLE_MIN + (cell % IMPORTANCE_GRID) * cell_size;
+		const double y0 =
+			SAMPLE_MIN + (cell / IMPORTANCE_GRID) * cell_size;
+		int bounded = 0, late_escapes = 0;
+		for (int probe = 0; probe < 9; probe++)
+		{
+			const int escape = escapeIteration(
+				x0 + (probe % 3) * 0.5 * cell_size,
+				y0 + (probe / 3) * 0.5 * cell_size, iterations);
+			bounded += escape == 0;
+			late_escapes += escape >= late;
+		}
+		density[cell] = bounded == 9 ? INTERIOR_WEIGHT
+						: bounded > 0 || late_escapes > 0
+							? BOUNDARY_WEIGHT
+							: 1.0;
+	}
+
+	Importance importance;
+	importance.cdf.resize(cells);
+	importance.weight.resize(cells);
+	double total = 0.0;
+	for (int cell = 0; cell < cells; cell++)
+	{
+		importance.interior_cells +=
+			density[cell] == INTERIOR_WEIGHT;
+		importance.boundary_cells +=
+			density[cell] == BOUNDARY_WEIGHT;
+		total += density[cell];
+		importance.cdf[cell] = total;
+	}
+	for (int cell = 0; cell < cells; cell++)
+	{
+		importance.cdf[cell] /= total;
+		// Uniform cell probability over the sampled one
+		importance.weight[cell] = total / (cells * density[cell]);
+	}
+	return importance;
+}
+
+Stats accumulate(double *histogram, const Window &window,
+				 int iterations, int64_t samples, uint64_t seed,
+				 const Importance *importance, int64_t first_block,
+				 int64_t block_stride)
+{
+	const int64_t pixels =
+		static_cast<int64_t>(window.width) * window.height;
+	const int64_t blocks =
+		(samples + SAMPLE_BLOCK - 1) / SAMPLE_BLOCK;
+	const bool weighted = importance && importance->enabled();
+	constexpr double cell_size = SAMPLE_SPAN / IMPORTANCE_GRID;
+#ifdef _OPENMP
+	const int max_threads = omp_get_max_threads();
+#else
+	const int max_threads = 1;
+#endif
+	// As many private histograms as fit the memory budget
+	const int64_t histogram_bytes = pixels * sizeof(double);
+	const int threads = static_cast<int>(std::max<int64_t>(
+		1,
+		std::min<int64_t>(max_threads, MAX_PRIVATE_HISTOGRAM_BYTES /
+										   histogram_bytes)));
+	std::vector<std::vector<double>> private_histograms(threads);
+	Stats stats;
+	int64_t sampled = 0, escaped = 0, orbit_points = 0;
+
+	const auto sample_start = std::chrono::steady_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads) default(none)            \
+	firstprivate(histogram)                                        \
+	shared(private_histograms, window, iterations, samples, seed,  \
+		   importance, first_block, block_stride, pixels, blocks,  \
+		   weighted, cell_size, threads)                           \
+	reduction(+ : sampled, escaped, orbit_points)
+#endif
+	{
+#ifdef _OPENMP
+		const int thread = omp_get_thread_num();
+#else
+		const int thread = 0;
+#endif
+		// First touch by its own thread, a lone thread adds to the
+		// output directly
+		double *local = histogram;
+		if (threads > 1)
+		{
+			private_histograms[thread].assign(pixels, 0.0);
+			local = private_histograms[thread].data();
+		}
+		std::vector<std::complex<double>> orbit(iterations);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic) nowait
+#endif
+		for (int64_t block = first_block; block < blocks;
+			 block += block_stride)
+		{
+			rng::SplitMix64 random(seed, block);
+			const int64_t first = block * SAMPLE_BLOCK;
+			const int64_t count =
+				std::min(first + SAMPLE_BLOCK, samples) - first;
+			for (int64_t s = 0; s < count; s++)
+			{
+				double cr, ci;
+				double weight = 1.0;
+				if (weighted)
+				{
+					const auto cell_it = std::upper_bound(
+						importance->cdf.begin(),
+						importance->cdf.end(), random.uniform());
+					const int64_t cell = std::min<int64_t>(
+						cell_it - importance->cdf.begin(),
+						importance->cdf.size() - 1);
+					cr = SAMPLE_MIN + (cell % IMPORTANCE_GRID +
+									   random.uniform()) *
+										  cell_size;
+					ci = SAMPLE_MIN + (cell / IMPORTANCE_GRID +
+									   random.uniform()) *
+										  cell_size;
+					weight = importance->weight[cell];
+				}
+				else
+				{
+					cr =
+						SAMPLE_MIN + random.uniform() * SAMPLE_SPAN;
+					ci =
+						SAMPLE_MIN + random.uniform() * SAMPLE_SPAN;
+				}
+				sampled++;
+				if (knownInterior(cr, ci))
+					continue;
+				// The orbit is kept and drawn only if it escapes
+				double zr = 0.0, zi = 0.0;
+				int length = 0;
+				for (int i = 1; i <= iterations; i++)
+				{
+					const double next_r = zr * zr - zi * zi + cr;
+					zi = 2 * zr * zi + ci;
+					zr = next_r;
+					orbit[length++] = std::complex<double>(zr, zi);
+					if (zr * zr + zi * zi >= 4)
+						break;
+				}
+				if (zr * zr + zi * zi < 4)
+					continue;
+				escaped++;
+				for (int k = 0; k < length; k++)
+				{
+					const double col =
+						(orbit[k].real() - window.min_x) /
+						window.step;
+					const double row =
+						(orbit[k].imag() - window.min_y) /
+						window.step;
+					if (col < 0 || row < 0 || col >= window.width ||
+						row >= window.height)
+						continue;
+					local[static_cast<int64_t>(row) * window.width +
+						  static_cast<int64_t>(col)] += weight;
+					orbit_points++;
+				}
+			}
+		}
+	}
+	const auto reduce_start = std::chrono::steady_clock::now();
+
+	// Cache-blocked reduction: every block of the output is summed
+	// over all private histograms by one thread
+	const int64_t reduce_blocks =
+		threads > 1 ? (pixels + REDUCE_BLOCK - 1) / REDUCE_BLOCK
+					: 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) default(none)            \
+	firstprivate(histogram)                                        \
+		shared(private_histograms, pixels, reduce_blocks, threads)
+#endif
+	for (int64_t block = 0; block < reduce_blocks; block++)
+	{
+		const int64_t begin = block * REDUCE_BLOCK;
+		const int64_t end = std::min(begin + REDUCE_BLOCK, pixels);
+		for (int t = 0; t < threads; t++)
+		{
+			const std::vector<double> &local =
+				private_histograms[t];
+			if (local.empty())
+				continue;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+			for (int64_t pos = begin; pos < end; pos++)
+				histogram[pos] += local[pos];
+		}
+	}
+	const auto reduce_end = std::chrono::steady_clock::now();
+
+	stats.samples = sampled;
+	stats.escaped = escaped;
+	stats.orbit_points = orbit_points;
+	stats.threads = threads;
+	stats.sample_seconds =
+		std::chrono::duration<double>(reduce_start - sample_start)
+			.count();
+	stats.reduce_seconds =
+		std::chrono::duration<double>(reduce_end - reduce_start)
+			.count();
+	return stats;
+}
+
+std::vector<int> toCounts(const double *histogram, int64_t size)
+{
+	std::vector<int> counts(size);
+	for (int64_t pos = 0; pos < size; pos++)
+		counts[pos] = static_cast<int>(std::lround(histogram[pos]));
+	return counts;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Samples,Importance,Escaped Samples,Orbit Points,"
+		   "Interior Cells,Boundary Cells,Sample (s),Reduce (s)";
+}
+
+std::string csvColumns(const Stats &stats,
+					   const Importance &importance)
+{
+	std::ostringstream columns;
+	columns << "," << stats.samples << ","
+			<< (importance.enabled() ? "on" : "off") << ","
+			<< stats.escaped << "," << stats.orbit_points << ","
+			<< importance.interior_cells << ","
+			<< importance.boundary_cells << ","
+			<< stats.sample_seconds << "," << stats.reduce_seconds;
+	return columns.str();
+}
+
+std::string describe(const Stats &stats,
+					 const Importance &importance)
+{
+	std::ostringstream text;
+	text << "\tSamples:\t" << stats.samples << "\tImportance:\t"
+		 << (importance.enabled() ? "on" : "off") << "\tEscaped:\t"
+		 << stats.escaped << "\tOrbit points:\t"
+		 << stats.orbit_points << "\tThreads:\t" << stats.threads;
+	if (importance.enabled())
+		text << "\tInterior cells:\t" << importance.interior_cells
+			 << "\tBoundary cells:\t" << importance.boundary_cells;
+	text << "\tSample:\t" << stats.sample_seconds
+		 << "\tseconds\tReduce:\t" << stats.reduce_seconds
+		 << "\tseconds";
+	return text.str();
+}
+} // namespace buddhabrot
@@ -0,0 +1,140 @@
+// Buddhabrot.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace buddhabrot
+{
+// Square the c values are drawn from, [-2, 2] x [-2, 2]
+constexpr double SAMPLE_MIN = -2.0;
+constexpr double SAMPLE_SPAN = 4.0;
+
+/**
+ * @brief Samples drawn from one random stream. Blocks are the unit
+ * threads and ranks share, every block seeds its own stream from
+ * the seed and its index, so the image does not depend on either
+ * count.
+ */
+constexpr int64_t SAMPLE_BLOCK = 4096;
+
+// Cells per axis of the importance map over the sample square
+constexpr int IMPORTANCE_GRID = 256;
+
+// How much more often boundary cells are sampled than exterior ones
+constexpr double BOUNDARY_WEIGHT = 8.0;
+
+/**
+ * @brief How often cells whose probes all stay bounded are sampled
+ * compared to exterior ones. Not 0: escaping points can lie between
+ * the probes.
+ */
+constexpr double INTERIOR_WEIGHT = 1.0 / 16;
+
+/**
+ * @brief Histogram values one thread sums at a time in the
+ * reduction, 16 KiB of doubles: the destination block stays in L1
+ * while the thread histograms stream through.
+ */
+constexpr int64_t REDUCE_BLOCK = 2048;
+
+/**
+ * @brief Memory the per-thread histograms may take together. Larger
+ * images are accumulated by fewer threads, down to a single one
+ * writing straight into the output.
+ */
+constexpr int64_t MAX_PRIVATE_HISTOGRAM_BYTES = int64_t(1) << 31;
+
+/**
+ * @brief Image the orbits are accumulated into. Pixel (row, col)
+ * covers [min_x + col * step, min_x + (col + 1) * step) and
+ * likewise in y.
+ */
+struct Window
+{
+	int width = 0;
+	int height = 0;
+	double min_x = 0.0;
+	double min_y = 0.0;
+	double step = 0.0;
+};
+
+/**
+ * @brief Sampling density over the sample square.
+ *
+ * Every cell of an `IMPORTANCE_GRID` grid is probed at its corners,
+ * edge midpoints and centre. Cells whose probes all stay bounded
+ * are taken as interior and sampled `INTERIOR_WEIGHT` times as
+ * often as exterior ones, since their orbits are mostly not drawn.
+ * Cells with both bounded and escaping probes, or with a probe
+ * escaping late, straddle the boundary and are sampled
+ * `BOUNDARY_WEIGHT` times more often. Every cell keeps a non-zero
+ * density and every orbit is weighted by uniform density / sampled
+ * density, so the histogram estimates the uniform one.
+ */
+struct Importance
+{
+	// Cumulative cell probabilities, row major; empty when uniform
+	std::vector<double> cdf;
+	// Orbit weight of the samples of every cell
+	std::vector<double> weight;
+	int64_t interior_cells = 0;
+	int64_t boundary_cells = 0;
+
+	bool enabled() const { return !cdf.empty(); }
+};
+
+// Probes the grid with an OpenMP loop
+Importance buildImportance(int iterations);
+
+struct Stats
+{
+	int64_t samples = 0;
+	// Samples whose orbit escaped and was accumulated
+	int64_t escaped = 0;
+	// Orbit points that landed in the window
+	int64_t orbit_points = 0;
+	// Threads that accumulated, fewer than the team for large
+	// images
+	int threads = 0;
+	double sample_seconds = 0.0;
+	double reduce_seconds = 0.0;
+};
+
+/**
+ * @brief Accumulates the escaping orbits of `samples` random c
+ * values.
+ *
+ * The samples are split into blocks of `SAMPLE_BLOCK`; this call
+ * takes blocks `first_block`, `first_block + block_stride`, ... so
+ * that ranks can share a run. Every OpenMP thread accumulates into
+ * a private double histogram, exact for counts up to 2^53; no
+ * atomics are involved. The private histograms are then summed into
+ * `histogram` in blocks of `REDUCE_BLOCK` values, the blocks
+ * distributed over the threads. The team is cut so that the private
+ * histograms stay within `MAX_PRIVATE_HISTOGRAM_BYTES`; a single
+ * thread accumulates into `histogram` directly.
+ *
+ * Without importance, c is uniform over the sample square and
+ * points of the main cardioid and period-2 bulb are rejected
+ * without being iterated.
+ *
+ * @param histogram Output, `width * height` values, added to.
+ * @param importance Optional sampling density, null for uniform.
+ */
+Stats accumulate(double *histogram, const Window &window,
+				 int iterations, int64_t samples, uint64_t seed,
+				 const Importance *importance = nullptr,
+				 int64_t first_block = 0, int64_t block_stride = 1);
+
+// Histogram rounded to the int32 counts of the binary format
+std::vector<int> toCounts(const double *histogram, int64_t size);
+
+// ",Samples,Importance,Escaped Samples,Orbit Points,..."
+std::string csvHeaderColumns();
+std::string csvColumns(const Stats &stats,
+					   const Importance &importance);
+// One tab separated line for the log
+std::string describe(const Stats &stats,
+					 const Importance &importance);
+} // namespace buddhabrot
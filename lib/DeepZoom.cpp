@@ -0,0 +1,585 @@
+#include "DeepZoom.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace deepzoom
+{
+Fixed::Fixed(int limbs) : limb(std::max(limbs, 2), 0u) {}
+
+Fixed Fixed::fromDouble(double value, int limbs)
+{
+	Fixed result(limbs);
+	double magnitude = std::fabs(value);
+	const double integer = std::floor(magnitude);
+	result.limb[0] = static_cast<uint32_t>(integer);
+	magnitude -= integer;
+	// Scaling by 2^32 is exact, so every mantissa bit lands in a
+	// limb
+	for (size_t k = 1; k < result.limb.size() && magnitude > 0.0;
+		 k++)
+	{
+		magnitude *= 4294967296.0;
+		const double digit = std::floor(magnitude);
+		result.limb[k] = static_cast<uint32_t>(digit);
+		magnitude -= digit;
+	}
+	return value < 0.0 ? -result : result;
+}
+
+Fixed Fixed::parse(const std::string &text, int limbs)
+{
+	size_t pos = 0;
+	bool negative = false;
+	if (pos < text.size() && (text[pos] == '-' || text[pos] == '+'))
+		negative = text[pos++] == '-';
+	std::string digits;
+	long point = -1;
+	for (;
+		 pos < text.size() && text[pos] != 'e' && text[pos] != 'E';
+		 pos++)
+	{
+		if (text[pos] == '.' && point < 0)
+			point = static_cast<long>(digits.size());
+		else if (text[pos] >= '0' && text[pos] <= '9')
+			digits += text[pos];
+		else
+			throw std::invalid_argument("not a decimal number: " +
+										text);
+	}
+	if (digits.empty())
+		throw std::invalid_argument("not a decimal number: " +
+									text);
+	if (point < 0)
+		point = static_cast<long>(digits.size());
+	if (pos < text.size())
+	{
+		size_t used = 0;
+		const std::string exponent = text.substr(pos + 1);
+		point += std::stol(exponent, &used);
+		if (used != exponent.size())
+			throw std::invalid_argument("not a decimal number: " +
+										text);
+	}
+	// Move the decimal point onto the digits
+	if (point < 0)
+	{
+		digits.insert(0, static_cast<size_t>(-point), '0');
+		point = 0;
+	}
+	else if (point > static_cast<long>(digits.size()))
+		digits.append(point - digits.size(), '0');
+	const std::string integer_digits = digits.substr(0, point);
+	const std::string fraction_digits = digits.substr(point);
+
+	uint64_t integer = 0;
+	for (const char digit : integer_digits)
+	{
+		integer = integer * 10 + (digit - '0');
+		if (integer > 0x7fffffffu)
+			throw std::out_of_range("integer part too large: " +
+									text);
+	}
+	// Horner from the last digit: f = (f + d) / 10
+	Fixed result(limbs);
+	for (auto digit = fraction_digits.rbegin();
+		 digit != fraction_digits.rend(); ++digit)
+	{
+		result.limb[0] = static_cast<uint32_t>(*digit - '0');
+		result.divide(10);
+	}
+	result.limb[0] = static_cast<uint32_t>(integer);
+	return negative ? -result : result;
+}
+
+void Fixed::divide(uint32_t divisor)
+{
+	uint64_t remainder = 0;
+	for (uint32_t &digit : limb)
+	{
+		const uint64_t current = (remainder << 32) | digit;
+		digit = static_cast<uint32_t>(current / divisor);
+		remainder = current % divisor;
+	}
+}
+
+double Fixed::toDouble() const
+{
+	const Fixed magnitude = negative() ? -*this : *this;
+	double value = 0.0;
+	// Limbs past the double mantissa add nothing
+	const size_t used = std::min<size_t>(limb.size(), 4);
+	for (size_t k = used; k-- > 0;)
+		value += std::ldexp(static_cast<double>(magnitude.limb[k]),
+							-32 * static_cast<int>(k));
+	return negative() ? -value : value;
+}
+
+Fixed Fixed::operator+(const Fixed &other) const
+{
+	Fixed result(limbs());
+	uint64_t carry = 0;
+	for (size_t k = limb.size(); k-- > 0;)
+	{
+		const uint64_t sum =
+			static_cast<uint64_t>(limb[k]) + other.limb[k] + carry;
+		result.limb[k] = static_cast<uint32_t>(sum);
+		carry = sum >> 32;
+	}
+	return result;
+}
+
+Fixed Fixed::operator-(const Fixed &other) const
+{
+	return *this + -other;
+}
+
+Fixed Fixed::operator-() const
+{
+	Fixed result(limbs());
+	uint64_t carry = 1;
+	for (size_t k = limb.size(); k-- > 0;)
+	{
+		const uint64_t sum =
+			static_cast<uint64_t>(~limb[k]) + carry;
+		result.limb[k] = static_cast<uint32_t>(sum);
+		carry = sum >> 32;
+	}
+	return result;
+}
+
+Fixed Fixed::operator*(const Fixed &other) const
+{
+	const bool negative_result = negative() != other.negative();
+	const Fixed a = negative() ? -*this : *this;
+	const Fixed b = other.negative() ? -other : other;
+	const int n = limbs();
+	Fixed result(n);
+	std::vector<uint32_t> &acc = result.limb;
+	// Limb i times limb j has the weight of limb i + j; the partial
+	// products below the last limb are dropped
+	for (int i = 0; i < n; i++)
+	{
+		uint64_t carry = 0;
+		for (int j = n - 1 - i; j >= 0; j--)
+		{
+			const uint64_t t =
+				static_cast<uint64_t>(a.limb[i]) * b.limb[j] +
+				acc[i + j] + carry;
+			acc[i + j] = static_cast<uint32_t>(t);
+			carry = t >> 32;
+		}
+		for (int k = i - 1; k >= 0 && carry; k--)
+		{
+			const uint64_t t =
+				static_cast<uint64_t>(acc[k]) + carry;
+			acc[k] = static_cast<uint32_t>(t);
+			carry = t >> 32;
+		}
+	}
+	return negative_result ? -result : result;
+}
+
+int limbsForSpacing(double spacing)
+{
+	const int bits =
+		static_cast<int>(std::ceil(-std::log2(spacing))) + 64;
+	return 1 + std::max(2, (bits + 31) / 32);
+}
+
+View makeView(const std::string &center_re,
+			  const std::string &center_im, double spacing)
+{
+	const int limbs = limbsForSpacing(spacing);
+	View view;
+	view.center_re_text = center_re;
+	view.center_im_text = center_im;
+	view.center_re = Fixed::parse(center_re, limbs);
+	view.center_im = Fixed::parse(center_im, limbs);
+	view.spacing = spacing;
+	return view;
+}
+
+std::vector<std::complex<double>>
+referenceOrbit(const Fixed &cr, const Fixed &ci, int iterations)
+{
+	std::vector<std::complex<double>> orbit;
+	orbit.reserve(static_cast<size_t>(iterations) + 1);
+	orbit.emplace_back(0.0, 0.0);
+	Fixed zr(cr.limbs()), zi(cr.limbs());
+	for (int i = 1; i <= iterations; i++)
+	{
+		const Fixed zri = zr * zi;
+		zr = zr * zr - zi * zi + cr;
+		zi = zri + zri + ci;
+		const std::complex<double> z(zr.toDouble(), zi.toDouble());
+		orbit.push_back(z);
+		if (std::norm(z) >= 4)
+			break;
+	}
+	return orbit;
+}
+
+namespace
+{
+/**
+ * @brief Escape time of reference + dc from the reference orbit.
+ *
+ * @param glitch Receives |z|^2 / |Z|^2 of a glitched pixel, 0 if
+ * the pixel outlived the reference; left alone otherwise.
+ * @return The escape time, 0 for bounded points; meaningless if the
+ * pixel glitched.
+ */
+int perturbedEscape(const std::vector<std::complex<double>> &orbit,
+					double dcr, double dci, int iterations,
+					float &glitch)
+{
+	constexpr double tolerance =
+		GLITCH_TOLERANCE * GLITCH_TOLERANCE;
+	const int last = static_cast<int>(orbit.size()) - 1;
+	double dr = 0.0, di = 0.0;
+	for (int i = 1; i <= iterations; i++)
+	{
+		if (i > last)
+		{
+			glitch = 0.0f;
+			return i;
+		}
+		const double Zr = orbit[i - 1].real(),
+					 Zi = orbit[i - 1].imag();
+		// d' = 2 Z d + d^2 + dc
+		const double next_r =
+			2 * (Zr * dr - Zi * di) + dr * dr - di * di + dcr;
+		const double next_i =
+			2 * (Zr * di + Zi * dr + dr * di) + dci;
+		dr = next_r;
+		di = next_i;
+		const double zr = orbit[i].real() + dr,
+					 zi = orbit[i].imag() + di;
+		const double magnitude = zr * zr + zi * zi;
+		if (magnitude >= 4)
+			return i;
+		const double reference = std::norm(orbit[i]);
+		if (magnitude < tolerance * reference)
+		{
+			glitch = static_cast<float>(magnitude / reference);
+			return i;
+		}
+	}
+	return 0;
+}
+
+double now()
+{
+	return std::chrono::duration<double>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/**
+ * @brief Runs `segment(row, col_begin, col_end, escape)` over every
+ * row of every tile with a `schedule(runtime)` loop over the tiles.
+ */
+template <typename Segment>
+void renderTiles(int *image, int width, int height,
+				 progress::Reporter *progress,
+				 const Segment &segment)
+{
+	const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+	const int tiles = tiles_x * tiles_y;
+#ifdef _OPENMP
+#pragma omp parallel default(none) firstprivate(image, progress)   \
+	shared(width, height, tiles, tiles_x, segment)
+#endif
+	{
+		progress::Batch batch(progress, TILE_SIZE * TILE_SIZE);
+#ifdef _OPENMP
+#pragma omp for schedule(runtime) nowait
+#endif
+		for (int tile = 0; tile < tiles; tile++)
+		{
+			const int row_begin = (tile / tiles_x) * TILE_SIZE;
+			const int col_begin = (tile % tiles_x) * TILE_SIZE;
+			const int row_end =
+				std::min(row_begin + TILE_SIZE, height);
+			const int col_end =
+				std::min(col_begin + TILE_SIZE, width);
+			for (int row = row_begin; row < row_end; row++)
+				segment(row, col_begin, col_end,
+						image + static_cast<size_t>(row) * width +
+							col_begin);
+			batch.add(static_cast<int64_t>(row_end - row_begin) *
+					  (col_end - col_begin));
+		}
+	}
+}
+} // namespace
+
+// The double-double coordinates need strict floating point like the
+// kernel itself
+DOUBLEDOUBLE_STRICT_BEGIN
+namespace
+{
+dd::Real toDoubleDouble(const Fixed &value)
+{
+	const double hi = value.toDouble();
+	return dd::Real(
+		hi,
+		(value - Fixed::fromDouble(hi, value.limbs())).toDouble());
+}
+
+// Escape times of the pixels [col_begin, col_end) of a row, at most
+// one tile wide
+void doubleDoubleSegment(const dd::Real &center_re,
+						 const dd::Real &center_im, double spacing,
+						 int center_col, int center_row, int row,
+						 int col_begin, int col_end, int iterations,
+						 int *escape)
+{
+	dd::Real cr[TILE_SIZE], ci[TILE_SIZE];
+	const dd::Real im =
+		center_im + dd::Real((row - center_row) * spacing);
+	const int count = col_end - col_begin;
+	for (int k = 0; k < count; k++)
+	{
+		cr[k] = center_re +
+				dd::Real((col_begin + k - center_col) * spacing);
+		ci[k] = im;
+	}
+	kernels::escapeTimeBatch(cr, ci, count, iterations, escape);
+}
+} // namespace
+DOUBLEDOUBLE_STRICT_END
+
+const char *kernelName(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::DOUBLE:
+		return "double";
+	case Kernel::DOUBLE_DOUBLE:
+		return "double-double";
+	default:
+		return "perturbation";
+	}
+}
+
+bool parseKernel(const std::string &name, Kernel &kernel)
+{
+	if (name == "double")
+		kernel = Kernel::DOUBLE;
+	else if (name == "double-double")
+		kernel = Kernel::DOUBLE_DOUBLE;
+	else if (name == "perturbation")
+		kernel = Kernel::PERTURBATION;
+	else
+		return false;
+	return true;
+}
+
+Kernel selectKernel(const View &view)
+{
+	const double scale =
+		std::max({1.0, std::fabs(view.center_re.toDouble()),
+				  std::fabs(view.center_im.toDouble())});
+	const double relative = view.spacing / scale;
+	const double epsilon = std::numeric_limits<double>::epsilon();
+	if (relative >= epsilon * KERNEL_MARGIN)
+		return Kernel::DOUBLE;
+	// Two doubles give about twice the mantissa
+	if (relative >= epsilon * epsilon * KERNEL_MARGIN)
+		return Kernel::DOUBLE_DOUBLE;
+	return Kernel::PERTURBATION;
+}
+
+Result render(int *image, int iterations, int width, int height,
+			  const View &view, Kernel kernel,
+			  kernels::Schedule schedule,
+			  progress::Reporter *progress)
+{
+	if (kernel == Kernel::PERTURBATION)
+		return renderPerturbation(image, iterations, width, height,
+								  view, schedule, progress);
+	Result result;
+	result.kernel = kernel;
+	result.limbs = view.center_re.limbs();
+	const double spacing = view.spacing;
+	const int center_col = width / 2, center_row = height / 2;
+	kernels::installSchedule(schedule);
+	if (kernel == Kernel::DOUBLE)
+	{
+		const double center_re = view.center_re.toDouble();
+		const double center_im = view.center_im.toDouble();
+		renderTiles(
+			image, width, height, progress,
+			[&](int row, int col_begin, int col_end, int *escape)
+			{
+				double cr[TILE_SIZE], ci[TILE_SIZE];
+				const int count = col_end - col_begin;
+				for (int k = 0; k < count; k++)
+				{
+					cr[k] = center_re +
+							(col_begin + k - center_col) * spacing;
+					ci[k] =
+						center_im + (row - center_row) * spacing;
+				}
+				kernels::escapeTimeBatch(cr, ci, count, iterations,
+										 escape);
+			});
+		return result;
+	}
+	const dd::Real center_re = toDoubleDouble(view.center_re);
+	const dd::Real center_im = toDoubleDouble(view.center_im);
+	renderTiles(
+		image, width, height, progress,
+		[&](int row, int col_begin, int col_end, int *escape)
+		{
+			doubleDoubleSegment(center_re, center_im, spacing,
+								center_col, center_row, row,
+								col_begin, col_end, iterations,
+								escape);
+		});
+	return result;
+}
+
+Result renderPerturbation(int *image, int iterations, int width,
+						  int height, const View &view,
+						  kernels::Schedule schedule,
+						  progress::Reporter *progress)
+{
+	Result result;
+	result.kernel = Kernel::PERTURBATION;
+	result.limbs = view.center_re.limbs();
+	const double spacing = view.spacing;
+	const int center_col = width / 2, center_row = height / 2;
+
+	double start = now();
+	std::vector<std::complex<double>> orbit =
+		referenceOrbit(view.center_re, view.center_im, iterations);
+	result.reference_seconds += now() - start;
+	result.references = 1;
+
+	// Negative for a pixel that is done
+	std::vector<float> glitch(static_cast<size_t>(width) * height,
+							  -1.0f);
+	kernels::installSchedule(schedule);
+	renderTiles(
+		image, width, height, progress,
+		[&](int row, int col_begin, int col_end, int *escape)
+		{
+			float *const row_glitch =
+				glitch.data() + static_cast<size_t>(row) * width;
+			for (int col = col_begin; col < col_end; col++)
+				escape[col - col_begin] = perturbedEscape(
+					orbit, (col - center_col) * spacing,
+					(row - center_row) * spacing, iterations,
+					row_glitch[col]);
+		});
+
+	std::vector<size_t> glitched;
+	for (size_t pos = 0; pos < glitch.size(); pos++)
+		if (glitch[pos] >= 0.0f)
+			glitched.push_back(pos);
+	result.glitched = static_cast<int64_t>(glitched.size());
+
+	// Re-reference: the deepest glitch is closest to the feature
+	// the current reference misses, its own orbit resolves at least
+	// it
+	while (!glitched.empty() && result.references < MAX_REFERENCES)
+	{
+		const size_t reference =
+			*std::min_element(glitched.begin(), glitched.end(),
+							  [&](size_t a, size_t b)
+							  { return glitch[a] < glitch[b]; });
+		const int reference_col =
+			static_cast<int>(reference % width);
+		const int reference_row =
+			static_cast<int>(reference / width);
+		const int limbs = view.center_re.limbs();
+		start = now();
+		orbit = referenceOrbit(
+			view.center_re +
+				Fixed::fromDouble(
+					(reference_col - center_col) * spacing, limbs),
+			view.center_im +
+				Fixed::fromDouble(
+					(reference_row - center_row) * spacing, limbs),
+			iterations);
+		result.reference_seconds += now() - start;
+		result.references++;
+
+		const int64_t count = static_cast<int64_t>(glitched.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, iterations, count)                         \
+		shared(width, glitched, glitch, orbit, spacing,            \
+			   reference_col, reference_row)
+#endif
+		for (int64_t k = 0; k < count; k++)
+		{
+			const size_t pos = glitched[k];
+			const int col = static_cast<int>(pos % width);
+			const int row = static_cast<int>(pos / width);
+			glitch[pos] = -1.0f;
+			image[pos] = perturbedEscape(
+				orbit, (col - reference_col) * spacing,
+				(row - reference_row) * spacing, iterations,
+				glitch[pos]);
+		}
+		glitched.erase(
+			std::remove_if(glitched.begin(), glitched.end(),
+						   [&](size_t pos)
+						   { return glitch[pos] < 0.0f; }),
+			glitched.end());
+	}
+	result.unresolved = static_cast<int64_t>(glitched.size());
+	return result;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Center Re,Center Im,Pixel "
+		   "Spacing,Kernel,Limbs,References,"
+		   "Glitched Pixels,Unresolved Pixels,Reference (s)";
+}
+
+std::string csvColumns(const View &view, const Result &result)
+{
+	std::ostringstream columns;
+	columns << "," << view.center_re_text << ","
+			<< view.center_im_text << ",";
+	// The spacing is the only input that is not text already
+	columns.precision(std::numeric_limits<double>::max_digits10);
+	columns << view.spacing;
+	columns.precision(6);
+	columns << "," << kernelName(result.kernel) << ","
+			<< result.limbs << "," << result.references << ","
+			<< result.glitched << "," << result.unresolved << ","
+			<< result.reference_seconds;
+	return columns.str();
+}
+
+std::string describe(const View &view, const Result &result)
+{
+	std::ostringstream text;
+	text << "\tCenter:\t" << view.center_re_text << "\t"
+		 << view.center_im_text << "\tPixel spacing:\t"
+		 << view.spacing << "\tKernel:\t"
+		 << kernelName(result.kernel) << "\tLimbs:\t"
+		 << result.limbs << "\tReferences:\t" << result.references
+		 << "\tGlitched pixels:\t" << result.glitched
+		 << "\tUnresolved:\t" << result.unresolved
+		 << "\tReference:\t" << result.reference_seconds
+		 << "\tseconds";
+	return text.str();
+}
+} // namespace deepzoom
@@ -0,0 +1,199 @@
+// DeepZoom.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <ProgressReporter.h>
+#include <complex>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace deepzoom
+{
+/**
+ * @brief Signed fixed-point number with a runtime number of 32-bit
+ * limbs.
+ *
+ * Limb 0 holds the integer part, every further limb 32 fractional
+ * bits; negative values are two's complement over all limbs. The
+ * reference orbit never leaves |z| < 2 before it escapes, so a
+ * 32-bit integer part is plenty and the precision is spent on the
+ * fraction. Results are truncated below the last limb; both
+ * operands of an operation have the same number of limbs.
+ */
+class Fixed
+{
+  public:
+	explicit Fixed(int limbs = 2);
+
+	static Fixed fromDouble(double value, int limbs);
+	/**
+	 * @brief Parses a decimal such as "-0.743643887037158704752" or
+	 * "1.25e-3", every digit is kept up to the precision.
+	 *
+	 * @throws std::invalid_argument if the text is not a number.
+	 * @throws std::out_of_range if the integer part needs more than
+	 * 31 bits.
+	 */
+	static Fixed parse(const std::string &text, int limbs);
+
+	double toDouble() const;
+	int limbs() const { return static_cast<int>(limb.size()); }
+	bool negative() const { return limb[0] & 0x80000000u; }
+
+	Fixed operator+(const Fixed &other) const;
+	Fixed operator-(const Fixed &other) const;
+	Fixed operator*(const Fixed &other) const;
+	Fixed operator-() const;
+
+  private:
+	// Divides the magnitude, used while parsing
+	void divide(uint32_t divisor);
+
+	std::vector<uint32_t> limb;
+};
+
+/**
+ * @brief Limbs that resolve a pixel spacing, with 64 guard bits for
+ * the rounding of the reference orbit.
+ */
+int limbsForSpacing(double spacing);
+
+/**
+ * @brief Viewport of a deep zoom, centred on a high precision
+ * point.
+ *
+ * Pixel (row, col) of a `width * height` image maps to
+ * centre + ((col - width / 2) * spacing, (row - height / 2) *
+ * spacing). The offsets are doubles, so the spacing is limited by
+ * the double exponent range (about 1e-300), not by its mantissa.
+ */
+struct View
+{
+	std::string center_re_text;
+	std::string center_im_text;
+	Fixed center_re;
+	Fixed center_im;
+	double spacing = 0.0;
+};
+
+/**
+ * @brief Parses the centre with as many limbs as the spacing needs.
+ *
+ * @throws std::invalid_argument or std::out_of_range like
+ * `Fixed::parse`.
+ */
+View makeView(const std::string &center_re,
+			  const std::string &center_im, double spacing);
+
+/**
+ * @brief Orbit Z_0 = 0, Z_1, ... of c computed in fixed point and
+ * stored rounded to double.
+ *
+ * Ends with the first value with |Z| >= 2 or after `iterations`
+ * steps, so its size is the escape time of c plus one, or
+ * `iterations + 1` for a bounded c.
+ */
+std::vector<std::complex<double>>
+referenceOrbit(const Fixed &cr, const Fixed &ci, int iterations);
+
+/**
+ * @brief Relative size |z| / |Z| below which a pixel is glitched
+ * (Pauldelbrot's criterion): its delta dominates the reference, the
+ * precision of the delta is lost and the pixel needs a reference of
+ * its own.
+ */
+constexpr double GLITCH_TOLERANCE = 1e-3;
+
+// Reference orbits per image before glitched pixels are left as is
+constexpr int MAX_REFERENCES = 64;
+
+// Edge of the square tiles the image is scheduled in
+constexpr int TILE_SIZE = 32;
+
+/**
+ * @brief Kernels a deep zoom can be rendered with, from the fastest
+ * to the deepest.
+ */
+enum class Kernel
+{
+	DOUBLE,
+	DOUBLE_DOUBLE,
+	PERTURBATION
+};
+
+// "double", "double-double" or "perturbation"
+const char *kernelName(Kernel kernel);
+bool parseKernel(const std::string &name, Kernel &kernel);
+
+/**
+ * @brief Margin over the machine epsilon a kernel needs: it
+ * resolves a spacing s when s / max(|centre|, 1) >= epsilon *
+ * KERNEL_MARGIN.
+ *
+ * For double that is about 2e-13, for double-double (epsilon
+ * squared) about 5e-29.
+ */
+constexpr double KERNEL_MARGIN = 1e3;
+
+/**
+ * @brief Fastest kernel that resolves the spacing of the view.
+ */
+Kernel selectKernel(const View &view);
+
+struct Result
+{
+	Kernel kernel = Kernel::PERTURBATION;
+	// Limbs of the reference orbits
+	int limbs = 0;
+	// Reference orbits computed, the first one included; 0 for the
+	// direct kernels
+	int references = 0;
+	// Pixels flagged by the first pass
+	int64_t glitched = 0;
+	// Pixels still glitched after the last reference
+	int64_t unresolved = 0;
+	// Time spent in the reference orbits
+	double reference_seconds = 0.0;
+};
+
+/**
+ * @brief Renders the view with perturbation from reference orbits.
+ *
+ * One fixed point reference orbit is computed at the centre, every
+ * pixel then iterates its double precision offset from it:
+ * d' = 2 Z d + d^2 + dc, with z = Z + d. The first pass runs over
+ * tiles of `TILE_SIZE` pixels with a `schedule(runtime)` loop.
+ * Pixels that glitch, or outlive a reference that escaped, are
+ * collected; the one with the smallest |z| / |Z| becomes the next
+ * reference and the remaining glitched pixels are iterated again
+ * from it, until none is left or `MAX_REFERENCES` were used.
+ *
+ * @param image Output, `width * height` escape times.
+ * @param schedule Installed for the tile and re-reference loops.
+ * @param progress Optional counter, advanced per tile of the first
+ * pass.
+ */
+Result renderPerturbation(int *image, int iterations, int width,
+						  int height, const View &view,
+						  kernels::Schedule schedule,
+						  progress::Reporter *progress = nullptr);
+
+/**
+ * @brief Renders the view with the given kernel.
+ *
+ * The double and double-double kernels compute every pixel directly
+ * with `kernels::escapeTimeBatch`, one tile row at a time; the
+ * centre is rounded to the kernel's precision and the pixel offsets
+ * added to it. Perturbation goes to `renderPerturbation`.
+ */
+Result render(int *image, int iterations, int width, int height,
+			  const View &view, Kernel kernel,
+			  kernels::Schedule schedule,
+			  progress::Reporter *progress = nullptr);
+
+// ",Center Re,Center Im,Pixel Spacing,Kernel,Limbs,..."
+std::string csvHeaderColumns();
+std::string csvColumns(const View &view, const Result &result);
+// One tab separated line for the log
+std::string describe(const View &view, const Result &result);
+} // namespace deepzoom
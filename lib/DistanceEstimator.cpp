@@ -0,0 +1,275 @@
+#include "DistanceEstimator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace distance
+{
+double exteriorDistance(const std::complex<double> &c, int escape)
+{
+	std::complex<double> z(0, 0), dz(0, 0);
+	for (int i = 0; i < escape; i++)
+	{
+		dz = 2.0 * z * dz + 1.0;
+		z = z * z + c;
+	}
+	for (int k = 0;
+		 k < MAX_EXTRA_ITERATIONS && std::abs(z) < ESTIMATE_RADIUS;
+		 k++)
+	{
+		dz = 2.0 * z * dz + 1.0;
+		z = z * z + c;
+	}
+	const double modulus = std::abs(z);
+	return modulus * std::log(modulus) / (2 * std::abs(dz));
+}
+
+Sample estimate(const std::complex<double> &c, int iterations)
+{
+	Sample sample;
+	sample.escape = kernels::escapeTime(c, iterations);
+	if (sample.escape != 0)
+		sample.distance = exteriorDistance(c, sample.escape);
+	return sample;
+}
+
+namespace
+{
+// Escape time of pixel (row, col), written to the image
+inline int iteratePixel(int *image, int row, int col, int width,
+						float step, float min_x, float min_y,
+						int iterations)
+{
+	const std::complex<double> c =
+		kernels::pixelPoint(row, col, step, min_x, min_y);
+	return image[row * width + col] =
+			   kernels::escapeTime(c, iterations);
+}
+
+/**
+ * @brief Iterates the edge pixels of a block into the image, up to
+ * the first that escapes.
+ *
+ * @param iterated Incremented by the pixels iterated.
+ * @return `true` if every edge pixel stays bounded.
+ */
+bool edgesBounded(int *image, int row_begin, int row_end,
+				  int col_begin, int col_end, int width, float step,
+				  float min_x, float min_y, int iterations,
+				  int64_t &iterated)
+{
+	for (int row = row_begin; row < row_end; row++)
+	{
+		const bool edge_row =
+			row == row_begin || row == row_end - 1;
+		for (int col = col_begin; col < col_end; col++)
+		{
+			if (!edge_row && col != col_begin && col != col_end - 1)
+				continue;
+			iterated++;
+			if (iteratePixel(image, row, col, width, step, min_x,
+							 min_y, iterations) != 0)
+				return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Whether the corners of the block and of the blocks around
+ * it are all bounded, the guard ring of the enclosed fill.
+ */
+bool surroundingsBounded(const std::vector<Sample> &corners,
+						 int grid_x, int grid_y, int bx, int by)
+{
+	for (int gy = std::max(by - 1, 0);
+		 gy <= std::min(by + 2, grid_y - 1); gy++)
+		for (int gx = std::max(bx - 1, 0);
+			 gx <= std::min(bx + 2, grid_x - 1); gx++)
+			if (corners[gy * grid_x + gx].escape != 0)
+				return false;
+	return true;
+}
+} // namespace
+
+Stats computeOpenMP(int *image, int iterations, int width,
+					int height, float step, float min_x,
+					float min_y, double margin,
+					kernels::Schedule schedule,
+					progress::Reporter *progress)
+{
+	const int blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const int blocks_y = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const int blocks = blocks_x * blocks_y;
+	// Corner g of a row or column is pixel g * BLOCK_SIZE, the last
+	// one clamped to the image
+	const int grid_x = blocks_x + 1;
+	const int grid_y = blocks_y + 1;
+	std::vector<Sample> corners(static_cast<size_t>(grid_x) *
+								grid_y);
+	const double fill_distance = margin * std::sqrt(2.0) *
+								 BLOCK_SIZE *
+								 static_cast<double>(step);
+	int64_t filled = 0, enclosed = 0, computed = 0;
+	kernels::installSchedule(schedule);
+
+	const auto coarse_start = std::chrono::steady_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, iterations)                                \
+		shared(corners, width, height, step, min_x, min_y, grid_x, \
+			   grid_y)
+#endif
+	for (int gy = 0; gy < grid_y; gy++)
+	{
+		const int row = std::min(gy * BLOCK_SIZE, height - 1);
+		for (int gx = 0; gx < grid_x; gx++)
+		{
+			const int col = std::min(gx * BLOCK_SIZE, width - 1);
+			const std::complex<double> c =
+				kernels::pixelPoint(row, col, step, min_x, min_y);
+			const Sample sample = estimate(c, iterations);
+			corners[gy * grid_x + gx] = sample;
+			image[row * width + col] = sample.escape;
+		}
+	}
+	const auto refine_start = std::chrono::steady_clock::now();
+
+#ifdef _OPENMP
+#pragma omp parallel default(none)                                 \
+	firstprivate(image, iterations, progress)                      \
+	shared(corners, width, height, step, min_x, min_y, blocks,     \
+		   blocks_x, grid_x, grid_y, fill_distance)                \
+	reduction(+ : filled, enclosed, computed)
+#endif
+	{
+		progress::Batch batch(progress, BLOCK_SIZE * BLOCK_SIZE);
+#ifdef _OPENMP
+#pragma omp for schedule(runtime) nowait
+#endif
+		for (int block = 0; block < blocks; block++)
+		{
+			const int by = block / blocks_x;
+			const int bx = block % blocks_x;
+			const int row_begin = by * BLOCK_SIZE;
+			const int col_begin = bx * BLOCK_SIZE;
+			const int row_end =
+				std::min(row_begin + BLOCK_SIZE, height);
+			const int col_end =
+				std::min(col_begin + BLOCK_SIZE, width);
+			const Sample *top = &corners[by * grid_x + bx];
+			const Sample *bottom = top + grid_x;
+			const Sample *corner[4] = {top, top + 1, bottom,
+									   bottom + 1};
+			bool far = true;
+			for (const Sample *sample : corner)
+				far = far && sample->escape != 0 &&
+					  sample->escape == top->escape &&
+					  sample->distance >= fill_distance;
+			if (far)
+			{
+				filled++;
+				for (int row = row_begin; row < row_end; row++)
+					std::fill(image + row * width + col_begin,
+							  image + row * width + col_end,
+							  top->escape);
+			}
+			// Inside the set the estimate says nothing. The edge
+			// pixels are only samples of the edge, an escaping
+			// filament can cross it between two of them, so the
+			// blocks around must be bounded at their corners too; a
+			// filament reaching the block then has to pass between
+			// those corners as well.
+			else if (surroundingsBounded(corners, grid_x, grid_y,
+										 bx, by) &&
+					 edgesBounded(image, row_begin, row_end,
+								  col_begin, col_end, width, step,
+								  min_x, min_y, iterations,
+								  computed))
+			{
+				enclosed++;
+				for (int row = row_begin + 1; row < row_end - 1;
+					 row++)
+					std::fill(image + row * width + col_begin + 1,
+							  image + row * width + col_end - 1, 0);
+			}
+			else
+			{
+				for (int row = row_begin; row < row_end; row++)
+					for (int col = col_begin; col < col_end; col++)
+						iteratePixel(image, row, col, width, step,
+									 min_x, min_y, iterations);
+				computed +=
+					static_cast<int64_t>(row_end - row_begin) *
+					(col_end - col_begin);
+			}
+			batch.add(static_cast<int64_t>(row_end - row_begin) *
+					  (col_end - col_begin));
+		}
+	}
+	const auto refine_end = std::chrono::steady_clock::now();
+
+	Stats stats;
+	stats.blocks = blocks;
+	stats.filled = filled;
+	stats.enclosed = enclosed;
+	stats.computed =
+		computed + static_cast<int64_t>(grid_x) * grid_y;
+	stats.pixels = static_cast<int64_t>(width) * height;
+	stats.coarse_seconds =
+		std::chrono::duration<double>(refine_start - coarse_start)
+			.count();
+	stats.refine_seconds =
+		std::chrono::duration<double>(refine_end - refine_start)
+			.count();
+	return stats;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Margin,Blocks,Filled Blocks,Enclosed Blocks,"
+		   "Computed Pixels,Computed Fraction,Coarse (s),Refine "
+		   "(s),"
+		   "Mismatches,Max Difference,Brute Force (s),Speedup";
+}
+
+std::string csvColumns(double margin, const Stats &stats,
+					   const precision::Verification &verification,
+					   double seconds, double reference_seconds)
+{
+	std::ostringstream columns;
+	columns << "," << margin << "," << stats.blocks << ","
+			<< stats.filled << "," << stats.enclosed << ","
+			<< stats.computed << "," << stats.computedFraction()
+			<< "," << stats.coarse_seconds << ","
+			<< stats.refine_seconds << ","
+			<< verification.mismatches << ","
+			<< verification.max_difference << ","
+			<< reference_seconds << ","
+			<< (seconds > 0.0 ? reference_seconds / seconds : 0.0);
+	return columns.str();
+}
+
+std::string describe(double margin, const Stats &stats,
+					 const precision::Verification &verification,
+					 double seconds, double reference_seconds)
+{
+	std::ostringstream text;
+	text << "\tDistance margin:\t" << margin << "\tBlocks:\t"
+		 << stats.blocks << "\tFilled:\t" << stats.filled
+		 << "\tEnclosed:\t" << stats.enclosed
+		 << "\tComputed pixels:\t" << stats.computed << "\t("
+		 << 100.0 * stats.computedFraction() << "\t%)\tCoarse:\t"
+		 << stats.coarse_seconds << "\tseconds\tRefine:\t"
+		 << stats.refine_seconds << "\tseconds\tMismatches:\t"
+		 << verification.mismatches << "\tMax difference:\t"
+		 << verification.max_difference << "\tBrute force:\t"
+		 << reference_seconds << "\tseconds";
+	if (seconds > 0.0)
+		text << "\tSpeedup:\t" << reference_seconds / seconds;
+	return text.str();
+}
+} // namespace distance
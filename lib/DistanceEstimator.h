@@ -0,0 +1,122 @@
+// DistanceEstimator.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <PrecisionTiles.h>
+#include <ProgressReporter.h>
+#include <complex>
+#include <cstdint>
+#include <string>
+
+namespace distance
+{
+// Edge of the square blocks the coarse pass samples at their
+// corners
+constexpr int BLOCK_SIZE = 8;
+
+/**
+ * @brief |z| an escaped orbit is followed to for the estimate. At
+ * the escape radius 2 the estimate is off by a large factor, it
+ * converges as |z| grows.
+ */
+constexpr double ESTIMATE_RADIUS = 1e3;
+
+// Iterations past the escape spent reaching `ESTIMATE_RADIUS`
+constexpr int MAX_EXTRA_ITERATIONS = 16;
+
+// Margin of the fill test, in block diagonals
+constexpr double DEFAULT_MARGIN = 1.0;
+
+struct Sample
+{
+	// Escape iteration of the point, 0 if it stays bounded
+	int escape = 0;
+	// Lower bound of the distance to the set, 0 if bounded
+	double distance = 0.0;
+};
+
+/**
+ * @brief Exterior distance estimate of a c that escapes at
+ * iteration `escape`.
+ *
+ * Iterates z and its derivative dz/dc, dz' = 2 z dz + 1, for
+ * `escape` steps and then up to `ESTIMATE_RADIUS`; the estimate is
+ * |z| ln|z| / (2 |dz|), the Koebe quarter lower bound of the
+ * distance from c to the Mandelbrot set.
+ */
+double exteriorDistance(const std::complex<double> &c, int escape);
+
+/**
+ * @brief Escape time and exterior distance estimate of c.
+ *
+ * The escape time is that of `kernels::escapeTime`, the loop every
+ * pixel is computed with: a loop carrying the derivative along
+ * rounds differently under fast-math and may escape one iteration
+ * apart. The derivative is only followed for escaping points,
+ * bounded points are iterated once.
+ */
+Sample estimate(const std::complex<double> &c, int iterations);
+
+struct Stats
+{
+	int64_t blocks = 0;
+	// Blocks filled from their corners without iterating
+	int64_t filled = 0;
+	// Blocks inside the set filled after iterating their edges,
+	// their neighbours' corners being bounded too
+	int64_t enclosed = 0;
+	// Pixels iterated, the coarse corners included; pixels of a
+	// block whose edge test failed count twice
+	int64_t computed = 0;
+	int64_t pixels = 0;
+	double coarse_seconds = 0.0;
+	double refine_seconds = 0.0;
+
+	double computedFraction() const
+	{
+		return pixels > 0 ? static_cast<double>(computed) / pixels
+						  : 0.0;
+	}
+};
+
+/**
+ * @brief Computes the image like `kernels::computeOpenMP`, filling
+ * the blocks far from the set boundary.
+ *
+ * A coarse pass estimates the distance at the corners of every
+ * `BLOCK_SIZE` block, the corners being pixels of the image. A
+ * block whose corners escape at the same iteration and are all at
+ * least `margin` block diagonals away from the set holds no point
+ * of the set; it is filled with that escape time. A block whose
+ * corners and whose neighbours' corners are bounded has its edges
+ * iterated; if none escapes it is filled as bounded. This is a
+ * sampling test: an escaping filament thinner than a pixel can
+ * still cross the edge between two edge pixels, the verification
+ * against the brute-force image reports such pixels as mismatches.
+ * Every other block, close to the boundary, is iterated pixel by
+ * pixel with `kernels::escapeTime`. Both passes are
+ * `schedule(runtime)` loops; a margin of 0 fills every block of
+ * equal corners.
+ *
+ * @param progress Optional counter, advanced per block.
+ */
+Stats computeOpenMP(int *image, int iterations, int width,
+					int height, float step, float min_x,
+					float min_y, double margin,
+					kernels::Schedule schedule,
+					progress::Reporter *progress = nullptr);
+
+// ",Margin,Blocks,Filled Blocks,Enclosed Blocks,Computed
+// Pixels,..."
+std::string csvHeaderColumns();
+/**
+ * @param reference_seconds Time of the brute-force render the image
+ * was verified against.
+ */
+std::string csvColumns(double margin, const Stats &stats,
+					   const precision::Verification &verification,
+					   double seconds, double reference_seconds);
+// One tab separated line for the log
+std::string describe(double margin, const Stats &stats,
+					 const precision::Verification &verification,
+					 double seconds, double reference_seconds);
+} // namespace distance
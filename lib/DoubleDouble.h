@@ -0,0 +1,120 @@
+// DoubleDouble.h
+#pragma once
+#include <cmath>
+
+// The error-free transformations below only hold with strict IEEE
+// evaluation, -Ofast would reassociate them away. Code that uses
+// them is put between these markers; GCC does not inline across
+// different optimisation attributes, so callers belong inside too.
+#if defined(__clang__)
+#define DOUBLEDOUBLE_STRICT_BEGIN                                  \
+	_Pragma("float_control(precise, on, push)")
+#define DOUBLEDOUBLE_STRICT_END _Pragma("float_control(pop)")
+#elif defined(__GNUC__)
+#define DOUBLEDOUBLE_STRICT_BEGIN                                  \
+	_Pragma("GCC push_options")                                    \
+		_Pragma("GCC optimize(\"no-fast-math\")")
+#define DOUBLEDOUBLE_STRICT_END _Pragma("GCC pop_options")
+#else
+#define DOUBLEDOUBLE_STRICT_BEGIN
+#define DOUBLEDOUBLE_STRICT_END
+#endif
+
+DOUBLEDOUBLE_STRICT_BEGIN
+namespace dd
+{
+// s + e == a + b exactly
+inline double twoSum(double a, double b, double &e)
+{
+	const double s = a + b;
+	const double bb = s - a;
+	e = (a - (s - bb)) + (b - bb);
+	return s;
+}
+
+// twoSum for |a| >= |b|
+inline double quickTwoSum(double a, double b, double &e)
+{
+	const double s = a + b;
+	e = b - (s - a);
+	return s;
+}
+
+// p + e == a * b exactly, the error term comes from one FMA
+inline double twoProd(double a, double b, double &e)
+{
+	const double p = a * b;
+	e = std::fma(a, b, -p);
+	return p;
+}
+
+/**
+ * @brief (hi, lo) = (ah, al) + (bh, bl), on plain doubles so that
+ * lockstep loops over separate hi and lo arrays vectorise.
+ */
+inline void add(double ah, double al, double bh, double bl,
+				double &hi, double &lo)
+{
+	double e;
+	const double s = twoSum(ah, bh, e);
+	e += al + bl;
+	hi = quickTwoSum(s, e, lo);
+}
+
+// (hi, lo) = (ah, al) * (bh, bl)
+inline void mul(double ah, double al, double bh, double bl,
+				double &hi, double &lo)
+{
+	double e;
+	const double p = twoProd(ah, bh, e);
+	e += ah * bl + al * bh;
+	hi = quickTwoSum(p, e, lo);
+}
+
+/**
+ * @brief Unevaluated sum hi + lo of two doubles, about 106 bits of
+ * mantissa with the exponent range of a double.
+ *
+ * Additions use the fast ("sloppy") variant of the QD library:
+ * exact unless the operands cancel to far below their own
+ * magnitude, which the escape-time recurrence does not rely on.
+ */
+struct Real
+{
+	double hi = 0.0;
+	double lo = 0.0;
+
+	Real() = default;
+	Real(double value) : hi(value) {}
+	Real(double hi, double lo) : hi(hi), lo(lo) {}
+
+	double toDouble() const { return hi + lo; }
+};
+
+inline Real operator+(const Real &a, const Real &b)
+{
+	Real result;
+	add(a.hi, a.lo, b.hi, b.lo, result.hi, result.lo);
+	return result;
+}
+
+inline Real operator-(const Real &a) { return Real(-a.hi, -a.lo); }
+
+inline Real operator-(const Real &a, const Real &b)
+{
+	return a + -b;
+}
+
+inline Real operator*(const Real &a, const Real &b)
+{
+	Real result;
+	mul(a.hi, a.lo, b.hi, b.lo, result.hi, result.lo);
+	return result;
+}
+
+inline bool operator>=(const Real &a, const Real &b)
+{
+	return a.hi > b.hi || (a.hi == b.hi && a.lo >= b.lo);
+}
+} // namespace dd
+DOUBLEDOUBLE_STRICT_END
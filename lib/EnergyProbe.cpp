@@ -0,0 +1,186 @@
+#include "EnergyProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace energy
+{
+namespace
+{
+bool readValue(const std::string &path, uint64_t &value)
+{
+	std::ifstream file(path);
+	return static_cast<bool>(file >> value);
+}
+
+std::string readName(const fs::path &zone)
+{
+	std::ifstream file(zone / "name");
+	std::string name;
+	std::getline(file, name);
+	return name;
+}
+
+double now()
+{
+	return std::chrono::duration<double>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+} // namespace
+
+double Sample::packageWatts() const
+{
+	return seconds > 0.0 ? package_joules / seconds : 0.0;
+}
+
+double Sample::coreWatts() const
+{
+	return seconds > 0.0 ? core_joules / seconds : 0.0;
+}
+
+Probe::Probe(const std::string &root)
+{
+	std::error_code error;
+	if (!fs::is_directory(root, error))
+	{
+		message = root + " not present";
+		return;
+	}
+	// Top level zones are packages, their subzones cores, dram, ...
+	std::vector<fs::path> candidates;
+	for (const auto &entry : fs::directory_iterator(root, error))
+	{
+		const std::string name = entry.path().filename().string();
+		if (name.rfind("intel-rapl:", 0) == 0 &&
+			std::count(name.begin(), name.end(), ':') == 1)
+			candidates.push_back(entry.path());
+	}
+	std::sort(candidates.begin(), candidates.end());
+	bool unreadable = false;
+	for (const fs::path &package : candidates)
+	{
+		if (readName(package).rfind("package", 0) != 0)
+			continue;
+		std::vector<fs::path> domains = {package};
+		for (const auto &entry :
+			 fs::directory_iterator(package, error))
+		{
+			const std::string name =
+				entry.path().filename().string();
+			if (name.rfind("intel-rapl:", 0) == 0 &&
+				readName(entry.path()) == "core")
+				domains.push_back(entry.path());
+		}
+		for (size_t d = 0; d < domains.size(); d++)
+		{
+			Zone zone;
+			zone.energy_path = (domains[d] / "energy_uj").string();
+			zone.package = d == 0;
+			uint64_t value = 0;
+			if (!readValue(zone.energy_path, value) ||
+				!readValue(
+					(domains[d] / "max_energy_range_uj").string(),
+					zone.max_range_uj))
+			{
+				unreadable = true;
+				continue;
+			}
+			zones.push_back(zone);
+		}
+	}
+	if (zones.empty())
+		message = unreadable ? "RAPL energy_uj not readable"
+							 : "no RAPL package zone";
+}
+
+Reading Probe::read() const
+{
+	Reading reading;
+	reading.time = now();
+	for (const Zone &zone : zones)
+	{
+		uint64_t value = 0;
+		readValue(zone.energy_path, value);
+		reading.energy_uj.push_back(value);
+	}
+	return reading;
+}
+
+Sample Probe::delta(const Reading &before,
+					const Reading &after) const
+{
+	Sample sample;
+	sample.seconds = after.time - before.time;
+	if (before.energy_uj.size() != zones.size() ||
+		after.energy_uj.size() != zones.size())
+		return sample;
+	for (size_t z = 0; z < zones.size(); z++)
+	{
+		uint64_t used = after.energy_uj[z] - before.energy_uj[z];
+		// The counter wrapped around once
+		if (after.energy_uj[z] < before.energy_uj[z])
+			used = zones[z].max_range_uj - before.energy_uj[z] +
+				   after.energy_uj[z];
+		if (zones[z].package)
+		{
+			sample.package_joules += used * 1e-6;
+			sample.package_valid = true;
+		}
+		else
+		{
+			sample.core_joules += used * 1e-6;
+			sample.core_valid = true;
+		}
+	}
+	return sample;
+}
+
+std::string csvHeaderColumns(const std::string &phase)
+{
+	return "," + phase + " Package (J)," + phase + " Core (J)," +
+		   phase + " Package (W)," + phase + " Core (W)";
+}
+
+std::string csvColumns(const Sample &sample)
+{
+	std::ostringstream columns;
+	columns << ",";
+	if (sample.package_valid)
+		columns << sample.package_joules;
+	columns << ",";
+	if (sample.core_valid)
+		columns << sample.core_joules;
+	columns << ",";
+	if (sample.package_valid)
+		columns << sample.packageWatts();
+	columns << ",";
+	if (sample.core_valid)
+		columns << sample.coreWatts();
+	return columns.str();
+}
+
+std::string describe(const Sample &sample)
+{
+	std::ostringstream text;
+	text << "Package:\t";
+	if (sample.package_valid)
+		text << sample.package_joules << "\tJ\t"
+			 << sample.packageWatts() << "\tW";
+	else
+		text << "n/a";
+	text << "\tCore:\t";
+	if (sample.core_valid)
+		text << sample.core_joules << "\tJ\t" << sample.coreWatts()
+			 << "\tW";
+	else
+		text << "n/a";
+	text << "\tInterval:\t" << sample.seconds << "\tseconds";
+	return text.str();
+}
+} // namespace energy
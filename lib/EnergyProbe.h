@@ -0,0 +1,90 @@
+// EnergyProbe.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace energy
+{
+/**
+ * @brief Energy and average power of a measured interval.
+ *
+ * Package covers every socket, core the sum of the core subzones.
+ * A domain that is not exposed stays invalid and is written as an
+ * empty CSV field.
+ */
+struct Sample
+{
+	double package_joules = 0.0;
+	double core_joules = 0.0;
+	double seconds = 0.0;
+	bool package_valid = false;
+	bool core_valid = false;
+
+	double packageWatts() const;
+	double coreWatts() const;
+};
+
+/**
+ * @brief Raw counters of every zone at one point in time.
+ */
+struct Reading
+{
+	std::vector<uint64_t> energy_uj;
+	double time = 0.0;
+};
+
+/**
+ * @brief RAPL package and core counters from /sys/class/powercap.
+ *
+ * The constructor walks the intel-rapl zones (the same driver
+ * exposes AMD RAPL) and keeps the readable "package-N" zones and
+ * their "core" subzones. energy_uj is root-only on most current
+ * kernels; without a readable zone `available()` is false, readings
+ * are empty and every sample is invalid.
+ *
+ * Counters wrap at max_energy_range_uj, a difference is corrected
+ * once; intervals long enough to wrap twice (hours at full load)
+ * are not detected. The counters update about every millisecond, so
+ * short intervals carry a relative error in that order.
+ */
+class Probe
+{
+  public:
+	explicit Probe(const std::string &root = "/sys/class/powercap");
+
+	bool available() const { return !zones.empty(); }
+	// Why the probe is unavailable; empty if it is available
+	const std::string &status() const { return message; }
+
+	Reading read() const;
+	Sample delta(const Reading &before, const Reading &after) const;
+
+  private:
+	struct Zone
+	{
+		std::string energy_path;
+		uint64_t max_range_uj = 0;
+		bool package = true;
+	};
+	std::vector<Zone> zones;
+	std::string message;
+};
+
+/**
+ * @brief CSV header columns of a sample, each prefixed with a comma
+ * and the phase, e.g. ",Compute Package (J),...".
+ */
+std::string csvHeaderColumns(const std::string &phase);
+
+/**
+ * @brief CSV values matching `csvHeaderColumns`, each prefixed with
+ * a comma.
+ */
+std::string csvColumns(const Sample &sample);
+
+/**
+ * @brief Tab separated "Name:\tvalue" pairs for the log files.
+ */
+std::string describe(const Sample &sample);
+} // namespace energy
@@ -0,0 +1,332 @@
+// FormulaEngine.h
+#pragma once
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+namespace formula
+{
+/**
+ * @brief Escape-time fractals the CPU engines can render.
+ */
+enum class Kind
+{
+	MANDELBROT,
+	JULIA,
+	MULTIBROT,
+	BURNING_SHIP,
+	TRICORN
+};
+
+// Exponents of the Multibrot set that get a specialisation
+constexpr int MIN_POWER = 2;
+constexpr int MAX_POWER = 8;
+
+/**
+ * @brief Runtime choice of the formula and its constants.
+ */
+struct Params
+{
+	Kind kind = Kind::MANDELBROT;
+	// Fixed c of the Julia set, the pixel is z0
+	std::complex<double> julia{-0.8, 0.156};
+	// d of z^d + c, MIN_POWER to MAX_POWER
+	int power = 3;
+};
+
+// "mandelbrot", "julia", "multibrot", "burning-ship" or "tricorn"
+inline const char *kindName(Kind kind)
+{
+	switch (kind)
+	{
+	case Kind::JULIA:
+		return "julia";
+	case Kind::MULTIBROT:
+		return "multibrot";
+	case Kind::BURNING_SHIP:
+		return "burning-ship";
+	case Kind::TRICORN:
+		return "tricorn";
+	default:
+		return "mandelbrot";
+	}
+}
+
+inline bool parseKind(const std::string &name, Kind &kind)
+{
+	for (Kind candidate :
+		 {Kind::MANDELBROT, Kind::JULIA, Kind::MULTIBROT,
+		  Kind::BURNING_SHIP, Kind::TRICORN})
+		if (name == kindName(candidate))
+		{
+			kind = candidate;
+			return true;
+		}
+	return false;
+}
+
+// Params of the command line values, an unknown name is Mandelbrot
+inline Params makeParams(const std::string &name, double julia_re,
+						 double julia_im, int power)
+{
+	Params params;
+	parseKind(name, params.kind);
+	params.julia = std::complex<double>(julia_re, julia_im);
+	params.power = power;
+	return params;
+}
+
+/**
+ * @brief Formula policies.
+ *
+ * A policy gives the starting z and the constant c of a pixel, and
+ * one step of the recurrence. Everything is inline and non-virtual,
+ * so `escapeTime<Policy>` compiles to a loop of its own per
+ * formula.
+ */
+struct Mandelbrot
+{
+	explicit Mandelbrot(const Params & = Params()) {}
+	std::complex<double> start(const std::complex<double> &) const
+	{
+		return std::complex<double>(0, 0);
+	}
+	std::complex<double>
+	constant(const std::complex<double> &point) const
+	{
+		return point;
+	}
+	std::complex<double> step(const std::complex<double> &z,
+							  const std::complex<double> &c) const
+	{
+		return z * z + c;
+	}
+};
+
+struct Julia
+{
+	std::complex<double> seed;
+
+	explicit Julia(const Params &params = Params())
+		: seed(params.julia)
+	{
+	}
+	std::complex<double>
+	start(const std::complex<double> &point) const
+	{
+		return point;
+	}
+	std::complex<double>
+	constant(const std::complex<double> &) const
+	{
+		return seed;
+	}
+	std::complex<double> step(const std::complex<double> &z,
+							  const std::complex<double> &c) const
+	{
+		return z * z + c;
+	}
+};
+
+// z^D with D - 1 multiplications, unrolled at compile time
+template <int D>
+inline std::complex<double> power(const std::complex<double> &z)
+{
+	if constexpr (D == 1)
+		return z;
+	else
+		return power<D - 1>(z) * z;
+}
+
+template <int D> struct Multibrot : Mandelbrot
+{
+	static_assert(D >= MIN_POWER && D <= MAX_POWER,
+				  "unsupported power");
+
+	explicit Multibrot(const Params &params = Params())
+		: Mandelbrot(params)
+	{
+	}
+	std::complex<double> step(const std::complex<double> &z,
+							  const std::complex<double> &c) const
+	{
+		return power<D>(z) + c;
+	}
+};
+
+// (|Re z| + i |Im z|)^2 + c
+struct BurningShip : Mandelbrot
+{
+	explicit BurningShip(const Params &params = Params())
+		: Mandelbrot(params)
+	{
+	}
+	std::complex<double> step(const std::complex<double> &z,
+							  const std::complex<double> &c) const
+	{
+		const std::complex<double> folded(std::fabs(z.real()),
+										  std::fabs(z.imag()));
+		return folded * folded + c;
+	}
+};
+
+// conj(z)^2 + c
+struct Tricorn : Mandelbrot
+{
+	explicit Tricorn(const Params &params = Params())
+		: Mandelbrot(params)
+	{
+	}
+	std::complex<double> step(const std::complex<double> &z,
+							  const std::complex<double> &c) const
+	{
+		const std::complex<double> conjugate = std::conj(z);
+		return conjugate * conjugate + c;
+	}
+};
+
+/**
+ * @brief Escape test of the engines: |z| >= 2 for the shared CPU
+ * kernels, |z|^2 >= 4 for the MPI engine. Both are kept so every
+ * engine's Mandelbrot images stay what they were.
+ */
+enum class Bailout
+{
+	MODULUS,
+	NORM
+};
+
+/**
+ * @brief Escape time of a point under a formula.
+ *
+ * Iterates the policy's recurrence from its starting z and returns
+ * the iteration at which z escapes, or 0 if it stays bounded for
+ * `iterations` steps. With `Mandelbrot` this is exactly
+ * `kernels::escapeTime`.
+ */
+template <typename Formula, Bailout B = Bailout::MODULUS>
+inline int escapeTime(const Formula &formula,
+					  const std::complex<double> &point,
+					  int iterations)
+{
+	std::complex<double> z = formula.start(point);
+	const std::complex<double> c = formula.constant(point);
+	for (int i = 1; i <= iterations; i++)
+	{
+		z = formula.step(z, c);
+		// If it is convergent
+		if constexpr (B == Bailout::MODULUS)
+		{
+			if (std::abs(z) >= 2)
+				return i;
+		}
+		else if (z.real() * z.real() + z.imag() * z.imag() >= 4)
+			return i;
+	}
+	return 0;
+}
+
+namespace detail
+{
+template <typename Formula, typename Visitor>
+void visit(const Params &params, Visitor &visitor)
+{
+	visitor(Formula(params));
+}
+
+// Position of the specialisation in the dispatch table
+inline int tableIndex(const Params &params)
+{
+	switch (params.kind)
+	{
+	case Kind::JULIA:
+		return 1;
+	case Kind::BURNING_SHIP:
+		return 2;
+	case Kind::TRICORN:
+		return 3;
+	case Kind::MULTIBROT:
+		// z^2 + c is the Mandelbrot set
+		if (params.power > MIN_POWER && params.power <= MAX_POWER)
+			return 4 + params.power - (MIN_POWER + 1);
+		return 0;
+	default:
+		return 0;
+	}
+}
+} // namespace detail
+
+/**
+ * @brief Calls `visitor` with the policy `params` selects.
+ *
+ * The choice is one indirect call through a table of
+ * specialisations; the visitor is a generic callable, typically a
+ * lambda forwarding to a pixel loop templated on the policy, so the
+ * loop itself is compiled once per formula and has no per-pixel or
+ * per-iteration dispatch.
+ */
+template <typename Visitor>
+void dispatch(const Params &params, Visitor &&visitor)
+{
+	using V = std::remove_reference_t<Visitor>;
+	using Entry = void (*)(const Params &, V &);
+	static constexpr Entry table[] = {
+		&detail::visit<Mandelbrot, V>,
+		&detail::visit<Julia, V>,
+		&detail::visit<BurningShip, V>,
+		&detail::visit<Tricorn, V>,
+		&detail::visit<Multibrot<3>, V>,
+		&detail::visit<Multibrot<4>, V>,
+		&detail::visit<Multibrot<5>, V>,
+		&detail::visit<Multibrot<6>, V>,
+		&detail::visit<Multibrot<7>, V>,
+		&detail::visit<Multibrot<8>, V>};
+	static_assert(sizeof(table) / sizeof(table[0]) ==
+					  4 + MAX_POWER - MIN_POWER,
+				  "one Multibrot entry per power");
+	table[detail::tableIndex(params)](params, visitor);
+}
+
+// Whether the image is the Mandelbrot set of the original engines
+inline bool isMandelbrot(const Params &params)
+{
+	return detail::tableIndex(params) == 0;
+}
+
+// ",Formula,Julia Re,Julia Im,Power"
+inline std::string csvHeaderColumns()
+{
+	return ",Formula,Julia Re,Julia Im,Power";
+}
+
+// The constants that do not apply to the formula stay empty
+inline std::string csvColumns(const Params &params)
+{
+	std::ostringstream columns;
+	columns << "," << kindName(params.kind) << ",";
+	if (params.kind == Kind::JULIA)
+		columns << params.julia.real() << ","
+				<< params.julia.imag();
+	else
+		columns << ",";
+	columns << ",";
+	if (params.kind == Kind::MULTIBROT)
+		columns << params.power;
+	return columns.str();
+}
+
+// One tab separated line for the log
+inline std::string describe(const Params &params)
+{
+	std::ostringstream text;
+	text << "\tFormula:\t" << kindName(params.kind);
+	if (params.kind == Kind::JULIA)
+		text << "\tJulia c:\t" << params.julia.real() << ","
+			 << params.julia.imag();
+	if (params.kind == Kind::MULTIBROT)
+		text << "\tPower:\t" << params.power;
+	return text.str();
+}
+} // namespace formula
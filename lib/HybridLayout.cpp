@@ -0,0 +1,202 @@
+#include <HybridLayout.hpp>
+#include <MPIGather.hpp>
+
+#include <omp.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace hybrid
+{
+
+/**
+ * @brief Parses a Linux cpulist string such as "0-3,8,10-11".
+ *
+ * @param list The cpulist string.
+ * @return The CPU ids contained in the list.
+ */
+std::vector<int> parseCpuList(const std::string &list)
+{
+	std::vector<int> cpus;
+	std::stringstream stream(list);
+	std::string range;
+	while (std::getline(stream, range, ','))
+	{
+		if (range.empty() || range == "\n")
+			continue;
+		size_t dash = range.find('-');
+		try
+		{
+			int first = std::stoi(range.substr(0, dash));
+			int last = (dash == std::string::npos)
+						   ? first
+						   : std::stoi(range.substr(dash + 1));
+			for (int cpu = first; cpu <= last; cpu++)
+				cpus.push_back(cpu);
+		}
+		catch (const std::exception &)
+		{
+			// Malformed entry, skip it
+		}
+	}
+	return cpus;
+}
+
+/**
+ * @brief Maps every CPU id to its NUMA node using sysfs.
+ *
+ * @param max_cpu The number of CPU ids to map.
+ * @return The NUMA node of every CPU, 0 where unknown.
+ */
+std::vector<int> readNumaMap(int max_cpu)
+{
+	std::vector<int> numa_of_cpu(max_cpu, 0);
+	// Node ids can be sparse, probe a reasonable range
+	for (int node = 0; node < 1024; node++)
+	{
+		std::ifstream file("/sys/devices/system/node/node" +
+						   std::to_string(node) + "/cpulist");
+		if (!file.is_open())
+			continue;
+		std::string list;
+		std::getline(file, list);
+		for (int cpu : parseCpuList(list))
+		{
+			if (cpu >= 0 && cpu < max_cpu)
+				numa_of_cpu[cpu] = node;
+		}
+	}
+	return numa_of_cpu;
+}
+
+Layout discoverLayout(MPI_Comm comm, int threads_override)
+{
+	Layout layout;
+	MPI_Comm_rank(comm, &layout.world_rank);
+	MPI_Comm_size(comm, &layout.world_size);
+
+	char name[MPI_MAX_PROCESSOR_NAME];
+	int name_length = 0;
+	MPI_Get_processor_name(name, &name_length);
+	layout.hostname.assign(name, name_length);
+
+	MPI_Comm node_comm;
+	MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED,
+						layout.world_rank, MPI_INFO_NULL,
+						&node_comm);
+	MPI_Comm_rank(node_comm, &layout.local_rank);
+	MPI_Comm_size(node_comm, &layout.local_size);
+
+	// Union of the affinity masks of all ranks on the node, the
+	// launcher may have bound every rank to a subset of the cores
+	std::vector<int> allowed(CPU_SETSIZE, 0);
+	cpu_set_t mask;
+	CPU_ZERO(&mask);
+	if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+	{
+		for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+			allowed[cpu] = CPU_ISSET(cpu, &mask) ? 1 : 0;
+	}
+	else
+	{
+		allowed[0] = 1;
+	}
+	MPI_Allreduce(MPI_IN_PLACE, allowed.data(), CPU_SETSIZE,
+				  MPI_INT, MPI_MAX, node_comm);
+	MPI_Comm_free(&node_comm);
+
+	const std::vector<int> numa_of_cpu = readNumaMap(CPU_SETSIZE);
+	std::vector<int> node_cpus;
+	for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+	{
+		if (allowed[cpu])
+			node_cpus.push_back(cpu);
+	}
+	// Keep the cores of one NUMA domain next to each other so that
+	// contiguous slices do not straddle domains
+	std::stable_sort(node_cpus.begin(), node_cpus.end(),
+					 [&](int a, int b)
+					 { return numa_of_cpu[a] < numa_of_cpu[b]; });
+
+	std::set<int> node_domains;
+	for (int cpu : node_cpus)
+		node_domains.insert(numa_of_cpu[cpu]);
+	layout.node_cores = static_cast<int>(node_cpus.size());
+	layout.numa_domains = static_cast<int>(node_domains.size());
+
+	layout.threads_per_rank =
+		std::max(1, layout.node_cores / layout.local_size);
+	if (threads_override > 0)
+		layout.threads_per_rank = threads_override;
+
+	// Contiguous slice of the node cores, wraps around when the
+	// node is oversubscribed
+	std::set<int> rank_domains;
+	for (int thread = 0; thread < layout.threads_per_rank; thread++)
+	{
+		const int slot =
+			(layout.local_rank * layout.threads_per_rank + thread) %
+			layout.node_cores;
+		layout.cpus.push_back(node_cpus[slot]);
+		rank_domains.insert(numa_of_cpu[node_cpus[slot]]);
+	}
+	layout.rank_numa_domains =
+		static_cast<int>(rank_domains.size());
+	return layout;
+}
+
+bool applyLayout(const Layout &layout)
+{
+	omp_set_dynamic(0);
+	omp_set_num_threads(layout.threads_per_rank);
+	int all_pinned = 1;
+#pragma omp parallel default(none) shared(layout)                  \
+	reduction(min                                                  \
+			  : all_pinned)
+	{
+		const int thread = omp_get_thread_num();
+		const int cpu = layout.cpus[thread % layout.cpus.size()];
+		cpu_set_t mask;
+		CPU_ZERO(&mask);
+		CPU_SET(cpu, &mask);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(mask),
+								   &mask) != 0)
+			all_pinned = 0;
+	}
+	return all_pinned == 1;
+}
+
+std::string describeLayout(const Layout &layout)
+{
+	std::ostringstream line;
+	line << "Rank:\t" << layout.world_rank << "/"
+		 << layout.world_size << "\tHost:\t" << layout.hostname
+		 << "\tLocal rank:\t" << layout.local_rank << "/"
+		 << layout.local_size << "\tNode cores:\t"
+		 << layout.node_cores << "\tNUMA domains:\t"
+		 << layout.rank_numa_domains << "/" << layout.numa_domains
+		 << "\tThreads:\t" << layout.threads_per_rank
+		 << "\tCPUs:\t";
+	for (size_t i = 0; i < layout.cpus.size(); i++)
+	{
+		line << layout.cpus[i];
+		if (i + 1 < layout.cpus.size())
+			line << ",";
+	}
+	return line.str();
+}
+
+std::vector<std::string> gatherLayouts(const Layout &layout,
+									   MPI_Comm comm, int root)
+{
+	return gather::gatherStrings(describeLayout(layout), comm,
+								 root);
+}
+
+} // namespace hybrid
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+
+namespace hybrid
+{
+
+/**
+ * @brief Rank/thread layout chosen for one MPI rank.
+ *
+ * The layout describes how the ranks sharing a node split the
+ * node's cores between them, and which CPUs the OpenMP threads of
+ * this rank are pinned to.
+ */
+struct Layout
+{
+	int world_rank = 0;
+	int world_size = 1;
+	// Ranks sharing the same node (shared memory domain)
+	int local_rank = 0;
+	int local_size = 1;
+	// Cores available to the job on this node
+	int node_cores = 1;
+	// NUMA domains spanned by the node cores
+	int numa_domains = 1;
+	// NUMA domains spanned by the CPUs of this rank
+	int rank_numa_domains = 1;
+	int threads_per_rank = 1;
+	// CPUs assigned to this rank, one per OpenMP thread
+	std::vector<int> cpus;
+	std::string hostname;
+};
+
+/**
+ * @brief Discovers the node topology and sizes the OpenMP team.
+ *
+ * Ranks on the same node are found with
+ * `MPI_Comm_split_type(MPI_COMM_TYPE_SHARED)`. The node cores are
+ * the union of the affinity masks of those ranks, ordered by NUMA
+ * domain so that every rank receives a contiguous slice that stays
+ * inside as few domains as possible. Unless overridden, each rank
+ * gets `node_cores / local_size` threads so that ranks x threads
+ * equals the cores of the node.
+ *
+ * @param comm The communicator of the job.
+ * @param threads_override Threads per rank requested by the user,
+ * or 0 to derive it from the topology.
+ * @return The layout of the calling rank.
+ */
+Layout discoverLayout(MPI_Comm comm, int threads_override = 0);
+
+/**
+ * @brief Sets the OpenMP team size and pins every thread of the
+ * team to its CPU from the layout.
+ *
+ * @param layout The layout returned by `discoverLayout`.
+ * @return `true` if all threads were pinned; `false` if pinning
+ * failed for at least one thread.
+ */
+bool applyLayout(const Layout &layout);
+
+/**
+ * @brief Formats the layout as a single tab-separated log line.
+ *
+ * @param layout The layout to describe.
+ * @return The description of the layout.
+ */
+std::string describeLayout(const Layout &layout);
+
+/**
+ * @brief Collects the layout description of every rank on the root.
+ *
+ * @param layout The layout of the calling rank.
+ * @param comm The communicator of the job.
+ * @param root The rank receiving the descriptions.
+ * @return One description per rank on `root`, empty elsewhere.
+ */
+std::vector<std::string> gatherLayouts(const Layout &layout,
+									   MPI_Comm comm, int root = 0);
+
+} // namespace hybrid
@@ -0,0 +1,189 @@
+#include "ImageIO.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+namespace imageio
+{
+bool writeBinary(const std::string &path, const int *rows,
+				 int width, int row_count, int first_row,
+				 int height)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+	{
+		std::cerr << "Error: Cannot open file: " << path
+				  << std::endl;
+		return false;
+	}
+	return writeBinary(out, rows, width, row_count, first_row,
+					   height);
+}
+
+bool writeBinaryHeader(std::ostream &out, int width, int row_count,
+					   int first_row, int height)
+{
+	const int32_t header[4] = {width, row_count, first_row, height};
+	out.write(BINARY_MAGIC, sizeof(BINARY_MAGIC));
+	out.write(reinterpret_cast<const char *>(header),
+			  sizeof(header));
+	return out.good();
+}
+
+bool writeBinary(std::ostream &out, const int *rows, int width,
+				 int row_count, int first_row, int height)
+{
+	writeBinaryHeader(out, width, row_count, first_row, height);
+	out.write(reinterpret_cast<const char *>(rows),
+			  static_cast<std::streamsize>(sizeof(int32_t)) *
+				  width * row_count);
+	return out.good();
+}
+
+bool writeManifest(const std::string &path, const ImageInfo &image)
+{
+	std::ofstream out(path, std::ios::trunc);
+	if (!out.is_open())
+	{
+		std::cerr << "Error: Cannot open file: " << path
+				  << std::endl;
+		return false;
+	}
+	const fs::path base = fs::path(path).parent_path();
+	out << "mandelbrot-manifest 1" << std::endl;
+	out << "width " << image.width << std::endl;
+	out << "height " << image.height << std::endl;
+	out << "iterations " << image.iterations << std::endl;
+	out << "shards " << image.shards.size() << std::endl;
+	for (const ShardInfo &shard : image.shards)
+	{
+		out << "shard "
+			<< fs::path(shard.path)
+				   .lexically_relative(base)
+				   .string()
+			<< " " << shard.first_row << " " << shard.row_count
+			<< std::endl;
+	}
+	return out.good();
+}
+
+// Reads the header of a single binary file
+ImageInfo openBinary(const std::string &path)
+{
+	ImageInfo image;
+	std::ifstream in(path, std::ios::binary);
+	char magic[sizeof(BINARY_MAGIC)];
+	int32_t header[4];
+	in.read(magic, sizeof(magic));
+	in.read(reinterpret_cast<char *>(header), sizeof(header));
+	if (!in.good() ||
+		std::memcmp(magic, BINARY_MAGIC, sizeof(magic)) != 0)
+	{
+		std::cerr << "Error: Not a binary image: " << path
+				  << std::endl;
+		return image;
+	}
+	image.width = header[0];
+	image.height = header[3];
+	image.shards.push_back({path, header[2], header[1]});
+	return image;
+}
+
+ImageInfo openManifest(const std::string &path)
+{
+	ImageInfo image;
+	std::ifstream in(path);
+	if (!in.is_open())
+	{
+		std::cerr << "Error: Cannot open file: " << path
+				  << std::endl;
+		return image;
+	}
+	const fs::path base = fs::path(path).parent_path();
+	std::string line;
+	while (std::getline(in, line))
+	{
+		std::istringstream fields(line);
+		std::string key;
+		fields >> key;
+		if (key == "width")
+			fields >> image.width;
+		else if (key == "height")
+			fields >> image.height;
+		else if (key == "iterations")
+			fields >> image.iterations;
+		else if (key == "shard")
+		{
+			ShardInfo shard;
+			fields >> shard.path >> shard.first_row >>
+				shard.row_count;
+			shard.path = (base / shard.path).string();
+			image.shards.push_back(shard);
+		}
+	}
+	std::sort(image.shards.begin(), image.shards.end(),
+			  [](const ShardInfo &a, const ShardInfo &b)
+			  { return a.first_row < b.first_row; });
+	return image;
+}
+
+ImageInfo openImage(const std::string &path)
+{
+	if (fs::path(path).extension() == ".manifest")
+		return openManifest(path);
+	return openBinary(path);
+}
+
+bool readRows(const ImageInfo &image, int first_row, int row_count,
+			  int *dest)
+{
+	int rows_read = 0;
+	const int last_row = first_row + row_count;
+	for (const ShardInfo &shard : image.shards)
+	{
+		const int begin = std::max(first_row, shard.first_row);
+		const int end =
+			std::min(last_row, shard.first_row + shard.row_count);
+		if (begin >= end)
+			continue;
+		std::ifstream in(shard.path, std::ios::binary);
+		const std::streamoff offset =
+			BINARY_HEADER_SIZE +
+			static_cast<std::streamoff>(sizeof(int32_t)) *
+				image.width * (begin - shard.first_row);
+		in.seekg(offset);
+		const std::streamsize bytes =
+			static_cast<std::streamsize>(sizeof(int32_t)) *
+			image.width * (end - begin);
+		in.read(reinterpret_cast<char *>(
+					dest + static_cast<size_t>(begin - first_row) *
+							   image.width),
+				bytes);
+		if (in.gcount() != bytes)
+		{
+			std::cerr << "Error: Truncated shard: " << shard.path
+					  << std::endl;
+			return false;
+		}
+		rows_read += end - begin;
+	}
+	return rows_read == row_count;
+}
+
+std::string manifestPath(const std::string &output_file)
+{
+	return output_file + ".manifest";
+}
+
+std::string shardPath(const std::string &output_file, int rank)
+{
+	return output_file + ".shards/rank_" + std::to_string(rank) +
+		   ".mbin";
+}
+} // namespace imageio
\ No newline at end of file
@@ -0,0 +1,118 @@
+// ImageIO.h
+#pragma once
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace imageio
+{
+/**
+ * @brief Binary image file layout.
+ *
+ * Every binary file starts with a 20 byte header: the magic "MBI1"
+ * followed by four native int32 values (width, rows stored in the
+ * file, first stored row, height of the full image). The escape
+ * counts follow as `width * rows` native int32 values, row major.
+ * A complete image is a file with first row 0 and rows == height;
+ * a shard holds a contiguous band of rows of a larger image.
+ */
+constexpr char BINARY_MAGIC[4] = {'M', 'B', 'I', '1'};
+constexpr int BINARY_HEADER_SIZE = 20;
+
+struct ShardInfo
+{
+	std::string path;
+	int first_row = 0;
+	int row_count = 0;
+};
+
+/**
+ * @brief A logical image made of one or more binary files.
+ */
+struct ImageInfo
+{
+	int width = 0;
+	int height = 0;
+	int iterations = 0;
+	std::vector<ShardInfo> shards;
+};
+
+/**
+ * @brief Writes a band of rows in the binary format.
+ *
+ * @param path The file to write, truncated if it exists.
+ * @param rows The escape counts, `width * row_count` values.
+ * @param width The image width.
+ * @param row_count The number of rows in the band.
+ * @param first_row The first image row of the band.
+ * @param height The height of the full image.
+ * @return `true` if the file was written completely.
+ */
+bool writeBinary(const std::string &path, const int *rows,
+				 int width, int row_count, int first_row,
+				 int height);
+
+/**
+ * @brief Writes a band of rows in the binary format to a stream.
+ *
+ * @return `true` if the stream is still good afterwards.
+ */
+bool writeBinary(std::ostream &out, const int *rows, int width,
+				 int row_count, int first_row, int height);
+
+/**
+ * @brief Writes only the header of a band, for writers that stream
+ * its `width * row_count` values afterwards.
+ *
+ * @return `true` if the stream is still good afterwards.
+ */
+bool writeBinaryHeader(std::ostream &out, int width, int row_count,
+					   int first_row, int height);
+
+/**
+ * @brief Writes the text manifest describing a sharded image.
+ *
+ * Shard paths are stored relative to the manifest directory so the
+ * output can be moved as a whole.
+ *
+ * @param path The manifest file to write.
+ * @param image The logical image and its shards.
+ * @return `true` if the manifest was written.
+ */
+bool writeManifest(const std::string &path, const ImageInfo &image);
+
+/**
+ * @brief Opens a binary file or a shard manifest as one image.
+ *
+ * Files ending in ".manifest" are parsed as manifests, anything
+ * else is read as a single binary file.
+ *
+ * @param path The manifest or binary file.
+ * @return The image description, `width == 0` if it cannot be
+ * opened.
+ */
+ImageInfo openImage(const std::string &path);
+
+/**
+ * @brief Reads a band of rows of a logical image, spanning shards
+ * if needed.
+ *
+ * @param image The image returned by `openImage`.
+ * @param first_row The first row to read.
+ * @param row_count The number of rows to read.
+ * @param dest Destination for `image.width * row_count` values.
+ * @return `true` if every requested row was read.
+ */
+bool readRows(const ImageInfo &image, int first_row, int row_count,
+			  int *dest);
+
+/**
+ * @brief Returns the shard manifest path for an output file.
+ */
+std::string manifestPath(const std::string &output_file);
+
+/**
+ * @brief Returns the path of the shard written by a rank.
+ */
+std::string shardPath(const std::string &output_file, int rank);
+} // namespace imageio
\ No newline at end of file
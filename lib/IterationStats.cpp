@@ -0,0 +1,165 @@
+#include "IterationStats.h"
+
+#include <LogUtils.h>
+#include <fstream>
+#include <sstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace iterstats
+{
+namespace
+{
+int bucketOf(int escape_time)
+{
+	int bucket = 0;
+	while (escape_time > 0)
+	{
+		escape_time >>= 1;
+		bucket++;
+	}
+	return bucket;
+}
+} // namespace
+
+double Stats::gigaIterationsPerSecond(double seconds) const
+{
+	return seconds > 0.0 ? executed / seconds / 1e9 : 0.0;
+}
+
+double Stats::gigaFlopsPerSecond(double seconds) const
+{
+	return gigaIterationsPerSecond(seconds) * FLOPS_PER_ITERATION;
+}
+
+int bucketCount(int iterations) { return bucketOf(iterations) + 1; }
+
+void bucketRange(int bucket, int iterations, int &low, int &high)
+{
+	if (bucket == 0)
+	{
+		low = high = 0;
+		return;
+	}
+	low = 1 << (bucket - 1);
+	high = (1 << bucket) - 1;
+	if (high > iterations)
+		high = iterations;
+}
+
+Stats count(const int *escape_times, size_t pixels, int iterations)
+{
+	Stats stats;
+	stats.iterations = iterations;
+	stats.pixels = static_cast<int64_t>(pixels);
+	const int buckets = bucketCount(iterations);
+	stats.histogram.assign(buckets, 0);
+	int64_t executed = 0;
+	std::vector<int64_t> &histogram = stats.histogram;
+
+#ifdef _OPENMP
+#pragma omp parallel default(none)                                 \
+	shared(escape_times, pixels, iterations, buckets, histogram)   \
+	reduction(+ : executed)
+#endif
+	{
+		std::vector<int64_t> local(buckets, 0);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+		for (size_t pos = 0; pos < pixels; pos++)
+		{
+			const int escape = escape_times[pos];
+			executed += escape == 0 ? iterations : escape;
+			local[bucketOf(escape)]++;
+		}
+#ifdef _OPENMP
+#pragma omp critical(iterstats_merge)
+#endif
+		for (int b = 0; b < buckets; b++)
+			histogram[b] += local[b];
+	}
+	stats.executed = executed;
+	stats.bounded = stats.histogram[0];
+	return stats;
+}
+
+void merge(Stats &into, const Stats &other)
+{
+	into.iterations = other.iterations;
+	into.pixels += other.pixels;
+	into.bounded += other.bounded;
+	into.executed += other.executed;
+	into.executed_known =
+		into.executed_known && other.executed_known;
+	if (into.histogram.size() < other.histogram.size())
+		into.histogram.resize(other.histogram.size(), 0);
+	for (size_t b = 0; b < other.histogram.size(); b++)
+		into.histogram[b] += other.histogram[b];
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Executed Iterations,GIterations/s,GFLOP/s";
+}
+
+std::string csvColumns(const Stats &stats, double seconds)
+{
+	if (!stats.executed_known)
+		return ",,,";
+	std::ostringstream columns;
+	columns << "," << stats.executed << ","
+			<< stats.gigaIterationsPerSecond(seconds) << ","
+			<< stats.gigaFlopsPerSecond(seconds);
+	return columns.str();
+}
+
+bool appendHistogramCsv(const std::string &path,
+						const std::string &timestamp,
+						const std::string &program, int resolution,
+						const Stats &stats)
+{
+	const std::string header = "DateTime,Program,Iterations,"
+							   "Resolution,Bucket Low,Bucket High,"
+							   "Pixels";
+	const bool has_header =
+		logutils::csvFileHasHeader(path, header);
+	std::ofstream csv(path, std::ios::app);
+	if (!csv.is_open())
+		return false;
+	if (!has_header)
+		csv << header << std::endl;
+	for (size_t b = 0; b < stats.histogram.size(); b++)
+	{
+		int low = 0, high = 0;
+		bucketRange(static_cast<int>(b), stats.iterations, low,
+					high);
+		csv << timestamp << "," << program << ","
+			<< stats.iterations << "," << resolution << "," << low
+			<< "," << high << "," << stats.histogram[b]
+			<< std::endl;
+	}
+	return csv.good();
+}
+
+std::string describe(const Stats &stats, double seconds)
+{
+	std::ostringstream text;
+	text << "\tPixels:\t" << stats.pixels << "\tBounded:\t"
+		 << stats.bounded;
+	if (!stats.executed_known)
+		return text.str();
+	text << "\tExecuted iterations:\t" << stats.executed
+		 << "\tMean per pixel:\t"
+		 << (stats.pixels > 0
+				 ? static_cast<double>(stats.executed) /
+					   stats.pixels
+				 : 0.0)
+		 << "\tGIterations/s:\t"
+		 << stats.gigaIterationsPerSecond(seconds) << "\tGFLOP/s:\t"
+		 << stats.gigaFlopsPerSecond(seconds);
+	return text.str();
+}
+} // namespace iterstats
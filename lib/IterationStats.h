@@ -0,0 +1,97 @@
+// IterationStats.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace iterstats
+{
+/**
+ * @brief Floating point operations of one z = z^2 + c step plus the
+ * escape test: complex multiply (4 mul, 2 add), adding c (2 add)
+ * and the squared magnitude (2 mul, 1 add). The square root of
+ * std::abs is not counted, so the derived FLOP/s is an effective
+ * rate.
+ */
+constexpr double FLOPS_PER_ITERATION = 11.0;
+
+/**
+ * @brief Work actually executed for an image and its escape-time
+ * histogram.
+ *
+ * Bucket 0 holds the bounded points (escape time 0, every
+ * iteration executed), bucket k > 0 the escape times in
+ * [2^(k-1), 2^k).
+ */
+struct Stats
+{
+	int iterations = 0;
+	int64_t pixels = 0;
+	int64_t bounded = 0;
+	int64_t executed = 0;
+	// False when the image was not brute forced, `executed` and the
+	// rates then do not describe the work and are not reported
+	bool executed_known = true;
+	std::vector<int64_t> histogram;
+
+	double gigaIterationsPerSecond(double seconds) const;
+	double gigaFlopsPerSecond(double seconds) const;
+};
+
+/**
+ * @brief Number of histogram buckets for an iteration cap.
+ */
+int bucketCount(int iterations);
+
+/**
+ * @brief Escape times covered by a bucket, both inclusive.
+ */
+void bucketRange(int bucket, int iterations, int &low, int &high);
+
+/**
+ * @brief Counts executed iterations and builds the histogram.
+ *
+ * The executed work follows from the escape times: an escaping
+ * point ran exactly its escape time, a bounded one the whole cap.
+ * Every thread fills a private histogram which is merged at the
+ * end, the pass runs after the timed kernel so the timing is
+ * unaffected.
+ *
+ * @param escape_times `pixels` escape times, 0 for bounded points.
+ */
+Stats count(const int *escape_times, size_t pixels, int iterations);
+
+/**
+ * @brief Adds `other` into `into`, both for the same cap.
+ */
+void merge(Stats &into, const Stats &other);
+
+/**
+ * @brief ",Executed Iterations,GIterations/s,GFLOP/s".
+ */
+std::string csvHeaderColumns();
+
+/**
+ * @brief CSV values matching `csvHeaderColumns`, each prefixed with
+ * a comma; empty unless `executed_known`.
+ *
+ * @param seconds The compute time the rates refer to.
+ */
+std::string csvColumns(const Stats &stats, double seconds);
+
+/**
+ * @brief Appends the histogram in long form (one row per bucket)
+ * to a CSV file, adding the header when the file is new.
+ */
+bool appendHistogramCsv(const std::string &path,
+						const std::string &timestamp,
+						const std::string &program, int resolution,
+						const Stats &stats);
+
+/**
+ * @brief Tab separated log line with the totals and the rates, the
+ * latter only if `executed_known`.
+ */
+std::string describe(const Stats &stats, double seconds);
+} // namespace iterstats
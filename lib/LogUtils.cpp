@@ -1,274 +1,923 @@
-#include "LogUtils.h"
-
-#include <filesystem>
-#include <fstream>
-#include <iostream>
-#include <string>
-
-namespace fs = std::filesystem;
-namespace logutils
-{
-std::string getCurrentTimestamp()
-{
-	auto now = std::chrono::system_clock::now();
-	std::time_t now_time_t =
-		std::chrono::system_clock::to_time_t(now);
-	std::tm now_tm;
-#ifdef _WIN32
-	localtime_s(&now_tm, &now_time_t);
-#else
-	localtime_r(&now_time_t, &now_tm);
-#endif
-
-	std::ostringstream timestamp_stream;
-	timestamp_stream << std::put_time(
-		&now_tm,
-		"%b %d %Y %H:%M:%S"); // e.g., "Oct 19 2024 21:35:37"
-	return timestamp_stream.str();
-}
-
-// Helper function to extract the base filename up to the second
-// underscore
-std::string extractBaseFilename(const std::string &filename)
-{
-	size_t firstUnderscore = filename.find('_');
-	if (firstUnderscore == std::string::npos)
-		return filename;
-
-	size_t secondUnderscore =
-		filename.find('_', firstUnderscore + 1);
-	if (secondUnderscore == std::string::npos)
-		return filename;
-
-	return filename.substr(0, secondUnderscore);
-}
-
-// Generalized function to create a filename with a specific folder
-// and extension
-std::string createFilename(const std::string &output_file,
-						   const std::string &additionalName,
-						   const std::string &folder,
-						   const std::string &extension)
-{
-	fs::path outputPath(output_file);
-	std::string baseFilename =
-		extractBaseFilename(outputPath.stem().string());
-
-	fs::path targetPath =
-		outputPath.parent_path().parent_path() / folder /
-		(baseFilename + additionalName + extension);
-
-	fs::create_directories(targetPath.parent_path());
-	std::cout << "Creating file: " << targetPath.string()
-			  << std::endl;
-	return targetPath.string();
-}
-
-std::string create_log_file_name(const std::string &output_file,
-								 const std::string &additionalName)
-{
-	return createFilename(output_file, additionalName, "logs",
-						  ".log");
-}
-
-std::string createCsvFilename(const std::string &output_file,
-							  const std::string &additionalName)
-{
-	std::cout << "Creating CSV file name from output file: "
-			  << output_file << std::endl;
-	std::string csvPath =
-		createFilename(output_file, additionalName, "data", ".csv");
-	return csvPath;
-}
-
-bool csvFileHasHeader(const std::string &filePath,
-					  const std::string &header)
-{
-	std::ifstream file(filePath);
-	if (!file.good() || !file.is_open())
-	{
-		std::cerr << "Error: Cannot open file: " << filePath
-				  << std::endl;
-		return false;
-	}
-
-	std::string firstLine;
-	if (!std::getline(file, firstLine))
-	{
-		std::cerr << "Error: Unable to read from file: " << filePath
-				  << std::endl;
-		return false;
-	}
-	bool has_header = (firstLine == header);
-	std::cout << "Header present: "
-			  << (has_header ? "true" : "false") << std::endl;
-	return has_header;
-}
-
-} // namespace logutils
-
-namespace cmdParse
-{
-cmdParse::Command get_command(const std::string &arg)
-{
-	if (arg == "--help")
-		return Command::HELP;
-	if (arg == "--version")
-		return Command::VERSION;
-	if (arg == "--iterations")
-		return Command::ITERATIONS;
-	if (arg == "--resolution")
-		return Command::RESOLUTION;
-	if (arg == "--threads")
-		return Command::THREADS_NUMBER;
-	// Assuming the first non-flag argument is the output file
-	return Command::INVALID;
-}
-
-cmdParse::ParsedArgs parse_cmd_arguments(int argc, char *argv[])
-{
-	ParsedArgs args;
-	try
-	{
-		std::filesystem::path filePath = argv[0];
-		std::string fileName = filePath.filename().string();
-
-		if (argc < 2)
-		{
-			std::cerr << "Usage: " << fileName
-					  << " <output_file> [options]" << std::endl;
-			exit(EXIT_FAILURE);
-		}
-
-		for (int i = 1; i < argc; ++i)
-		{
-			std::string arg = argv[i];
-			Command cmd = get_command(arg);
-
-			switch (cmd)
-			{
-			case Command::HELP:
-				std::cout
-					<< "Usage: " << fileName
-					<< " <output_file> [--iterations <iterations>] "
-					   "[--resolution <resolution>] [--version]"
-					<< std::endl;
-				exit(EXIT_SUCCESS);
-
-			case Command::VERSION:
-				std::cout << "Version: 1.0.0" << std::endl;
-				exit(EXIT_SUCCESS);
-			case Command::OUTPUT_FILE:
-				if (args.output_file.empty())
-				{
-					args.output_file = arg;
-				}
-				else
-				{
-					std::cerr
-						<< "Invalid argument or multiple output "
-						   "files specified: "
-						<< arg << std::endl;
-					exit(EXIT_FAILURE);
-				}
-				break;
-			case Command::ITERATIONS:
-				if (i + 1 < argc)
-				{
-					args.iterations = std::stoi(argv[++i]);
-					if (args.iterations <= 0)
-					{
-						std::cerr
-							<< "--iterations must be a positive "
-							   "integer."
-							<< std::endl;
-						exit(EXIT_FAILURE);
-					}
-				}
-				else
-				{
-					std::cerr << "--iterations requires a value."
-							  << std::endl;
-					exit(EXIT_FAILURE);
-				}
-				break;
-
-			case Command::RESOLUTION:
-				if (i + 1 < argc)
-				{
-					args.resolution = std::stoi(argv[++i]);
-					if (args.resolution <= 0)
-					{
-						std::cerr
-							<< "--resolution must be a positive "
-							   "integer."
-							<< std::endl;
-						exit(EXIT_FAILURE);
-					}
-				}
-				else
-				{
-					std::cerr << "--resolution requires a value."
-							  << std::endl;
-					exit(EXIT_FAILURE);
-				}
-				break;
-			case Command::THREADS_NUMBER:
-				if (i + 1 < argc)
-				{
-					args.threads_num = std::stoi(argv[++i]);
-					if (args.threads_num <= 0)
-					{
-						std::cerr << "--threads must be a positive "
-									 "integer."
-								  << std::endl;
-						exit(EXIT_FAILURE);
-					}
-				}
-				else
-				{
-					std::cerr << "--threads requires a value."
-							  << std::endl;
-					exit(EXIT_FAILURE);
-				}
-				break;
-			case Command::INVALID:
-				if (args.output_file.empty())
-				{
-					args.output_file = arg;
-				}
-				else
-				{
-					std::cerr
-						<< "Invalid argument or multiple output "
-						   "files specified: "
-						<< arg << std::endl;
-					exit(EXIT_FAILURE);
-				}
-				break;
-			}
-		}
-
-		if (args.output_file.empty())
-		{
-			std::cerr
-				<< "Please specify the output file as a parameter."
-				<< std::endl;
-			exit(EXIT_FAILURE);
-		}
-	}
-	catch (const std::exception &e)
-	{
-		std::cerr << "Error parsing arguments: [";
-		for (int i = 0; i < argc; ++i)
-		{
-			std::cerr << argv[i];
-			if (i < argc - 1)
-				std::cerr << ", ";
-		}
-		std::cerr << "] " << e.what() << std::endl;
-		exit(EXIT_FAILURE);
-	}
-	return args;
-}
-} // namespace cmdParse
+#include "LogUtils.h"
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+
+namespace fs = std::filesystem;
+namespace logutils
+{
+std::string getCurrentTimestamp()
+{
+	auto now = std::chrono::system_clock::now();
+	std::time_t now_time_t =
+		std::chrono::system_clock::to_time_t(now);
+	std::tm now_tm;
+#ifdef _WIN32
+	localtime_s(&now_tm, &now_time_t);
+#else
+	localtime_r(&now_time_t, &now_tm);
+#endif
+
+	std::ostringstream timestamp_stream;
+	timestamp_stream << std::put_time(
+		&now_tm,
+		"%b %d %Y %H:%M:%S"); // e.g., "Oct 19 2024 21:35:37"
+	return timestamp_stream.str();
+}
+
+// Helper function to extract the base filename up to the second
+// underscore
+std::string extractBaseFilename(const std::string &filename)
+{
+	size_t firstUnderscore = filename.find('_');
+	if (firstUnderscore == std::string::npos)
+		return filename;
+
+	size_t secondUnderscore =
+		filename.find('_', firstUnderscore + 1);
+	if (secondUnderscore == std::string::npos)
+		return filename;
+
+	return filename.substr(0, secondUnderscore);
+}
+
+// Generalized function to create a filename with a specific folder
+// and extension
+std::string createFilename(const std::string &output_file,
+						   const std::string &additionalName,
+						   const std::string &folder,
+						   const std::string &extension)
+{
+	fs::path outputPath(output_file);
+	std::string baseFilename =
+		extractBaseFilename(outputPath.stem().string());
+
+	fs::path targetPath =
+		outputPath.parent_path().parent_path() / folder /
+		(baseFilename + additionalName + extension);
+
+	fs::create_directories(targetPath.parent_path());
+	std::cout << "Creating file: " << targetPath.string()
+			  << std::endl;
+	return targetPath.string();
+}
+
+std::string create_log_file_name(const std::string &output_file,
+								 const std::string &additionalName)
+{
+	return createFilename(output_file, additionalName, "logs",
+						  ".log");
+}
+
+std::string createCsvFilename(const std::string &output_file,
+							  const std::string &additionalName)
+{
+	std::cout << "Creating CSV file name from output file: "
+			  << output_file << std::endl;
+	std::string csvPath =
+		createFilename(output_file, additionalName, "data", ".csv");
+	return csvPath;
+}
+
+bool csvFileHasHeader(const std::string &filePath,
+					  const std::string &header)
+{
+	std::ifstream file(filePath);
+	if (!file.good() || !file.is_open())
+	{
+		std::cerr << "Error: Cannot open file: " << filePath
+				  << std::endl;
+		return false;
+	}
+
+	// The header of the last schema section is the current one
+	const std::string first_column =
+		header.substr(0, header.find(','));
+	std::string line, lastHeader;
+	bool empty = true;
+	while (std::getline(file, line))
+	{
+		empty = false;
+		if (line.compare(0, first_column.size(), first_column) == 0)
+			lastHeader = line;
+	}
+	if (empty)
+	{
+		std::cerr << "Error: Unable to read from file: " << filePath
+				  << std::endl;
+		return false;
+	}
+	bool has_header = (lastHeader == header);
+	std::cout << "Header present: "
+			  << (has_header ? "true" : "false") << std::endl;
+	return has_header;
+}
+
+PhaseRegistry::PhaseRegistry(const std::vector<std::string> &names)
+	: names(names), times(names.size(), 0.0), declared(names.size())
+{
+}
+
+void PhaseRegistry::add(const std::string &name, double seconds)
+{
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		if (names[i] == name)
+		{
+			times[i] += seconds;
+			return;
+		}
+	}
+	names.push_back(name);
+	times.push_back(seconds);
+}
+
+double PhaseRegistry::seconds(const std::string &name) const
+{
+	for (size_t i = 0; i < names.size(); i++)
+		if (names[i] == name)
+			return times[i];
+	return 0.0;
+}
+
+double PhaseRegistry::total() const
+{
+	double sum = 0.0;
+	for (double time : times)
+		sum += time;
+	return sum;
+}
+
+std::string PhaseRegistry::csvHeaderColumns() const
+{
+	std::string columns;
+	for (size_t i = 0; i < declared; i++)
+		columns += "," + names[i] + " (s)";
+	return columns + ",Total (s)";
+}
+
+std::string PhaseRegistry::csvColumns() const
+{
+	std::ostringstream columns;
+	for (size_t i = 0; i < declared; i++)
+		columns << "," << times[i];
+	columns << "," << total();
+	return columns.str();
+}
+
+std::string PhaseRegistry::describe() const
+{
+	const double sum = total();
+	std::ostringstream text;
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		text << "\tPhase:\t" << names[i] << "\t" << times[i]
+			 << "\tseconds\t"
+			 << (sum > 0.0 ? 100.0 * times[i] / sum : 0.0) << "\t%"
+			 << std::endl;
+	}
+	text << "\tPhase:\tTotal\t" << sum << "\tseconds" << std::endl;
+	return text.str();
+}
+
+ScopedTimer::ScopedTimer(PhaseRegistry &registry, std::string name)
+	: registry(registry), name(std::move(name)),
+	  start(std::chrono::steady_clock::now())
+{
+}
+
+ScopedTimer::~ScopedTimer()
+{
+	if (running)
+		stop();
+}
+
+double ScopedTimer::stop()
+{
+	const double seconds =
+		std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start)
+			.count();
+	if (running)
+		registry.add(name, seconds);
+	running = false;
+	return seconds;
+}
+
+} // namespace logutils
+
+namespace cmdParse
+{
+cmdParse::Command get_command(const std::string &arg)
+{
+	if (arg == "--help")
+		return Command::HELP;
+	if (arg == "--version")
+		return Command::VERSION;
+	if (arg == "--iterations")
+		return Command::ITERATIONS;
+	if (arg == "--resolution")
+		return Command::RESOLUTION;
+	if (arg == "--threads")
+		return Command::THREADS_NUMBER;
+	if (arg == "--threads-per-rank")
+		return Command::THREADS_PER_RANK;
+	if (arg == "--partition")
+		return Command::PARTITION;
+	if (arg == "--rank-timings")
+		return Command::RANK_TIMINGS;
+	if (arg == "--checkpoint-interval")
+		return Command::CHECKPOINT_INTERVAL;
+	if (arg == "--sharded-output")
+		return Command::SHARDED_OUTPUT;
+	if (arg == "--perf-counters")
+		return Command::PERF_COUNTERS;
+	if (arg == "--thread-stats")
+		return Command::THREAD_STATS;
+	if (arg == "--trace")
+		return Command::TRACE;
+	if (arg == "--energy")
+		return Command::ENERGY;
+	if (arg == "--progress")
+		return Command::PROGRESS;
+	if (arg == "--deep-zoom")
+		return Command::DEEP_ZOOM;
+	if (arg == "--deep-kernel")
+		return Command::DEEP_KERNEL;
+	if (arg == "--precision")
+		return Command::PRECISION;
+	if (arg == "--verify-precision")
+		return Command::VERIFY_PRECISION;
+	if (arg == "--center")
+		return Command::CENTER;
+	if (arg == "--zoom")
+		return Command::ZOOM;
+	if (arg == "--frames")
+		return Command::FRAMES;
+	if (arg == "--zoom-factor")
+		return Command::ZOOM_FACTOR;
+	if (arg == "--formula")
+		return Command::FORMULA;
+	if (arg == "--julia")
+		return Command::JULIA;
+	if (arg == "--power")
+		return Command::POWER;
+	if (arg == "--buddhabrot")
+		return Command::BUDDHABROT;
+	if (arg == "--importance")
+		return Command::IMPORTANCE;
+	if (arg == "--seed")
+		return Command::SEED;
+	if (arg == "--distance-estimate")
+		return Command::DISTANCE_ESTIMATE;
+	if (arg == "--distance-margin")
+		return Command::DISTANCE_MARGIN;
+	if (arg == "--aa")
+		return Command::AA;
+	if (arg == "--progressive")
+		return Command::PROGRESSIVE;
+	if (arg == "--progressive-exact")
+		return Command::PROGRESSIVE_EXACT;
+	// Assuming the first non-flag argument is the output file
+	return Command::INVALID;
+}
+
+cmdParse::ParsedArgs parse_cmd_arguments(int argc, char *argv[])
+{
+	ParsedArgs args;
+	try
+	{
+		std::filesystem::path filePath = argv[0];
+		std::string fileName = filePath.filename().string();
+
+		if (argc < 2)
+		{
+			std::cerr << "Usage: " << fileName
+					  << " <output_file> [options]" << std::endl;
+			exit(EXIT_FAILURE);
+		}
+
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			Command cmd = get_command(arg);
+
+			switch (cmd)
+			{
+			case Command::HELP:
+				std::cout
+					<< "Usage: " << fileName
+					<< " <output_file> [--iterations <iterations>] "
+					   "[--resolution <resolution>] "
+					   "[--threads <threads>] "
+					   "[--threads-per-rank <threads>] "
+					   "[--partition <equal|cost>] "
+					   "[--rank-timings] "
+					   "[--checkpoint-interval <seconds>] "
+					   "[--sharded-output] [--perf-counters] "
+					   "[--thread-stats] [--trace <file.json>] "
+					   "[--energy] [--progress <seconds>] "
+					   "[--deep-zoom <re>,<im>,<spacing>] "
+					   "[--deep-kernel <auto|double|double-double|"
+					   "perturbation>] "
+					   "[--precision <double|auto>] "
+					   "[--verify-precision] "
+					   "[--center <x>,<y>] [--zoom <zoom>] "
+					   "[--frames <frames>] [--zoom-factor "
+					   "<factor>] "
+					   "[--formula <mandelbrot|julia|multibrot|"
+					   "burning-ship|tricorn>] [--julia <re>,<im>] "
+					   "[--power <2-8>] "
+					   "[--buddhabrot <samples>] [--importance] "
+					   "[--seed <seed>] [--distance-estimate] "
+					   "[--distance-margin <blocks>] "
+					   "[--aa <4|9|16|...|64>] [--progressive] "
+					   "[--progressive-exact] "
+					   "[--version]"
+					<< std::endl;
+				exit(EXIT_SUCCESS);
+
+			case Command::VERSION:
+				std::cout << "Version: 1.0.0" << std::endl;
+				exit(EXIT_SUCCESS);
+			case Command::OUTPUT_FILE:
+				if (args.output_file.empty())
+				{
+					args.output_file = arg;
+				}
+				else
+				{
+					std::cerr
+						<< "Invalid argument or multiple output "
+						   "files specified: "
+						<< arg << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::ITERATIONS:
+				if (i + 1 < argc)
+				{
+					args.iterations = std::stoi(argv[++i]);
+					if (args.iterations <= 0)
+					{
+						std::cerr
+							<< "--iterations must be a positive "
+							   "integer."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--iterations requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+
+			case Command::RESOLUTION:
+				if (i + 1 < argc)
+				{
+					args.resolution = std::stoi(argv[++i]);
+					if (args.resolution <= 0)
+					{
+						std::cerr
+							<< "--resolution must be a positive "
+							   "integer."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--resolution requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::THREADS_NUMBER:
+				if (i + 1 < argc)
+				{
+					args.threads_num = std::stoi(argv[++i]);
+					if (args.threads_num <= 0)
+					{
+						std::cerr << "--threads must be a positive "
+									 "integer."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--threads requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::THREADS_PER_RANK:
+				if (i + 1 < argc)
+				{
+					args.threads_per_rank = std::stoi(argv[++i]);
+					if (args.threads_per_rank <= 0)
+					{
+						std::cerr << "--threads-per-rank must be a "
+									 "positive integer."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr
+						<< "--threads-per-rank requires a value."
+						<< std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::PARTITION:
+				if (i + 1 < argc)
+				{
+					args.partition = argv[++i];
+					if (args.partition != "equal" &&
+						args.partition != "cost")
+					{
+						std::cerr << "--partition must be 'equal' "
+									 "or 'cost'."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--partition requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::RANK_TIMINGS:
+				args.rank_timings = true;
+				break;
+			case Command::CHECKPOINT_INTERVAL:
+				if (i + 1 < argc)
+				{
+					args.checkpoint_interval = std::stoi(argv[++i]);
+					if (args.checkpoint_interval <= 0)
+					{
+						std::cerr
+							<< "--checkpoint-interval must be "
+							   "a positive integer."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr
+						<< "--checkpoint-interval requires a value."
+						<< std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::SHARDED_OUTPUT:
+				args.sharded_output = true;
+				break;
+			case Command::PERF_COUNTERS:
+				args.perf_counters = true;
+				break;
+			case Command::THREAD_STATS:
+				args.thread_stats = true;
+				break;
+			case Command::TRACE:
+				if (i + 1 < argc)
+				{
+					args.trace_file = argv[++i];
+					args.thread_stats = true;
+				}
+				else
+				{
+					std::cerr << "--trace requires a file name."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::ENERGY:
+				args.energy = true;
+				break;
+			case Command::PROGRESS:
+				if (i + 1 < argc)
+				{
+					args.progress_interval = std::stod(argv[++i]);
+					if (args.progress_interval <= 0.0)
+					{
+						std::cerr
+							<< "--progress must be a positive "
+							   "number of seconds."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--progress requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::DEEP_ZOOM:
+				if (i + 1 < argc)
+				{
+					// re,im,spacing; the centre stays a string so
+					// that no digit is lost to a double
+					const std::string value = argv[++i];
+					const size_t first = value.find(',');
+					const size_t second =
+						first == std::string::npos
+							? std::string::npos
+							: value.find(',', first + 1);
+					if (second == std::string::npos)
+					{
+						std::cerr << "--deep-zoom must be "
+									 "<re>,<im>,<spacing>."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+					args.deep_center_re = value.substr(0, first);
+					args.deep_center_im =
+						value.substr(first + 1, second - first - 1);
+					args.deep_spacing =
+						std::stod(value.substr(second + 1));
+					if (args.deep_center_re.empty() ||
+						args.deep_center_im.empty() ||
+						!(args.deep_spacing > 0.0))
+					{
+						std::cerr
+							<< "--deep-zoom needs a centre and "
+							   "a positive pixel spacing."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--deep-zoom requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::DEEP_KERNEL:
+				if (i + 1 < argc)
+				{
+					args.deep_kernel = argv[++i];
+					if (args.deep_kernel != "auto" &&
+						args.deep_kernel != "double" &&
+						args.deep_kernel != "double-double" &&
+						args.deep_kernel != "perturbation")
+					{
+						std::cerr
+							<< "--deep-kernel must be 'auto', "
+							   "'double', 'double-double' or "
+							   "'perturbation'."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--deep-kernel requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::PRECISION:
+				if (i + 1 < argc)
+				{
+					args.precision = argv[++i];
+					if (args.precision != "double" &&
+						args.precision != "auto")
+					{
+						std::cerr
+							<< "--precision must be 'double' or "
+							   "'auto'."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--precision requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::VERIFY_PRECISION:
+				args.verify_precision = true;
+				break;
+			case Command::CENTER:
+				if (i + 1 < argc)
+				{
+					const std::string value = argv[++i];
+					const size_t comma = value.find(',');
+					if (comma == std::string::npos)
+					{
+						std::cerr << "--center must be <x>,<y>."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+					args.center_x =
+						std::stod(value.substr(0, comma));
+					args.center_y =
+						std::stod(value.substr(comma + 1));
+					args.viewport = true;
+				}
+				else
+				{
+					std::cerr << "--center requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::ZOOM:
+				if (i + 1 < argc)
+				{
+					args.zoom = std::stod(argv[++i]);
+					if (!(args.zoom > 0.0))
+					{
+						std::cerr << "--zoom must be a positive "
+									 "number."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+					args.viewport = true;
+				}
+				else
+				{
+					std::cerr << "--zoom requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::FRAMES:
+				if (i + 1 < argc)
+				{
+					args.frames = std::stoi(argv[++i]);
+					if (args.frames <= 0)
+					{
+						std::cerr << "--frames must be a positive "
+									 "integer."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--frames requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::ZOOM_FACTOR:
+				if (i + 1 < argc)
+				{
+					args.zoom_factor = std::stod(argv[++i]);
+					if (!(args.zoom_factor > 0.0))
+					{
+						std::cerr
+							<< "--zoom-factor must be a positive "
+							   "number."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--zoom-factor requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::FORMULA:
+				if (i + 1 < argc)
+				{
+					args.formula = argv[++i];
+					if (args.formula != "mandelbrot" &&
+						args.formula != "julia" &&
+						args.formula != "multibrot" &&
+						args.formula != "burning-ship" &&
+						args.formula != "tricorn")
+					{
+						std::cerr
+							<< "--formula must be 'mandelbrot', "
+							   "'julia', 'multibrot', "
+							   "'burning-ship' or 'tricorn'."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--formula requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::JULIA:
+				if (i + 1 < argc)
+				{
+					const std::string value = argv[++i];
+					const size_t comma = value.find(',');
+					if (comma == std::string::npos)
+					{
+						std::cerr << "--julia must be <re>,<im>."
+								  << std::endl;
+						exit(EXIT_FAILURE);
+					}
+					args.julia_re =
+						std::stod(value.substr(0, comma));
+					args.julia_im =
+						std::stod(value.substr(comma + 1));
+				}
+				else
+				{
+					std::cerr << "--julia requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::POWER:
+				if (i + 1 < argc)
+				{
+					args.power = std::stoi(argv[++i]);
+					if (args.power < 2 || args.power > 8)
+					{
+						std::cerr
+							<< "--power must be between 2 and 8."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--power requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::BUDDHABROT:
+				if (i + 1 < argc)
+				{
+					args.buddhabrot_samples = std::stoll(argv[++i]);
+					if (args.buddhabrot_samples <= 0)
+					{
+						std::cerr
+							<< "--buddhabrot must be a positive "
+							   "number of samples."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--buddhabrot requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::IMPORTANCE:
+				args.importance = true;
+				break;
+			case Command::SEED:
+				if (i + 1 < argc)
+				{
+					args.seed = std::stoull(argv[++i]);
+				}
+				else
+				{
+					std::cerr << "--seed requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::DISTANCE_ESTIMATE:
+				args.distance_estimate = true;
+				break;
+			case Command::DISTANCE_MARGIN:
+				if (i + 1 < argc)
+				{
+					args.distance_margin = std::stod(argv[++i]);
+					if (args.distance_margin < 0.0)
+					{
+						std::cerr
+							<< "--distance-margin must not be "
+							   "negative."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr
+						<< "--distance-margin requires a value."
+						<< std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::AA:
+				if (i + 1 < argc)
+				{
+					args.aa_samples = std::stoi(argv[++i]);
+					const int grid = static_cast<int>(
+						std::lround(std::sqrt(args.aa_samples)));
+					if (args.aa_samples < 4 ||
+						args.aa_samples > 64 ||
+						grid * grid != args.aa_samples)
+					{
+						std::cerr
+							<< "--aa must be a square number of "
+							   "samples between 4 and 64."
+							<< std::endl;
+						exit(EXIT_FAILURE);
+					}
+				}
+				else
+				{
+					std::cerr << "--aa requires a value."
+							  << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			case Command::PROGRESSIVE:
+				args.progressive = true;
+				break;
+			case Command::PROGRESSIVE_EXACT:
+				args.progressive = true;
+				args.progressive_exact = true;
+				break;
+			case Command::INVALID:
+				if (args.output_file.empty())
+				{
+					args.output_file = arg;
+				}
+				else
+				{
+					std::cerr
+						<< "Invalid argument or multiple output "
+						   "files specified: "
+						<< arg << std::endl;
+					exit(EXIT_FAILURE);
+				}
+				break;
+			}
+		}
+
+		if (args.output_file.empty())
+		{
+			std::cerr
+				<< "Please specify the output file as a parameter."
+				<< std::endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	catch (const std::exception &e)
+	{
+		std::cerr << "Error parsing arguments: [";
+		for (int i = 0; i < argc; ++i)
+		{
+			std::cerr << argv[i];
+			if (i < argc - 1)
+				std::cerr << ", ";
+		}
+		std::cerr << "] " << e.what() << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	return args;
+}
+
+std::string openmpOnlyOption(const ParsedArgs &args)
+{
+	if (args.viewport)
+		return "--center/--zoom";
+	if (args.frames > 0)
+		return "--frames";
+	if (args.distance_estimate)
+		return "--distance-estimate";
+	if (args.precision != "double")
+		return "--precision";
+	if (args.verify_precision)
+		return "--verify-precision";
+	if (!args.deep_center_re.empty())
+		return "--deep-zoom";
+	if (args.deep_kernel != "auto")
+		return "--deep-kernel";
+	if (args.aa_samples > 0)
+		return "--aa";
+	if (args.progressive)
+		return args.progressive_exact ? "--progressive-exact"
+									  : "--progressive";
+	return "";
+}
+} // namespace cmdParse
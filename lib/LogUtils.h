@@ -1,83 +1,251 @@
-// LogUtils.h
-#pragma once
-#include <string>
-
-namespace logutils
-{
-std::string getCurrentTimestamp();
-/**
- * @brief Creates a log file name based on the output file and
- * an additional name.
- *
- * This function extracts the base filename up to the second
- * underscore, appends the additional name, and sets the file
- * extension to ".log". It also ensures that the necessary
- * directories exist.
- *
- * @param output_file The original output file path.
- * @param additionalName An optional additional name to append
- * to the base filename.
- * @return The generated log file path as a string.
- */
-std::string
-create_log_file_name(const std::string &output_file,
-					 const std::string &additionalName = "");
-
-/**
- * @brief Creates a CSV file name based on the output file and an
- * additional name.
- *
- * This function extracts the base filename up to the second
- * underscore, appends the additional name, and sets the file
- * extension to ".csv". It also ensures that the necessary
- * directories exist.
- *
- * @param output_file The original output file path.
- * @param additionalName An optional additional name to append to
- * the base filename.
- * @return The generated CSV file path as a string.
- */
-std::string
-createCsvFilename(const std::string &output_file,
-				  const std::string &additionalName = "");
-
-/**
- * @brief Checks if a CSV file contains the specified header.
- *
- * This function opens the CSV file, reads the first line, and
- * compares it to the provided header string.
- *
- * @param filePath The path to the CSV file.
- * @param header The expected header string.
- * @return `true` if the header matches; `false` otherwise or if the
- * file cannot be read.
- */
-bool csvFileHasHeader(const std::string &filePath,
-					  const std::string &header);
-} // namespace logutils
-
-namespace cmdParse
-{
-enum class Command
-{
-	HELP,
-	VERSION,
-	ITERATIONS,
-	RESOLUTION,
-	OUTPUT_FILE,
-	THREADS_NUMBER,
-	INVALID
-};
-
-struct ParsedArgs
-{
-	std::string output_file;
-	int iterations = 0;
-	int resolution = 0;
-	int threads_num = 0;
-};
-
-cmdParse::Command get_command(const std::string &arg);
-
-cmdParse::ParsedArgs parse_cmd_arguments(int argc, char *argv[]);
+// LogUtils.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace logutils
+{
+std::string getCurrentTimestamp();
+/**
+ * @brief Creates a log file name based on the output file and
+ * an additional name.
+ *
+ * This function extracts the base filename up to the second
+ * underscore, appends the additional name, and sets the file
+ * extension to ".log". It also ensures that the necessary
+ * directories exist.
+ *
+ * @param output_file The original output file path.
+ * @param additionalName An optional additional name to append
+ * to the base filename.
+ * @return The generated log file path as a string.
+ */
+std::string
+create_log_file_name(const std::string &output_file,
+					 const std::string &additionalName = "");
+
+/**
+ * @brief Creates a CSV file name based on the output file and an
+ * additional name.
+ *
+ * This function extracts the base filename up to the second
+ * underscore, appends the additional name, and sets the file
+ * extension to ".csv". It also ensures that the necessary
+ * directories exist.
+ *
+ * @param output_file The original output file path.
+ * @param additionalName An optional additional name to append to
+ * the base filename.
+ * @return The generated CSV file path as a string.
+ */
+std::string
+createCsvFilename(const std::string &output_file,
+				  const std::string &additionalName = "");
+
+/**
+ * @brief Checks if a CSV file contains the specified header.
+ *
+ * This function opens the CSV file and compares the most recent
+ * header line, the last line starting with the same first column
+ * name, to the provided header string. A file whose schema changed
+ * holds one header line per schema, rows below a header follow it.
+ *
+ * @param filePath The path to the CSV file.
+ * @param header The expected header string.
+ * @return `true` if the header matches; `false` otherwise or if the
+ * file cannot be read.
+ */
+bool csvFileHasHeader(const std::string &filePath,
+					  const std::string &header);
+
+/**
+ * @brief Wall time of the named phases of a run.
+ *
+ * Phases are declared up front so that the CSV columns keep their
+ * order from run to run; a phase that was not declared is appended
+ * on first use and only shows up in the log.
+ */
+class PhaseRegistry
+{
+  public:
+	explicit PhaseRegistry(const std::vector<std::string> &names);
+
+	// Accumulates `seconds` into the phase
+	void add(const std::string &name, double seconds);
+	double seconds(const std::string &name) const;
+	// Sum of all phases
+	double total() const;
+
+	// ",Alloc (s),...,Total (s)" for the declared phases
+	std::string csvHeaderColumns() const;
+	std::string csvColumns() const;
+	// One tab separated line per phase with its share of the total
+	std::string describe() const;
+
+  private:
+	std::vector<std::string> names;
+	std::vector<double> times;
+	size_t declared;
+};
+
+/**
+ * @brief Adds the time between construction and destruction (or
+ * `stop`) to a phase of a registry.
+ */
+class ScopedTimer
+{
+  public:
+	ScopedTimer(PhaseRegistry &registry, std::string name);
+	~ScopedTimer();
+	ScopedTimer(const ScopedTimer &) = delete;
+	ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+	// Records the phase now and returns the elapsed seconds, the
+	// destructor then records nothing
+	double stop();
+
+  private:
+	PhaseRegistry &registry;
+	std::string name;
+	std::chrono::steady_clock::time_point start;
+	bool running = true;
+};
+} // namespace logutils
+
+namespace cmdParse
+{
+enum class Command
+{
+	HELP,
+	VERSION,
+	ITERATIONS,
+	RESOLUTION,
+	OUTPUT_FILE,
+	THREADS_NUMBER,
+	THREADS_PER_RANK,
+	PARTITION,
+	RANK_TIMINGS,
+	CHECKPOINT_INTERVAL,
+	SHARDED_OUTPUT,
+	PERF_COUNTERS,
+	THREAD_STATS,
+	TRACE,
+	ENERGY,
+	PROGRESS,
+	DEEP_ZOOM,
+	DEEP_KERNEL,
+	PRECISION,
+	VERIFY_PRECISION,
+	CENTER,
+	ZOOM,
+	FRAMES,
+	ZOOM_FACTOR,
+	FORMULA,
+	JULIA,
+	POWER,
+	BUDDHABROT,
+	IMPORTANCE,
+	SEED,
+	DISTANCE_ESTIMATE,
+	DISTANCE_MARGIN,
+	AA,
+	PROGRESSIVE,
+	PROGRESSIVE_EXACT,
+	INVALID
+};
+
+struct ParsedArgs
+{
+	std::string output_file;
+	int iterations = 0;
+	int resolution = 0;
+	int threads_num = 0;
+	// OpenMP threads per MPI rank, 0 derives it from the topology
+	int threads_per_rank = 0;
+	// MPI row partitioning: "equal" rows or probe-based "cost"
+	std::string partition = "equal";
+	// Write the per-rank MPI phase times to a detail file
+	bool rank_timings = false;
+	// Seconds between MPI tile checkpoints, 0 disables them
+	int checkpoint_interval = 0;
+	// Every MPI rank writes its own binary shard plus a manifest
+	bool sharded_output = false;
+	// Collect hardware counters around the compute and write phases
+	bool perf_counters = false;
+	// Per-thread chunk, iteration and busy/idle accounting
+	bool thread_stats = false;
+	// Chrome trace-event JSON of the thread timeline, implies
+	// thread_stats
+	std::string trace_file;
+	// RAPL package and core energy around the compute and write
+	// phases
+	bool energy = false;
+	// Seconds between two progress reports, 0 disables them
+	double progress_interval = 0.0;
+	// Deep-zoom viewport: centre as decimal strings, kept at full
+	// precision, and the pixel spacing; an empty centre disables it
+	std::string deep_center_re;
+	std::string deep_center_im;
+	double deep_spacing = 0.0;
+	// Deep-zoom kernel: "auto" picks the fastest one that resolves
+	// the spacing
+	std::string deep_kernel = "auto";
+	// OpenMP precision: "double" everywhere, or "auto" float tiles
+	// promoted to double where needed, which may differ from the
+	// double image
+	std::string precision = "double";
+	// Compare the image against a double render and report the
+	// differences
+	bool verify_precision = false;
+	// Runtime viewport, set by --center or --zoom; the defaults are
+	// the fixed viewport of the engines
+	bool viewport = false;
+	double center_x = -0.5;
+	double center_y = 0.0;
+	double zoom = 1.0;
+	// Zoom animation: frames rendered, each zoomed in by
+	// zoom_factor
+	int frames = 0;
+	double zoom_factor = 2.0;
+	// Escape-time formula of the CPU engines and its constants, see
+	// FormulaEngine.h
+	std::string formula = "mandelbrot";
+	double julia_re = -0.8;
+	double julia_im = 0.156;
+	int power = 3;
+	// Orbit-density mode: random c values sampled, 0 renders the
+	// set
+	int64_t buddhabrot_samples = 0;
+	// Sample the boundary more often, see Buddhabrot.h
+	bool importance = false;
+	uint64_t seed = 1;
+	// OpenMP distance-estimator mode, benchmarked against a
+	// brute-force render; the margin is in block diagonals, see
+	// DistanceEstimator.h
+	bool distance_estimate = false;
+	double distance_margin = 1.0;
+	// Adaptive supersampling: subsamples of a refined pixel, 0
+	// disables it; see Supersample.h
+	int aa_samples = 0;
+	// Coarse-to-fine rendering with solid guessing, every level
+	// written to a file; the exact pass recomputes the guessed
+	// pixels
+	bool progressive = false;
+	bool progressive_exact = false;
+};
+
+cmdParse::Command get_command(const std::string &arg);
+
+cmdParse::ParsedArgs parse_cmd_arguments(int argc, char *argv[]);
+
+/**
+ * @brief The first option of `args` that only the OpenMP engine
+ * implements, so that the other engines refuse it rather than
+ * silently render the plain image.
+ *
+ * @return The option as written on the command line, empty if none.
+ */
+std::string openmpOnlyOption(const ParsedArgs &args);
 } // namespace cmdParse
\ No newline at end of file
@@ -0,0 +1,282 @@
+#include <MPICheckpoint.hpp>
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace checkpoint
+{
+
+std::string checkpointDir(const std::string &output_file)
+{
+	return output_file + ".checkpoint";
+}
+
+std::string paramsLine(const Params &params)
+{
+	std::ostringstream line;
+	line.precision(17);
+	line << params.width << " " << params.height << " "
+		 << params.iterations << " " << params.step << " "
+		 << params.formula << " " << params.julia_re << " "
+		 << params.julia_im << " " << params.power;
+	return line.str();
+}
+
+// FNV-1a over the bytes of `count` values
+unsigned long long checksum(const int *values, size_t count)
+{
+	const unsigned char *bytes =
+		reinterpret_cast<const unsigned char *>(values);
+	unsigned long long hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < count * sizeof(int); i++)
+		hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+	return hash;
+}
+
+std::string dataFile(const std::string &dir, long long rank)
+{
+	return dir + "/rank_" + std::to_string(rank) + ".dat";
+}
+
+std::string manifestFile(const std::string &dir, long long rank)
+{
+	return dir + "/rank_" + std::to_string(rank) + ".manifest";
+}
+
+/**
+ * @brief Reads all rank manifests of a checkpoint directory.
+ *
+ * @param dir The checkpoint directory.
+ * @return The completed chunks of every rank.
+ */
+std::vector<Chunk> readManifests(const std::string &dir)
+{
+	std::vector<Chunk> chunks;
+	for (const auto &entry : fs::directory_iterator(dir))
+	{
+		const std::string name = entry.path().filename().string();
+		if (name.rfind("rank_", 0) != 0 ||
+			entry.path().extension() != ".manifest")
+			continue;
+		long long file_rank = 0;
+		try
+		{
+			file_rank = std::stoll(name.substr(5));
+		}
+		catch (const std::exception &)
+		{
+			continue;
+		}
+		std::ifstream manifest(entry.path());
+		std::string line;
+		// A line without its newline was torn by a crash, so was
+		// any line with missing or extra fields
+		while (std::getline(manifest, line) && !manifest.eof())
+		{
+			std::istringstream fields(line);
+			Chunk chunk;
+			std::string extra;
+			if (!(fields >> chunk.first_row >> chunk.row_count >>
+				  chunk.offset >> chunk.checksum) ||
+				fields >> extra || chunk.row_count <= 0 ||
+				chunk.offset < 0)
+				continue;
+			chunk.file_rank = file_rank;
+			chunks.push_back(chunk);
+		}
+	}
+	return chunks;
+}
+
+std::vector<Chunk> prepare(const std::string &dir,
+						   const Params &params, MPI_Comm comm)
+{
+	int rank = 0;
+	MPI_Comm_rank(comm, &rank);
+
+	std::vector<long long> flat;
+	if (rank == 0)
+	{
+		std::error_code error;
+		const std::string params_path = dir + "/params.txt";
+		std::string stored;
+		{
+			std::ifstream stored_params(params_path);
+			std::getline(stored_params, stored);
+		}
+		if (stored != paramsLine(params))
+		{
+			if (!stored.empty())
+			{
+				std::cout << "Checkpoint parameters differ, "
+							 "discarding "
+						  << dir << std::endl;
+			}
+			fs::remove_all(dir, error);
+			fs::create_directories(dir, error);
+			std::ofstream params_out(params_path, std::ios::trunc);
+			params_out << paramsLine(params) << std::endl;
+		}
+		else
+		{
+			for (const Chunk &chunk : readManifests(dir))
+			{
+				flat.insert(
+					flat.end(),
+					{chunk.first_row, chunk.row_count,
+					 chunk.file_rank, chunk.offset,
+					 static_cast<long long>(chunk.checksum)});
+			}
+		}
+	}
+
+	long long count = static_cast<long long>(flat.size());
+	MPI_Bcast(&count, 1, MPI_LONG_LONG, 0, comm);
+	flat.resize(count);
+	MPI_Bcast(flat.data(), static_cast<int>(count), MPI_LONG_LONG,
+			  0, comm);
+
+	std::vector<Chunk> chunks;
+	for (size_t i = 0; i + 4 < flat.size(); i += 5)
+	{
+		Chunk chunk;
+		chunk.first_row = static_cast<int>(flat[i]);
+		chunk.row_count = static_cast<int>(flat[i + 1]);
+		chunk.file_rank = flat[i + 2];
+		chunk.offset = flat[i + 3];
+		chunk.checksum =
+			static_cast<unsigned long long>(flat[i + 4]);
+		chunks.push_back(chunk);
+	}
+	return chunks;
+}
+
+bool readChunk(const std::string &dir, const Chunk &chunk,
+			   int width, int *dest)
+{
+	std::ifstream data(dataFile(dir, chunk.file_rank),
+					   std::ios::binary);
+	if (!data.is_open())
+		return false;
+	data.seekg(chunk.offset);
+	const std::streamsize bytes = static_cast<std::streamsize>(
+		sizeof(int) * static_cast<size_t>(chunk.row_count) * width);
+	data.read(reinterpret_cast<char *>(dest), bytes);
+	return data.gcount() == bytes &&
+		   checksum(dest, static_cast<size_t>(chunk.row_count) *
+							  width) == chunk.checksum;
+}
+
+void clear(const std::string &dir, MPI_Comm comm)
+{
+	int rank = 0;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Barrier(comm);
+	if (rank == 0)
+	{
+		std::error_code error;
+		fs::remove_all(dir, error);
+	}
+}
+
+Writer::Writer(const std::string &dir, int rank, int width,
+			   int interval_seconds)
+	: dir(dir), rank(rank), width(width),
+	  interval_seconds(interval_seconds),
+	  last_flush(std::chrono::steady_clock::now())
+{
+}
+
+void Writer::add(int first_row, int row_count, const int *rows)
+{
+	if (!enabled())
+		return;
+	pending.push_back({first_row, row_count, rows});
+}
+
+void Writer::maybeFlush()
+{
+	if (!enabled() || pending.empty())
+		return;
+	const double since_last =
+		std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - last_flush)
+			.count();
+	if (since_last >= interval_seconds)
+		flush();
+}
+
+void Writer::flush()
+{
+	if (!enabled() || pending.empty())
+		return;
+	const auto start = std::chrono::steady_clock::now();
+	last_flush = start;
+
+	FILE *data = std::fopen(dataFile(dir, rank).c_str(), "ab");
+	if (data == nullptr)
+	{
+		std::cerr << "Rank " << rank
+				  << ": unable to open checkpoint data file."
+				  << std::endl;
+		return;
+	}
+	std::fseek(data, 0, SEEK_END);
+	long long offset = std::ftell(data);
+	std::ostringstream entries;
+	size_t written = 0;
+	for (const Pending &chunk : pending)
+	{
+		const size_t values =
+			static_cast<size_t>(chunk.row_count) * width;
+		if (std::fwrite(chunk.rows, sizeof(int), values, data) !=
+			values)
+			break;
+		entries << chunk.first_row << " " << chunk.row_count << " "
+				<< offset << " " << checksum(chunk.rows, values)
+				<< "\n";
+		offset += static_cast<long long>(values * sizeof(int));
+		written++;
+	}
+	bool ok = std::fflush(data) == 0 && fsync(fileno(data)) == 0;
+	ok = std::fclose(data) == 0 && ok;
+
+	// The manifest only references rows that are already on disk
+	if (ok && written > 0)
+	{
+		FILE *manifest =
+			std::fopen(manifestFile(dir, rank).c_str(), "ab");
+		const std::string text = entries.str();
+		ok = manifest != nullptr &&
+			 std::fwrite(text.data(), 1, text.size(), manifest) ==
+				 text.size() &&
+			 std::fflush(manifest) == 0 &&
+			 fsync(fileno(manifest)) == 0;
+		if (manifest != nullptr)
+			ok = std::fclose(manifest) == 0 && ok;
+	}
+
+	if (ok)
+		pending.erase(pending.begin(), pending.begin() + written);
+	if (!ok || !pending.empty())
+		std::cerr
+			<< "Rank " << rank
+			<< ": checkpoint incomplete, retrying at the next "
+			   "flush."
+			<< std::endl;
+	else
+		checkpoint_count++;
+	overhead_seconds +=
+		std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start)
+			.count();
+}
+
+} // namespace checkpoint
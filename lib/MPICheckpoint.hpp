@@ -0,0 +1,156 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace checkpoint
+{
+
+/**
+ * @brief Parameters a checkpoint is only valid for.
+ */
+struct Params
+{
+	int width = 0;
+	int height = 0;
+	int iterations = 0;
+	double step = 0.0;
+	// `formula::kindName` of the iterated formula
+	std::string formula = "mandelbrot";
+	// Julia constant and power, written at full precision
+	double julia_re = 0.0;
+	double julia_im = 0.0;
+	int power = 0;
+};
+
+/**
+ * @brief A completed block of rows stored in a rank data file.
+ */
+struct Chunk
+{
+	int first_row = 0;
+	int row_count = 0;
+	// Rank whose data file holds the rows
+	long long file_rank = 0;
+	// Byte offset of the rows inside that file
+	long long offset = 0;
+	// FNV-1a hash of the rows, checked when they are restored
+	unsigned long long checksum = 0;
+};
+
+/**
+ * @brief Returns the checkpoint directory used for an output file.
+ *
+ * @param output_file The output file of the render.
+ * @return The directory next to the output file.
+ */
+std::string checkpointDir(const std::string &output_file);
+
+/**
+ * @brief Prepares the checkpoint directory on all ranks.
+ *
+ * The root creates the directory and compares the stored
+ * parameters with the current ones. A checkpoint written for other
+ * parameters is discarded so that it can never be mixed into the
+ * new image.
+ *
+ * @param dir The checkpoint directory.
+ * @param params The parameters of the current render.
+ * @param comm The communicator of the job.
+ * @return The completed chunks found on disk, identical on every
+ * rank.
+ */
+std::vector<Chunk> prepare(const std::string &dir,
+						   const Params &params, MPI_Comm comm);
+
+/**
+ * @brief Reads the rows of a completed chunk.
+ *
+ * @param dir The checkpoint directory.
+ * @param chunk The chunk to read.
+ * @param width The image width.
+ * @param dest Destination for `chunk.row_count * width` values.
+ * @return `true` if the chunk was read completely and matches its
+ * checksum.
+ */
+bool readChunk(const std::string &dir, const Chunk &chunk,
+			   int width, int *dest);
+
+/**
+ * @brief Removes the checkpoint once the render finished.
+ *
+ * @param dir The checkpoint directory.
+ * @param comm The communicator of the job.
+ */
+void clear(const std::string &dir, MPI_Comm comm);
+
+/**
+ * @brief Persists the completed rows of one rank.
+ *
+ * Rows are appended to `rank_<r>.dat` and recorded in
+ * `rank_<r>.manifest` only after the data is synced, so a crash
+ * never leaves a manifest entry without its rows. Every entry is a
+ * newline-terminated line carrying the checksum of its rows, and
+ * the manifest is synced too; a line torn by a crash does not parse
+ * and is dropped on restart. Writes only happen when the checkpoint
+ * interval elapsed, which bounds the overhead.
+ */
+class Writer
+{
+  public:
+	/**
+	 * @param dir The checkpoint directory.
+	 * @param rank The rank owning the files.
+	 * @param width The image width.
+	 * @param interval_seconds Minimal time between two
+	 * checkpoints, 0 disables checkpointing.
+	 */
+	Writer(const std::string &dir, int rank, int width,
+		   int interval_seconds);
+
+	Writer(const Writer &) = delete;
+	Writer &operator=(const Writer &) = delete;
+
+	/**
+	 * @brief Records completed rows, they must stay valid until the
+	 * next `flush`.
+	 */
+	void add(int first_row, int row_count, const int *rows);
+
+	/**
+	 * @brief Writes the pending rows if the interval elapsed.
+	 */
+	void maybeFlush();
+
+	/**
+	 * @brief Writes the pending rows unconditionally. Rows that
+	 * could not be written stay pending for the next flush.
+	 */
+	void flush();
+
+	bool enabled() const { return interval_seconds > 0; }
+	double overheadSeconds() const { return overhead_seconds; }
+	int checkpoints() const { return checkpoint_count; }
+
+  private:
+	struct Pending
+	{
+		int first_row;
+		int row_count;
+		const int *rows;
+	};
+
+	std::string dir;
+	int rank = 0;
+	int width = 0;
+	int interval_seconds = 0;
+	std::vector<Pending> pending;
+	std::chrono::steady_clock::time_point last_flush;
+	double overhead_seconds = 0.0;
+	int checkpoint_count = 0;
+};
+
+} // namespace checkpoint
@@ -0,0 +1,36 @@
+#include <MPIGather.hpp>
+
+namespace gather
+{
+
+std::vector<std::string> gatherStrings(const std::string &text,
+									   MPI_Comm comm, int root)
+{
+	int length = static_cast<int>(text.size());
+	int rank = 0, size = 1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+
+	std::vector<int> lengths(rank == root ? size : 0);
+	MPI_Gather(&length, 1, MPI_INT, lengths.data(), 1, MPI_INT,
+			   root, comm);
+
+	std::vector<int> offsets(lengths.size(), 0);
+	int total = 0;
+	for (size_t i = 0; i < lengths.size(); i++)
+	{
+		offsets[i] = total;
+		total += lengths[i];
+	}
+	std::vector<char> buffer(rank == root ? total : 0);
+	MPI_Gatherv(text.data(), length, MPI_CHAR, buffer.data(),
+				lengths.data(), offsets.data(), MPI_CHAR, root,
+				comm);
+
+	std::vector<std::string> texts;
+	for (size_t i = 0; i < lengths.size(); i++)
+		texts.emplace_back(buffer.data() + offsets[i], lengths[i]);
+	return texts;
+}
+
+} // namespace gather
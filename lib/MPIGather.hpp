@@ -0,0 +1,25 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+
+namespace gather
+{
+
+/**
+ * @brief Collects a string of every rank on the root.
+ *
+ * The lengths are gathered first, then the characters with a single
+ * `MPI_Gatherv` into one buffer that is split again on the root.
+ *
+ * @param text The string of the calling rank.
+ * @param comm The communicator of the job.
+ * @param root The rank receiving the strings.
+ * @return One string per rank on `root`, empty elsewhere.
+ */
+std::vector<std::string> gatherStrings(const std::string &text,
+									   MPI_Comm comm, int root = 0);
+
+} // namespace gather
@@ -0,0 +1,160 @@
+#include <MPIPartition.hpp>
+
+#include <algorithm>
+#include <numeric>
+
+namespace partition
+{
+
+namespace
+{
+// Iteration counts of the probe rows of this rank, compiled once
+// per formula
+template <typename Formula>
+void probeRows(const Formula &policy, const Viewport &view,
+			   int factor, int probe_width, int probe_height,
+			   int rank, int size, std::vector<double> &probe_cost)
+{
+	// Interleaved probe rows spread the expensive centre of the set
+	// over all ranks
+#pragma omp parallel for schedule(dynamic) default(none)           \
+	shared(policy, view, factor, probe_width, probe_height,        \
+		   probe_cost, rank, size)
+	for (int probe_row = rank; probe_row < probe_height;
+		 probe_row += size)
+	{
+		const double y =
+			probe_row * factor * view.step + view.min_y;
+		double row_cost = 0.0;
+		for (int probe_col = 0; probe_col < probe_width;
+			 probe_col++)
+		{
+			const double x =
+				probe_col * factor * view.step + view.min_x;
+			const int escape =
+				formula::escapeTime<Formula,
+									formula::Bailout::NORM>(
+					policy, std::complex<double>(x, y),
+					view.iterations);
+			row_cost +=
+				(escape == 0 ? view.iterations : escape) + 1;
+		}
+		probe_cost[probe_row] = row_cost;
+	}
+}
+} // namespace
+
+std::vector<RowRange> equalRows(int height, int nparts)
+{
+	std::vector<RowRange> ranges(nparts);
+	const int base = height / nparts;
+	const int remainder = height % nparts;
+	int row = 0;
+	for (int part = 0; part < nparts; part++)
+	{
+		ranges[part].first_row = row;
+		ranges[part].row_count = base + (part < remainder ? 1 : 0);
+		row += ranges[part].row_count;
+	}
+	return ranges;
+}
+
+std::vector<double> probeRowCost(const Viewport &view, int factor,
+								 MPI_Comm comm,
+								 const formula::Params &params)
+{
+	int rank = 0, size = 1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+
+	factor = std::max(1, factor);
+	const int probe_width = (view.width + factor - 1) / factor;
+	const int probe_height = (view.height + factor - 1) / factor;
+	std::vector<double> probe_cost(probe_height, 0.0);
+
+	formula::dispatch(params,
+					  [&](const auto &policy)
+					  {
+						  probeRows(policy, view, factor,
+									probe_width, probe_height, rank,
+									size, probe_cost);
+					  });
+	MPI_Allreduce(MPI_IN_PLACE, probe_cost.data(), probe_height,
+				  MPI_DOUBLE, MPI_SUM, comm);
+
+	// Every full-resolution row inherits the cost of its probe row,
+	// scaled from the probe width to the full width
+	std::vector<double> row_cost(view.height, 0.0);
+	const double scale =
+		static_cast<double>(view.width) / probe_width;
+	for (int row = 0; row < view.height; row++)
+		row_cost[row] = probe_cost[row / factor] * scale;
+	return row_cost;
+}
+
+std::vector<RowRange>
+balanceRows(const std::vector<double> &row_cost, int nparts)
+{
+	const int height = static_cast<int>(row_cost.size());
+	std::vector<double> prefix(height + 1, 0.0);
+	std::partial_sum(row_cost.begin(), row_cost.end(),
+					 prefix.begin() + 1);
+	const double total = prefix[height];
+
+	std::vector<RowRange> ranges(nparts);
+	int first_row = 0;
+	for (int part = 0; part < nparts; part++)
+	{
+		int end_row = height;
+		if (part < nparts - 1)
+		{
+			// First row boundary reaching this part's share of the
+			// total predicted cost
+			const double target = total * (part + 1) / nparts;
+			end_row = static_cast<int>(
+				std::lower_bound(prefix.begin(), prefix.end(),
+								 target) -
+				prefix.begin());
+			// Leave at least one row for every remaining part
+			const int remaining = nparts - part - 1;
+			end_row = std::max(end_row, first_row + 1);
+			end_row = std::min(end_row, height - remaining);
+			end_row = std::max(end_row, first_row);
+		}
+		ranges[part].first_row = first_row;
+		ranges[part].row_count = end_row - first_row;
+		first_row = end_row;
+	}
+	return ranges;
+}
+
+double imbalancePercent(const std::vector<double> &costs)
+{
+	if (costs.empty())
+		return 0.0;
+	const double max_cost =
+		*std::max_element(costs.begin(), costs.end());
+	const double mean_cost =
+		std::accumulate(costs.begin(), costs.end(), 0.0) /
+		costs.size();
+	if (mean_cost <= 0.0)
+		return 0.0;
+	return (max_cost / mean_cost - 1.0) * 100.0;
+}
+
+std::vector<double> rangeCosts(const std::vector<double> &row_cost,
+							   const std::vector<RowRange> &ranges)
+{
+	std::vector<double> costs;
+	costs.reserve(ranges.size());
+	for (const RowRange &range : ranges)
+	{
+		costs.push_back(std::accumulate(
+			row_cost.begin() + range.first_row,
+			row_cost.begin() + range.first_row + range.row_count,
+			0.0));
+	}
+	return costs;
+}
+
+} // namespace partition
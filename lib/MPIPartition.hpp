@@ -0,0 +1,95 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <FormulaEngine.h>
+#include <string>
+#include <vector>
+
+namespace partition
+{
+
+/**
+ * @brief A contiguous range of image rows owned by one rank.
+ */
+struct RowRange
+{
+	int first_row = 0;
+	int row_count = 0;
+};
+
+/**
+ * @brief Geometry of the rendered image, shared by all ranks.
+ */
+struct Viewport
+{
+	int width = 0;
+	int height = 0;
+	double min_x = 0.0;
+	double min_y = 0.0;
+	double step = 0.0;
+	int iterations = 0;
+};
+
+/**
+ * @brief Splits the rows into ranges of (almost) equal row counts.
+ *
+ * @param height The number of image rows.
+ * @param nparts The number of ranges to create.
+ * @return One range per part, the remainder rows go to the first
+ * parts.
+ */
+std::vector<RowRange> equalRows(int height, int nparts);
+
+/**
+ * @brief Estimates the cost of every image row from a coarse probe.
+ *
+ * All ranks cooperatively render a probe image at `1/factor` of the
+ * resolution, every rank computing an interleaved subset of the
+ * probe rows with the formula of the render. The per-row iteration
+ * counts are combined with `MPI_Allreduce` and expanded back to
+ * full resolution. Each pixel also carries a constant cost of one
+ * iteration to account for the work that does not depend on the
+ * escape time.
+ *
+ * @param view The geometry of the full image.
+ * @param factor The probe subsampling factor (e.g. 16).
+ * @param comm The communicator of the job.
+ * @param params The formula the image is rendered with.
+ * @return The predicted cost of every full-resolution row.
+ */
+std::vector<double>
+probeRowCost(const Viewport &view, int factor, MPI_Comm comm,
+			 const formula::Params &params = formula::Params());
+
+/**
+ * @brief Splits the rows into contiguous ranges of roughly equal
+ * predicted cost using a prefix sum of the row costs.
+ *
+ * @param row_cost The predicted cost of every row.
+ * @param nparts The number of ranges to create.
+ * @return One range per part, every part receives at least one row
+ * when there are enough rows.
+ */
+std::vector<RowRange>
+balanceRows(const std::vector<double> &row_cost, int nparts);
+
+/**
+ * @brief Computes the load imbalance of a set of per-part costs.
+ *
+ * @param costs The cost (predicted or measured) of every part.
+ * @return The imbalance in percent, `(max / mean - 1) * 100`.
+ */
+double imbalancePercent(const std::vector<double> &costs);
+
+/**
+ * @brief Sums the predicted cost of every range.
+ *
+ * @param row_cost The predicted cost of every row.
+ * @param ranges The ranges to evaluate.
+ * @return The predicted cost of every range.
+ */
+std::vector<double> rangeCosts(const std::vector<double> &row_cost,
+							   const std::vector<RowRange> &ranges);
+
+} // namespace partition
@@ -0,0 +1,137 @@
+#include <MPIPhaseTimes.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace phases
+{
+
+const char *phaseName(int phase)
+{
+	switch (phase)
+	{
+	case INIT:
+		return "Init";
+	case COMPUTE:
+		return "Compute";
+	case WAIT:
+		return "Wait";
+	case COMMUNICATION:
+		return "Communication";
+	case WRITE:
+		return "Write";
+	default:
+		return "Unknown";
+	}
+}
+
+std::vector<PhaseSummary> reducePhases(const PhaseTimes &times,
+									   MPI_Comm comm, int root)
+{
+	int rank = 0, size = 1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+
+	struct ValueRank
+	{
+		double value;
+		int rank;
+	};
+	ValueRank local_max[PHASE_COUNT], global_max[PHASE_COUNT];
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+		local_max[phase] = {times.seconds[phase], rank};
+
+	double global_min[PHASE_COUNT], global_sum[PHASE_COUNT];
+	MPI_Reduce(times.seconds, global_min, PHASE_COUNT, MPI_DOUBLE,
+			   MPI_MIN, root, comm);
+	MPI_Reduce(times.seconds, global_sum, PHASE_COUNT, MPI_DOUBLE,
+			   MPI_SUM, root, comm);
+	MPI_Reduce(local_max, global_max, PHASE_COUNT, MPI_DOUBLE_INT,
+			   MPI_MAXLOC, root, comm);
+
+	std::vector<PhaseSummary> summaries;
+	if (rank != root)
+		return summaries;
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		PhaseSummary summary;
+		summary.min = global_min[phase];
+		summary.mean = global_sum[phase] / size;
+		summary.max = global_max[phase].value;
+		summary.max_rank = global_max[phase].rank;
+		summary.imbalance_percent =
+			summary.mean > 0.0
+				? (summary.max / summary.mean - 1.0) * 100.0
+				: 0.0;
+		summaries.push_back(summary);
+	}
+	return summaries;
+}
+
+std::vector<PhaseTimes> gatherPhases(const PhaseTimes &times,
+									 MPI_Comm comm, int root)
+{
+	int rank = 0, size = 1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	std::vector<PhaseTimes> rank_times(rank == root ? size : 0);
+	MPI_Gather(times.seconds, PHASE_COUNT, MPI_DOUBLE,
+			   rank_times.data(), PHASE_COUNT, MPI_DOUBLE, root,
+			   comm);
+	return rank_times;
+}
+
+std::string csvHeaderColumns()
+{
+	std::ostringstream header;
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+	{
+		const std::string name = phaseName(phase);
+		header << "," << name << " min (s)," << name << " mean (s),"
+			   << name << " max (s)," << name << " imbalance (%)";
+	}
+	header << ",Straggler rank";
+	return header.str();
+}
+
+std::string csvColumns(const std::vector<PhaseSummary> &summaries)
+{
+	std::ostringstream columns;
+	for (const PhaseSummary &summary : summaries)
+	{
+		columns << "," << summary.min << "," << summary.mean << ","
+				<< summary.max << "," << summary.imbalance_percent;
+	}
+	columns << ","
+			<< (summaries.size() > COMPUTE
+					? summaries[COMPUTE].max_rank
+					: 0);
+	return columns.str();
+}
+
+bool writeRankDetail(const std::string &path,
+					 const std::vector<PhaseTimes> &rank_times)
+{
+	std::ofstream detail(path, std::ios::trunc);
+	if (!detail.is_open())
+	{
+		std::cerr << "Unable to open rank detail file: " << path
+				  << std::endl;
+		return false;
+	}
+	detail << "Rank";
+	for (int phase = 0; phase < PHASE_COUNT; phase++)
+		detail << "," << phaseName(phase) << " (s)";
+	detail << std::endl;
+	for (size_t rank = 0; rank < rank_times.size(); rank++)
+	{
+		detail << rank;
+		for (int phase = 0; phase < PHASE_COUNT; phase++)
+			detail << "," << rank_times[rank].seconds[phase];
+		detail << std::endl;
+	}
+	return true;
+}
+
+} // namespace phases
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+
+namespace phases
+{
+
+/**
+ * @brief Phases of an MPI render timed on every rank.
+ */
+enum Phase
+{
+	INIT = 0,
+	COMPUTE,
+	WAIT,
+	COMMUNICATION,
+	WRITE,
+	PHASE_COUNT
+};
+
+/**
+ * @brief Returns the human readable name of a phase.
+ *
+ * @param phase The phase index.
+ * @return The name used in logs and CSV headers.
+ */
+const char *phaseName(int phase);
+
+/**
+ * @brief Wall time spent by one rank in every phase.
+ */
+struct PhaseTimes
+{
+	double seconds[PHASE_COUNT] = {};
+};
+
+/**
+ * @brief Statistics of one phase across all ranks.
+ */
+struct PhaseSummary
+{
+	double min = 0.0;
+	double mean = 0.0;
+	double max = 0.0;
+	// (max / mean - 1) * 100
+	double imbalance_percent = 0.0;
+	// Rank holding the maximum, i.e. the straggler of this phase
+	int max_rank = 0;
+};
+
+/**
+ * @brief Reduces the phase times of all ranks to min/mean/max.
+ *
+ * Uses `MPI_Reduce` with `MPI_MIN`, `MPI_SUM` and `MPI_MAXLOC`, so
+ * only `PHASE_COUNT` values per rank travel to the root.
+ *
+ * @param times The phase times of the calling rank.
+ * @param comm The communicator of the job.
+ * @param root The rank receiving the summary.
+ * @return One summary per phase on `root`, empty elsewhere.
+ */
+std::vector<PhaseSummary> reducePhases(const PhaseTimes &times,
+									   MPI_Comm comm, int root = 0);
+
+/**
+ * @brief Collects the raw phase times of every rank on the root.
+ *
+ * @param times The phase times of the calling rank.
+ * @param comm The communicator of the job.
+ * @param root The rank receiving the times.
+ * @return The phase times of every rank on `root`, empty elsewhere.
+ */
+std::vector<PhaseTimes> gatherPhases(const PhaseTimes &times,
+									 MPI_Comm comm, int root = 0);
+
+/**
+ * @brief CSV header columns of the phase summary, each prefixed
+ * with a comma so they can be appended to an existing header.
+ */
+std::string csvHeaderColumns();
+
+/**
+ * @brief CSV values matching `csvHeaderColumns`, each prefixed with
+ * a comma.
+ *
+ * @param summaries The summaries returned by `reducePhases`.
+ */
+std::string csvColumns(const std::vector<PhaseSummary> &summaries);
+
+/**
+ * @brief Writes the phase times of every rank to a CSV file.
+ *
+ * @param path The detail file path, truncated if it exists.
+ * @param rank_times The times returned by `gatherPhases`.
+ * @return `true` if the file was written; `false` otherwise.
+ */
+bool writeRankDetail(const std::string &path,
+					 const std::vector<PhaseTimes> &rank_times);
+
+} // namespace phases
@@ -0,0 +1,87 @@
+#include <MPIProgress.hpp>
+
+#include <chrono>
+#include <thread>
+
+namespace progress
+{
+
+Aggregator::Aggregator(Reporter *reporter, MPI_Comm comm, int root,
+					   double interval_seconds)
+	: reporter(reporter), world(comm), root(root),
+	  interval(interval_seconds)
+{
+	MPI_Comm_dup(world, &this->comm);
+	MPI_Comm_rank(world, &rank);
+	last_post = MPI_Wtime();
+}
+
+Aggregator::~Aggregator()
+{
+	if (comm != MPI_COMM_NULL)
+		MPI_Comm_free(&comm);
+}
+
+void Aggregator::post(int64_t local_done)
+{
+	send = local_done;
+	MPI_Ireduce(&send, &receive, 1, MPI_LONG_LONG, MPI_SUM, root,
+				comm, &request);
+	posted++;
+	last_post = MPI_Wtime();
+}
+
+void Aggregator::complete()
+{
+	if (rank == root && reporter)
+		reporter->set(receive);
+}
+
+void Aggregator::poll(int64_t local_done)
+{
+	if (request != MPI_REQUEST_NULL)
+	{
+		int done = 0;
+		MPI_Test(&request, &done, MPI_STATUS_IGNORE);
+		if (!done)
+			return;
+		complete();
+	}
+	if (MPI_Wtime() - last_post >= interval)
+		post(local_done);
+}
+
+void Aggregator::finish(int64_t local_done)
+{
+	// A rank that is done keeps taking part in the reductions until
+	// every rank is, otherwise the root would stop seeing progress
+	MPI_Request barrier;
+	MPI_Ibarrier(world, &barrier);
+	int arrived = 0;
+	while (true)
+	{
+		poll(local_done);
+		MPI_Test(&barrier, &arrived, MPI_STATUS_IGNORE);
+		if (arrived)
+			break;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	// Ranks may have posted a different number of reductions, the
+	// pending one included. Everyone catches up with the busiest
+	// rank, then one more reduction carries the final counts
+	int most = 0;
+	MPI_Allreduce(&posted, &most, 1, MPI_INT, MPI_MAX, world);
+	while (true)
+	{
+		if (request != MPI_REQUEST_NULL)
+		{
+			MPI_Wait(&request, MPI_STATUS_IGNORE);
+			complete();
+		}
+		if (posted > most)
+			break;
+		post(local_done);
+	}
+	MPI_Comm_free(&comm);
+}
+} // namespace progress
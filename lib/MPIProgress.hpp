@@ -0,0 +1,62 @@
+#pragma once
+
+#include <mpi.h>
+
+#include <ProgressReporter.h>
+
+#include <cstdint>
+
+namespace progress
+{
+
+/**
+ * @brief Sums the per-rank progress on the root without stopping
+ * the compute.
+ *
+ * Every rank calls `poll` between its tiles. When the previous
+ * MPI_Ireduce completed and the interval passed, a new one is
+ * posted with the local count, so at most one reduction per rank is
+ * in flight and the tile loop never waits for it. On the root a
+ * completed reduction overwrites the count of the reporter.
+ *
+ * The reductions run on a duplicate of the communicator. `finish`
+ * keeps polling until every rank arrived (a non-blocking barrier on
+ * the original communicator, so it also waits for the slowest
+ * rank), then agrees on the number of posted reductions and posts
+ * the missing ones. It has to be called by every rank at the same
+ * point.
+ */
+class Aggregator
+{
+  public:
+	/**
+	 * @param reporter Receives the global count; only read on the
+	 * root, may be null elsewhere.
+	 */
+	Aggregator(Reporter *reporter, MPI_Comm comm, int root,
+			   double interval_seconds);
+	~Aggregator();
+
+	Aggregator(const Aggregator &) = delete;
+	Aggregator &operator=(const Aggregator &) = delete;
+
+	void poll(int64_t local_done);
+	void finish(int64_t local_done);
+
+  private:
+	void post(int64_t local_done);
+	void complete();
+
+	Reporter *reporter;
+	MPI_Comm world;
+	MPI_Comm comm = MPI_COMM_NULL;
+	int root;
+	int rank = 0;
+	double interval;
+	double last_post = 0.0;
+	MPI_Request request = MPI_REQUEST_NULL;
+	long long send = 0;
+	long long receive = 0;
+	int posted = 0;
+};
+} // namespace progress
@@ -0,0 +1,379 @@
+#include "MandelbrotKernels.h"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace kernels
+{
+bool parseSchedule(const std::string &name, Schedule &schedule)
+{
+	if (name == "STATIC")
+		schedule = Schedule::STATIC;
+	else if (name == "DYNAMIC")
+		schedule = Schedule::DYNAMIC;
+	else if (name == "GUIDED")
+		schedule = Schedule::GUIDED;
+	else if (name == "RUNTIME")
+		schedule = Schedule::RUNTIME;
+	else
+		return false;
+	return true;
+}
+
+const char *scheduleName(Schedule schedule)
+{
+	switch (schedule)
+	{
+	case Schedule::STATIC:
+		return "STATIC";
+	case Schedule::DYNAMIC:
+		return "DYNAMIC";
+	case Schedule::GUIDED:
+		return "GUIDED";
+	default:
+		return "RUNTIME";
+	}
+}
+
+void escapeTimeBatch(const double *cr, const double *ci, int count,
+					 int iterations, int *escape)
+{
+	for (int first = 0; first < count; first += BATCH_WIDTH)
+	{
+		const int lanes = std::min(BATCH_WIDTH, count - first);
+		// Unused lanes of the last group start outside the radius
+		double pr[BATCH_WIDTH], pi[BATCH_WIDTH];
+		double zr[BATCH_WIDTH] = {}, zi[BATCH_WIDTH] = {};
+		int result[BATCH_WIDTH] = {};
+		for (int l = 0; l < BATCH_WIDTH; l++)
+		{
+			pr[l] = l < lanes ? cr[first + l] : 4.0;
+			pi[l] = l < lanes ? ci[first + l] : 0.0;
+		}
+		int running = BATCH_WIDTH;
+		for (int i = 1; i <= iterations && running > 0; i++)
+		{
+			running = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : running)
+#endif
+			for (int l = 0; l < BATCH_WIDTH; l++)
+			{
+				const bool active = result[l] == 0;
+				const double next_r =
+					zr[l] * zr[l] - zi[l] * zi[l] + pr[l];
+				const double next_i = 2 * zr[l] * zi[l] + pi[l];
+				zr[l] = active ? next_r : zr[l];
+				zi[l] = active ? next_i : zi[l];
+				const bool escaped =
+					active &&
+					next_r * next_r + next_i * next_i >= 4;
+				result[l] = escaped ? i : result[l];
+				running += active && !escaped;
+			}
+		}
+		std::copy(result, result + lanes, escape + first);
+	}
+}
+
+namespace
+{
+// The pixel loops, compiled once per formula policy
+template <typename Formula>
+void computeSequentialWith(const Formula &policy, int *image,
+						   int iterations, int width, int height,
+						   float step, float min_x, float min_y,
+						   threadtrace::Recorder *trace,
+						   progress::Reporter *progress)
+{
+	if (trace && trace->enabled())
+	{
+		trace->regionBegin();
+		for (int row = 0; row < height; row++)
+		{
+			threadtrace::Chunk chunk;
+			chunk.first = static_cast<int64_t>(row) * width;
+			chunk.count = width;
+			chunk.start = trace->now();
+			for (int col = 0; col < width; col++)
+			{
+				const std::complex<double> c =
+					pixelPoint(row, col, step, min_x, min_y);
+				const int escape =
+					formula::escapeTime(policy, c, iterations);
+				image[row * width + col] = escape;
+				chunk.iterations +=
+					executedIterations(escape, iterations);
+			}
+			chunk.end = trace->now();
+			trace->record(0, chunk);
+			if (progress)
+				progress->add(width);
+		}
+		trace->regionEnd();
+		return;
+	}
+	if (progress)
+	{
+		for (int row = 0; row < height; row++)
+		{
+			for (int col = 0; col < width; col++)
+			{
+				const std::complex<double> c =
+					pixelPoint(row, col, step, min_x, min_y);
+				image[row * width + col] =
+					formula::escapeTime(policy, c, iterations);
+			}
+			progress->add(width);
+		}
+		return;
+	}
+	for (int pos = 0; pos < height * width; pos++)
+	{
+		const int row = pos / width;
+		const int col = pos % width;
+		const std::complex<double> c =
+			pixelPoint(row, col, step, min_x, min_y);
+		image[pos] = formula::escapeTime(policy, c, iterations);
+	}
+}
+
+template <typename Formula>
+void computeOpenMPWith(const Formula &policy, int *image,
+					   int iterations, int width, int height,
+					   float step, float min_x, float min_y,
+					   Schedule schedule,
+					   threadtrace::Recorder *trace,
+					   progress::Reporter *progress)
+{
+	installSchedule(schedule);
+	if (trace && trace->enabled())
+	{
+		trace->regionBegin();
+#ifdef _OPENMP
+#pragma omp parallel default(none)                                 \
+	firstprivate(image, iterations, trace, progress)               \
+		shared(policy, width, height, step, min_x, min_y)
+#endif
+		{
+			progress::Batch batch(progress, width);
+#ifdef _OPENMP
+			threadtrace::ChunkTracker tracker(*trace,
+											  omp_get_thread_num());
+#pragma omp for schedule(runtime) nowait
+#else
+			threadtrace::ChunkTracker tracker(*trace, 0);
+#endif
+			for (int pos = 0; pos < height * width; pos++)
+			{
+				const int row = pos / width;
+				const int col = pos % width;
+				const std::complex<double> c =
+					pixelPoint(row, col, step, min_x, min_y);
+				const int escape =
+					formula::escapeTime(policy, c, iterations);
+				image[pos] = escape;
+				tracker.add(pos,
+							executedIterations(escape, iterations));
+				batch.add(1);
+			}
+		}
+		trace->regionEnd();
+		return;
+	}
+	if (progress)
+	{
+#ifdef _OPENMP
+#pragma omp parallel default(none)                                 \
+	firstprivate(image, iterations, progress)                      \
+		shared(policy, width, height, step, min_x, min_y)
+#endif
+		{
+			progress::Batch batch(progress, width);
+#ifdef _OPENMP
+#pragma omp for schedule(runtime) nowait
+#endif
+			for (int pos = 0; pos < height * width; pos++)
+			{
+				const int row = pos / width;
+				const int col = pos % width;
+				const std::complex<double> c =
+					pixelPoint(row, col, step, min_x, min_y);
+				image[pos] =
+					formula::escapeTime(policy, c, iterations);
+				batch.add(1);
+			}
+		}
+		return;
+	}
+	// region provided by *image is shared among threads, the
+	// pointer is private
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, iterations)                                \
+		shared(policy, width, height, step, min_x, min_y)
+#endif
+	for (int pos = 0; pos < height * width; pos++)
+	{
+		const int row = pos / width;
+		const int col = pos % width;
+		const std::complex<double> c =
+			pixelPoint(row, col, step, min_x, min_y);
+		image[pos] = formula::escapeTime(policy, c, iterations);
+	}
+}
+} // namespace
+
+void computeSequential(int *image, int iterations, int width,
+					   int height, float step, float min_x,
+					   float min_y, threadtrace::Recorder *trace,
+					   progress::Reporter *progress,
+					   const formula::Params &params)
+{
+	formula::dispatch(params,
+					  [&](const auto &policy)
+					  {
+						  computeSequentialWith(
+							  policy, image, iterations, width,
+							  height, step, min_x, min_y, trace,
+							  progress);
+					  });
+}
+
+void installSchedule(Schedule schedule)
+{
+#ifdef _OPENMP
+	// OMP_SCHEDULE as it was before any schedule was installed
+	static const std::pair<omp_sched_t, int> initial = []
+	{
+		omp_sched_t kind;
+		int chunk = 0;
+		omp_get_schedule(&kind, &chunk);
+		return std::make_pair(kind, chunk);
+	}();
+	switch (schedule)
+	{
+	case Schedule::STATIC:
+		omp_set_schedule(omp_sched_static, 0);
+		break;
+	case Schedule::DYNAMIC:
+		omp_set_schedule(omp_sched_dynamic, 0);
+		break;
+	case Schedule::GUIDED:
+		omp_set_schedule(omp_sched_guided, 0);
+		break;
+	case Schedule::RUNTIME:
+		omp_set_schedule(initial.first, initial.second);
+		break;
+	}
+#else
+	(void)schedule;
+#endif
+}
+
+void computeOpenMP(int *image, int iterations, int width,
+				   int height, float step, float min_x, float min_y,
+				   Schedule schedule, threadtrace::Recorder *trace,
+				   progress::Reporter *progress,
+				   const formula::Params &params)
+{
+	formula::dispatch(params,
+					  [&](const auto &policy)
+					  {
+						  computeOpenMPWith(
+							  policy, image, iterations, width,
+							  height, step, min_x, min_y, schedule,
+							  trace, progress);
+					  });
+}
+} // namespace kernels
+
+// Double-double kernels, see DoubleDouble.h for why they are
+// compiled apart from the rest
+DOUBLEDOUBLE_STRICT_BEGIN
+namespace kernels
+{
+template <>
+int escapeTimeScalar<dd::Real>(dd::Real cr, dd::Real ci,
+							   int iterations)
+{
+	dd::Real zr, zi;
+	for (int i = 1; i <= iterations; i++)
+	{
+		const dd::Real zri = zr * zi;
+		zr = zr * zr - zi * zi + cr;
+		// Doubling is exact on both parts
+		zi = dd::Real(2 * zri.hi, 2 * zri.lo) + ci;
+		// The hi parts decide the escape, like in the batch version
+		if (zr.hi * zr.hi + zi.hi * zi.hi >= 4)
+			return i;
+	}
+	return 0;
+}
+
+void escapeTimeBatch(const dd::Real *cr, const dd::Real *ci,
+					 int count, int iterations, int *escape)
+{
+	for (int first = 0; first < count; first += BATCH_WIDTH)
+	{
+		const int lanes = std::min(BATCH_WIDTH, count - first);
+		// Unused lanes of the last group start outside the radius
+		double pr_hi[BATCH_WIDTH], pr_lo[BATCH_WIDTH];
+		double pi_hi[BATCH_WIDTH], pi_lo[BATCH_WIDTH];
+		double zr_hi[BATCH_WIDTH] = {}, zr_lo[BATCH_WIDTH] = {};
+		double zi_hi[BATCH_WIDTH] = {}, zi_lo[BATCH_WIDTH] = {};
+		int result[BATCH_WIDTH] = {};
+		for (int l = 0; l < BATCH_WIDTH; l++)
+		{
+			pr_hi[l] = l < lanes ? cr[first + l].hi : 4.0;
+			pr_lo[l] = l < lanes ? cr[first + l].lo : 0.0;
+			pi_hi[l] = l < lanes ? ci[first + l].hi : 0.0;
+			pi_lo[l] = l < lanes ? ci[first + l].lo : 0.0;
+		}
+		int running = BATCH_WIDTH;
+		for (int i = 1; i <= iterations && running > 0; i++)
+		{
+			running = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : running)
+#endif
+			for (int l = 0; l < BATCH_WIDTH; l++)
+			{
+				const bool active = result[l] == 0;
+				double rr_hi, rr_lo, ii_hi, ii_lo, ri_hi, ri_lo;
+				dd::mul(zr_hi[l], zr_lo[l], zr_hi[l], zr_lo[l],
+						rr_hi, rr_lo);
+				dd::mul(zi_hi[l], zi_lo[l], zi_hi[l], zi_lo[l],
+						ii_hi, ii_lo);
+				dd::mul(zr_hi[l], zr_lo[l], zi_hi[l], zi_lo[l],
+						ri_hi, ri_lo);
+				double next_r_hi, next_r_lo, next_i_hi, next_i_lo;
+				dd::add(rr_hi, rr_lo, -ii_hi, -ii_lo, next_r_hi,
+						next_r_lo);
+				dd::add(next_r_hi, next_r_lo, pr_hi[l], pr_lo[l],
+						next_r_hi, next_r_lo);
+				dd::add(2 * ri_hi, 2 * ri_lo, pi_hi[l], pi_lo[l],
+						next_i_hi, next_i_lo);
+				zr_hi[l] = active ? next_r_hi : zr_hi[l];
+				zr_lo[l] = active ? next_r_lo : zr_lo[l];
+				zi_hi[l] = active ? next_i_hi : zi_hi[l];
+				zi_lo[l] = active ? next_i_lo : zi_lo[l];
+				// The hi parts decide the escape, the radius is not
+				// where the precision matters
+				const bool escaped =
+					active &&
+					next_r_hi * next_r_hi + next_i_hi * next_i_hi >=
+						4;
+				result[l] = escaped ? i : result[l];
+				running += active && !escaped;
+			}
+		}
+		std::copy(result, result + lanes, escape + first);
+	}
+}
+} // namespace kernels
+DOUBLEDOUBLE_STRICT_END
@@ -0,0 +1,191 @@
+// MandelbrotKernels.h
+#pragma once
+#include <DoubleDouble.h>
+#include <FormulaEngine.h>
+#include <ProgressReporter.h>
+#include <ThreadTrace.h>
+#include <complex>
+#include <string>
+
+namespace kernels
+{
+/**
+ * @brief Escape time of a single point.
+ *
+ * Iterates z = z^2 + c from z = 0 and returns the iteration at
+ * which |z| reaches 2, or 0 if the point did not escape within
+ * `iterations` steps.
+ */
+inline int escapeTime(const std::complex<double> &c, int iterations)
+{
+	// z = z^2 + c
+	return formula::escapeTime(formula::Mandelbrot(), c,
+							   iterations);
+}
+
+/**
+ * @brief Coordinate of pixel `index` along an axis. Computed in
+ * float, the precision the engines always mapped pixels in, so that
+ * every kernel iterates the same points.
+ */
+inline float pixelCoordinate(int index, float step, float min)
+{
+	return index * step + min;
+}
+
+/**
+ * @brief Point of pixel (row, col), `pixelCoordinate` widened to
+ * double.
+ */
+inline std::complex<double> pixelPoint(int row, int col, float step,
+									   float min_x, float min_y)
+{
+	return std::complex<double>(pixelCoordinate(col, step, min_x),
+								pixelCoordinate(row, step, min_y));
+}
+
+/**
+ * @brief Escape time on separate real and imaginary parts.
+ *
+ * The escape test is |z|^2 >= 4 instead of the square root of
+ * `escapeTime`, the form the MPI engine uses. With `Real = float`
+ * this is the single precision variant; it may disagree with the
+ * double kernels near the boundary.
+ */
+template <typename Real>
+inline int escapeTimeScalar(Real cr, Real ci, int iterations)
+{
+	Real zr = 0, zi = 0;
+	for (int i = 1; i <= iterations; i++)
+	{
+		const Real next_r = zr * zr - zi * zi + cr;
+		zi = 2 * zr * zi + ci;
+		zr = next_r;
+		if (zr * zr + zi * zi >= 4)
+			return i;
+	}
+	return 0;
+}
+
+/**
+ * @brief Double-double specialisation, about 106 bits per
+ * component.
+ *
+ * Defined out of line so that it is compiled with strict floating
+ * point, see DoubleDouble.h.
+ */
+template <>
+int escapeTimeScalar<dd::Real>(dd::Real cr, dd::Real ci,
+							   int iterations);
+
+/**
+ * @brief Points that `escapeTimeBatch` iterates in lockstep.
+ */
+constexpr int BATCH_WIDTH = 8;
+
+/**
+ * @brief Escape times of `count` points, computed in groups of
+ * `BATCH_WIDTH` lanes.
+ *
+ * Every lane of a group runs the same iteration so the update
+ * vectorizes; an escaped lane keeps its result and stops changing,
+ * the group ends once every lane escaped. A group therefore costs
+ * as much as its slowest point.
+ *
+ * @param escape Output, `count` escape times, 0 for bounded points.
+ */
+void escapeTimeBatch(const double *cr, const double *ci, int count,
+					 int iterations, int *escape);
+
+/**
+ * @brief `escapeTimeBatch` in double-double. The lanes keep their
+ * hi and lo parts in separate arrays so that the FMA-based
+ * arithmetic vectorises like the double version.
+ */
+void escapeTimeBatch(const dd::Real *cr, const dd::Real *ci,
+					 int count, int iterations, int *escape);
+
+/**
+ * @brief OpenMP loop schedules selectable at runtime.
+ */
+enum class Schedule
+{
+	STATIC,
+	DYNAMIC,
+	GUIDED,
+	RUNTIME
+};
+
+/**
+ * @brief Parses "STATIC", "DYNAMIC", "GUIDED" or "RUNTIME".
+ *
+ * @param name The schedule name, as used in the CSV files.
+ * @param schedule Receives the parsed schedule.
+ * @return `true` if the name is a known schedule.
+ */
+bool parseSchedule(const std::string &name, Schedule &schedule);
+
+/**
+ * @brief Returns the CSV name of a schedule.
+ */
+const char *scheduleName(Schedule schedule);
+
+/**
+ * @brief Installs the schedule that `schedule(runtime)` loops use.
+ *
+ * RUNTIME restores whatever OMP_SCHEDULE selected at the first
+ * call.
+ */
+void installSchedule(Schedule schedule);
+
+/**
+ * @brief Iterations actually executed for an `escapeTime` result.
+ */
+inline int executedIterations(int escape_time, int iterations)
+{
+	return escape_time == 0 ? iterations : escape_time;
+}
+
+/**
+ * @brief Computes the image on the calling thread.
+ *
+ * Pixel (row, col) maps to c = (col * step + min_x,
+ * row * step + min_y), evaluated in float like the engines always
+ * did so that every backend produces the same image.
+ *
+ * @param image Output, `width * height` escape times.
+ * @param trace Optional recorder, every row is recorded as a chunk
+ * of thread 0.
+ * @param progress Optional counter, advanced once per row.
+ * @param params The formula, Mandelbrot by default; see
+ * FormulaEngine.h.
+ */
+void computeSequential(
+	int *image, int iterations, int width, int height, float step,
+	float min_x, float min_y,
+	threadtrace::Recorder *trace = nullptr,
+	progress::Reporter *progress = nullptr,
+	const formula::Params &params = formula::Params());
+
+/**
+ * @brief Computes the image with an OpenMP parallel loop.
+ *
+ * The loop uses `schedule(runtime)`; the requested schedule is
+ * installed with `omp_set_schedule` before the loop, except for
+ * RUNTIME which keeps whatever OMP_SCHEDULE selected. The team size
+ * is the current OpenMP default.
+ *
+ * @param image Output, `width * height` escape times.
+ * @param trace Optional recorder with at least as many threads as
+ * the team, records the chunks every thread was handed.
+ * @param progress Optional counter, every thread adds its pixels
+ * about once per row's worth.
+ * @param params The formula, Mandelbrot by default.
+ */
+void computeOpenMP(
+	int *image, int iterations, int width, int height, float step,
+	float min_x, float min_y, Schedule schedule,
+	threadtrace::Recorder *trace = nullptr,
+	progress::Reporter *progress = nullptr,
+	const formula::Params &params = formula::Params());
+} // namespace kernels
\ No newline at end of file
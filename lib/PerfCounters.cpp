@@ -0,0 +1,298 @@
+#include "PerfCounters.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace perfcounters
+{
+namespace
+{
+struct EventConfig
+{
+	uint32_t type;
+	uint64_t config;
+};
+
+uint64_t cacheMiss(uint64_t cache)
+{
+	return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+// Raw FP event of the running CPU, config 0 if unknown
+uint64_t fpRawConfig()
+{
+	if (const char *env = std::getenv("MANDELBROT_PERF_FP_EVENT"))
+		return std::strtoull(env, nullptr, 0);
+	std::ifstream cpuinfo("/proc/cpuinfo");
+	std::string line;
+	while (std::getline(cpuinfo, line))
+	{
+		if (line.rfind("vendor_id", 0) != 0)
+			continue;
+		if (line.find("AuthenticAMD") != std::string::npos)
+			return 0xff03;
+		if (line.find("GenuineIntel") != std::string::npos)
+			return 0x3fc7;
+		break;
+	}
+	return 0;
+}
+
+EventConfig eventConfig(Counter counter)
+{
+	switch (counter)
+	{
+	case CYCLES:
+		return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+	case INSTRUCTIONS:
+		return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+	case BRANCH_MISSES:
+		return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+	case L1D_MISSES:
+		return {PERF_TYPE_HW_CACHE,
+				cacheMiss(PERF_COUNT_HW_CACHE_L1D)};
+	case LLC_MISSES:
+		return {PERF_TYPE_HW_CACHE,
+				cacheMiss(PERF_COUNT_HW_CACHE_LL)};
+	default:
+		return {PERF_TYPE_RAW, fpRawConfig()};
+	}
+}
+
+int openEvent(const EventConfig &event, int group_fd)
+{
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = event.type;
+	attr.config = event.config;
+	// Members follow the leader, which starts disabled
+	attr.disabled = group_fd == -1 ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+					   PERF_FORMAT_TOTAL_TIME_ENABLED |
+					   PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return static_cast<int>(
+		syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+} // namespace
+
+const char *counterName(Counter counter)
+{
+	static const char *names[COUNTER_COUNT] = {
+		"Cycles",	  "Instructions", "Branch Misses",
+		"L1D Misses", "LLC Misses",	  "FP Ops"};
+	return names[counter];
+}
+
+double Sample::ipc() const
+{
+	if (!valid[CYCLES] || !valid[INSTRUCTIONS] ||
+		values[CYCLES] == 0)
+		return 0.0;
+	return static_cast<double>(values[INSTRUCTIONS]) /
+		   values[CYCLES];
+}
+
+Sample &Sample::operator+=(const Sample &other)
+{
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		values[c] += other.values[c];
+		valid[c] = valid[c] || other.valid[c];
+	}
+	return *this;
+}
+
+ThreadGroups::ThreadGroups(int threads)
+{
+	groups.resize(threads > 0 ? threads : 1);
+	samples.resize(groups.size());
+	std::string error;
+#ifdef _OPENMP
+#pragma omp parallel num_threads(static_cast <int>(groups.size()))
+	{
+		std::string thread_error;
+		openGroup(groups[omp_get_thread_num()], thread_error);
+#pragma omp critical(perfcounters_open)
+		if (error.empty())
+			error = thread_error;
+	}
+#else
+	openGroup(groups[0], error);
+#endif
+	message = error;
+}
+
+ThreadGroups::~ThreadGroups()
+{
+	for (Group &group : groups)
+		for (int fd : group.fds)
+			if (fd != -1)
+				close(fd);
+}
+
+void ThreadGroups::openGroup(Group &group, std::string &error)
+{
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		group.fds[c] = -1;
+		const EventConfig event =
+			eventConfig(static_cast<Counter>(c));
+		if (event.type == PERF_TYPE_RAW && event.config == 0)
+		{
+			error += std::string(error.empty() ? "" : ", ") +
+					 counterName(static_cast<Counter>(c)) +
+					 ": unknown CPU vendor";
+			continue;
+		}
+		// The first counter that opens becomes the group leader
+		const int fd = openEvent(event, group.leader);
+		if (fd == -1)
+		{
+			error += std::string(error.empty() ? "" : ", ") +
+					 counterName(static_cast<Counter>(c)) + ": " +
+					 std::strerror(errno);
+			continue;
+		}
+		group.fds[c] = fd;
+		if (group.leader == -1)
+			group.leader = fd;
+	}
+}
+
+bool ThreadGroups::available() const
+{
+	for (const Group &group : groups)
+		if (group.leader != -1)
+			return true;
+	return false;
+}
+
+const std::string &ThreadGroups::status() const { return message; }
+
+void ThreadGroups::start()
+{
+	for (const Group &group : groups)
+	{
+		if (group.leader == -1)
+			continue;
+		ioctl(group.leader, PERF_EVENT_IOC_RESET,
+			  PERF_IOC_FLAG_GROUP);
+		ioctl(group.leader, PERF_EVENT_IOC_ENABLE,
+			  PERF_IOC_FLAG_GROUP);
+	}
+}
+
+Sample ThreadGroups::stop()
+{
+	for (const Group &group : groups)
+		if (group.leader != -1)
+			ioctl(group.leader, PERF_EVENT_IOC_DISABLE,
+				  PERF_IOC_FLAG_GROUP);
+	Sample total;
+	for (size_t t = 0; t < groups.size(); t++)
+	{
+		samples[t] = readGroup(groups[t]);
+		total += samples[t];
+	}
+	return total;
+}
+
+const std::vector<Sample> &ThreadGroups::threadSamples() const
+{
+	return samples;
+}
+
+Sample ThreadGroups::readGroup(const Group &group) const
+{
+	Sample sample;
+	if (group.leader == -1)
+		return sample;
+	// nr, time_enabled, time_running, then {value, id} per event
+	uint64_t buffer[3 + 2 * COUNTER_COUNT];
+	const ssize_t bytes =
+		read(group.leader, buffer, sizeof(buffer));
+	if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t)))
+		return sample;
+	const uint64_t count = buffer[0];
+	const uint64_t enabled = buffer[1];
+	const uint64_t running = buffer[2];
+	// Never scheduled on the PMU, nothing meaningful was counted
+	if (running == 0)
+		return sample;
+	const double scale = static_cast<double>(enabled) / running;
+
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		if (group.fds[c] == -1)
+			continue;
+		uint64_t id = 0;
+		if (ioctl(group.fds[c], PERF_EVENT_IOC_ID, &id) == -1)
+			continue;
+		for (uint64_t e = 0; e < count && e < COUNTER_COUNT; e++)
+		{
+			if (buffer[3 + 2 * e + 1] != id)
+				continue;
+			sample.values[c] =
+				static_cast<uint64_t>(buffer[3 + 2 * e] * scale);
+			sample.valid[c] = true;
+		}
+	}
+	return sample;
+}
+
+std::string csvHeaderColumns(const std::string &phase)
+{
+	std::string columns;
+	for (int c = 0; c < COUNTER_COUNT; c++)
+		columns += "," + phase + " " +
+				   counterName(static_cast<Counter>(c));
+	return columns + "," + phase + " IPC";
+}
+
+std::string csvColumns(const Sample &sample)
+{
+	std::ostringstream columns;
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		columns << ",";
+		if (sample.valid[c])
+			columns << sample.values[c];
+	}
+	columns << ",";
+	if (sample.valid[CYCLES] && sample.valid[INSTRUCTIONS])
+		columns << sample.ipc();
+	return columns.str();
+}
+
+std::string describe(const Sample &sample)
+{
+	std::ostringstream text;
+	for (int c = 0; c < COUNTER_COUNT; c++)
+	{
+		text << counterName(static_cast<Counter>(c)) << ":\t";
+		if (sample.valid[c])
+			text << sample.values[c];
+		else
+			text << "n/a";
+		text << "\t";
+	}
+	text << "IPC:\t" << sample.ipc();
+	return text.str();
+}
+} // namespace perfcounters
@@ -0,0 +1,116 @@
+// PerfCounters.h
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace perfcounters
+{
+/**
+ * @brief Hardware events collected in every group.
+ */
+enum Counter
+{
+	CYCLES,
+	INSTRUCTIONS,
+	BRANCH_MISSES,
+	L1D_MISSES,
+	LLC_MISSES,
+	FP_OPS,
+	COUNTER_COUNT
+};
+
+/**
+ * @brief CSV/log name of a counter, e.g. "Cycles".
+ */
+const char *counterName(Counter counter);
+
+/**
+ * @brief Counter values of one thread or of a whole team.
+ *
+ * Values are scaled by time_enabled / time_running when the kernel
+ * had to multiplex the group. A counter that could not be opened
+ * has `valid` false and is written as an empty CSV field.
+ */
+struct Sample
+{
+	uint64_t values[COUNTER_COUNT] = {};
+	bool valid[COUNTER_COUNT] = {};
+
+	// Instructions per cycle, 0 if either counter is missing
+	double ipc() const;
+	Sample &operator+=(const Sample &other);
+};
+
+/**
+ * @brief One perf_event_open group per thread of an OpenMP team.
+ *
+ * The constructor opens the groups from inside a parallel region of
+ * `threads` threads, so each group follows the thread that opened
+ * it (pid 0, any CPU). Both GCC and LLVM OpenMP reuse the same pool
+ * threads for later regions of the same size, which makes the
+ * groups count exactly the threads running the compute loop.
+ * Without OpenMP a single group is opened on the calling thread.
+ *
+ * Only user-space events are counted so that the default
+ * perf_event_paranoid level of 2 is enough. When perf_event_open is
+ * not permitted or the PMU is not exposed (containers, some VMs)
+ * the groups stay closed, `available()` is false and every sample
+ * is invalid; callers keep running without counters.
+ *
+ * FP ops use a raw event: PMCx003 (retired SSE/AVX FLOPs) on AMD
+ * and FP_ARITH_INST_RETIRED (0xC7, instructions, not FLOPs) on
+ * Intel. MANDELBROT_PERF_FP_EVENT overrides the raw config for
+ * other CPUs, e.g. MANDELBROT_PERF_FP_EVENT=0x3fc7.
+ */
+class ThreadGroups
+{
+  public:
+	explicit ThreadGroups(int threads);
+	~ThreadGroups();
+	ThreadGroups(const ThreadGroups &) = delete;
+	ThreadGroups &operator=(const ThreadGroups &) = delete;
+
+	// At least one thread has an open group
+	bool available() const;
+	// Why counters, or some of them, are missing; empty if none
+	const std::string &status() const;
+
+	// Resets and enables every group
+	void start();
+	// Disables every group and returns the team total, the
+	// per-thread values are kept in `threadSamples()`
+	Sample stop();
+	const std::vector<Sample> &threadSamples() const;
+
+  private:
+	struct Group
+	{
+		int fds[COUNTER_COUNT];
+		int leader = -1;
+	};
+	void openGroup(Group &group, std::string &error);
+	Sample readGroup(const Group &group) const;
+
+	std::vector<Group> groups;
+	std::vector<Sample> samples;
+	std::string message;
+};
+
+/**
+ * @brief CSV header columns of a sample, each prefixed with a comma
+ * and the phase, e.g. ",Compute Cycles,...,Compute IPC".
+ */
+std::string csvHeaderColumns(const std::string &phase);
+
+/**
+ * @brief CSV values matching `csvHeaderColumns`, each prefixed with
+ * a comma; invalid counters are left empty.
+ */
+std::string csvColumns(const Sample &sample);
+
+/**
+ * @brief Tab separated "Name:\tvalue" pairs for the log files.
+ */
+std::string describe(const Sample &sample);
+} // namespace perfcounters
@@ -0,0 +1,42 @@
+#include "PointQuery.h"
+
+#include <algorithm>
+
+namespace pointquery
+{
+namespace
+{
+// One block of at most BLOCK_SIZE points
+void queryBlock(const std::complex<double> *points, int count,
+				int iterations, int *escape)
+{
+	double cr[BLOCK_SIZE], ci[BLOCK_SIZE];
+	for (int k = 0; k < count; k++)
+	{
+		cr[k] = points[k].real();
+		ci[k] = points[k].imag();
+	}
+	kernels::escapeTimeBatch(cr, ci, count, iterations, escape);
+}
+} // namespace
+
+void query(const std::complex<double> *points, int64_t count,
+		   int iterations, int *escape, kernels::Schedule schedule)
+{
+	const int64_t blocks = (count + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	kernels::installSchedule(schedule);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(points, count, iterations, escape,                \
+				 blocks) if (count >= PARALLEL_THRESHOLD)
+#endif
+	for (int64_t block = 0; block < blocks; block++)
+	{
+		const int64_t first = block * BLOCK_SIZE;
+		queryBlock(points + first,
+				   static_cast<int>(std::min<int64_t>(
+					   BLOCK_SIZE, count - first)),
+				   iterations, escape + first);
+	}
+}
+} // namespace pointquery
@@ -0,0 +1,43 @@
+// PointQuery.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <complex>
+#include <cstdint>
+
+namespace pointquery
+{
+/**
+ * @brief Points deinterleaved and handed to
+ * `kernels::escapeTimeBatch` at a time, also the unit the threads
+ * share.
+ */
+constexpr int BLOCK_SIZE = 256;
+
+/**
+ * @brief Smallest query split across threads. Smaller ones run on
+ * the calling thread, a parallel region would cost more than it
+ * saves.
+ */
+constexpr int64_t PARALLEL_THRESHOLD = 16 * BLOCK_SIZE;
+
+/**
+ * @brief Escape times of arbitrary points.
+ *
+ * The points are split into blocks of `BLOCK_SIZE`, deinterleaved
+ * and iterated with the vectorised `kernels::escapeTimeBatch`, so
+ * the results are those of `kernels::escapeTimeScalar<double>`.
+ * Queries of at least `PARALLEL_THRESHOLD` points distribute the
+ * blocks with a `schedule(runtime)` loop.
+ *
+ * A group of `kernels::BATCH_WIDTH` lanes costs as much as its
+ * slowest point; callers with scattered points of very different
+ * cost (close to the boundary and far from it) gain from passing
+ * neighbours together.
+ *
+ * @param points `count` points, contiguous.
+ * @param escape Output, `count` escape times, 0 for bounded points.
+ */
+void query(const std::complex<double> *points, int64_t count,
+		   int iterations, int *escape,
+		   kernels::Schedule schedule = kernels::Schedule::RUNTIME);
+} // namespace pointquery
@@ -0,0 +1,201 @@
+#include "PrecisionTiles.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstdlib>
+#include <sstream>
+
+namespace precision
+{
+const char *modeName(Mode mode)
+{
+	return mode == Mode::DOUBLE ? "double" : "auto";
+}
+
+bool parseMode(const std::string &name, Mode &mode)
+{
+	if (name == "double")
+		mode = Mode::DOUBLE;
+	else if (name == "auto")
+		mode = Mode::AUTO;
+	else
+		return false;
+	return true;
+}
+
+namespace
+{
+/**
+ * @brief Escape times of `count` pixels of a row in float lanes.
+ *
+ * @return `false` as soon as a group of lanes has a pixel float
+ * cannot be trusted with; `escape` is incomplete then.
+ */
+bool floatSegment(const float *cr, float ci, int count,
+				  int iterations, int *escape)
+{
+	const int limit = std::min(iterations, FLOAT_MAX_ESCAPE);
+	for (int first = 0; first < count; first += FLOAT_BATCH_WIDTH)
+	{
+		const int lanes =
+			std::min(FLOAT_BATCH_WIDTH, count - first);
+		// Unused lanes of the last group start outside the radius
+		float pr[FLOAT_BATCH_WIDTH];
+		float zr[FLOAT_BATCH_WIDTH] = {},
+			  zi[FLOAT_BATCH_WIDTH] = {};
+		float closest[FLOAT_BATCH_WIDTH];
+		int result[FLOAT_BATCH_WIDTH] = {};
+		for (int l = 0; l < FLOAT_BATCH_WIDTH; l++)
+		{
+			pr[l] = l < lanes ? cr[first + l] : 4.0f;
+			closest[l] = 4.0f;
+		}
+		int running = FLOAT_BATCH_WIDTH;
+		for (int i = 1; i <= limit && running > 0; i++)
+		{
+			running = 0;
+#ifdef _OPENMP
+#pragma omp simd reduction(+ : running)
+#endif
+			for (int l = 0; l < FLOAT_BATCH_WIDTH; l++)
+			{
+				const bool active = result[l] == 0;
+				const float next_r =
+					zr[l] * zr[l] - zi[l] * zi[l] + pr[l];
+				const float next_i = 2 * zr[l] * zi[l] + ci;
+				zr[l] = active ? next_r : zr[l];
+				zi[l] = active ? next_i : zi[l];
+				const float magnitude =
+					next_r * next_r + next_i * next_i;
+				closest[l] =
+					active ? std::min(closest[l],
+									  std::fabs(magnitude - 4))
+						   : closest[l];
+				const bool escaped = active && magnitude >= 4;
+				result[l] = escaped ? i : result[l];
+				running += active && !escaped;
+			}
+		}
+		for (int l = 0; l < lanes; l++)
+			if (result[l] == 0 || closest[l] < FLOAT_RADIUS_MARGIN)
+				return false;
+		std::copy(result, result + lanes, escape + first);
+	}
+	return true;
+}
+} // namespace
+
+Stats computeOpenMP(int *image, int iterations, int width,
+					int height, float step, float min_x,
+					float min_y, kernels::Schedule schedule,
+					progress::Reporter *progress)
+{
+	const int tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+	const int tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+	const int tiles = tiles_x * tiles_y;
+	int64_t promoted = 0;
+	kernels::installSchedule(schedule);
+#ifdef _OPENMP
+#pragma omp parallel default(none)                                 \
+	firstprivate(image, iterations, progress)                      \
+	shared(width, height, step, min_x, min_y, tiles, tiles_x)      \
+	reduction(+ : promoted)
+#endif
+	{
+		progress::Batch batch(progress, TILE_SIZE * TILE_SIZE);
+#ifdef _OPENMP
+#pragma omp for schedule(runtime) nowait
+#endif
+		for (int tile = 0; tile < tiles; tile++)
+		{
+			const int row_begin = (tile / tiles_x) * TILE_SIZE;
+			const int col_begin = (tile % tiles_x) * TILE_SIZE;
+			const int row_end =
+				std::min(row_begin + TILE_SIZE, height);
+			const int col_end =
+				std::min(col_begin + TILE_SIZE, width);
+			const int count = col_end - col_begin;
+			float cr[TILE_SIZE];
+			for (int k = 0; k < count; k++)
+				cr[k] = kernels::pixelCoordinate(col_begin + k,
+												 step, min_x);
+			bool safe = true;
+			for (int row = row_begin; row < row_end && safe; row++)
+				safe = floatSegment(
+					cr, kernels::pixelCoordinate(row, step, min_y),
+					count, iterations,
+					image + row * width + col_begin);
+			if (!safe)
+			{
+				promoted++;
+				for (int row = row_begin; row < row_end; row++)
+					for (int col = col_begin; col < col_end; col++)
+					{
+						const std::complex<double> c =
+							kernels::pixelPoint(row, col, step,
+												min_x, min_y);
+						image[row * width + col] =
+							kernels::escapeTime(c, iterations);
+					}
+			}
+			batch.add(static_cast<int64_t>(row_end - row_begin) *
+					  count);
+		}
+	}
+	Stats stats;
+	stats.tiles = tiles;
+	stats.promoted = promoted;
+	return stats;
+}
+
+Verification verify(const int *image, const int *reference,
+					int64_t size)
+{
+	Verification verification;
+	for (int64_t pos = 0; pos < size; pos++)
+		if (image[pos] != reference[pos])
+		{
+			verification.mismatches++;
+			verification.max_difference =
+				std::max(verification.max_difference,
+						 std::abs(image[pos] - reference[pos]));
+		}
+	return verification;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Precision,Tiles,Promoted Tiles,Promoted Fraction,"
+		   "Mismatches,Max Difference";
+}
+
+std::string csvColumns(Mode mode, const Stats &stats,
+					   const Verification *verification)
+{
+	std::ostringstream columns;
+	columns << "," << modeName(mode) << "," << stats.tiles << ","
+			<< stats.promoted << "," << stats.promotedFraction()
+			<< ",";
+	if (verification)
+		columns << verification->mismatches << ","
+				<< verification->max_difference;
+	else
+		columns << ",";
+	return columns.str();
+}
+
+std::string describe(Mode mode, const Stats &stats,
+					 const Verification *verification)
+{
+	std::ostringstream text;
+	text << "\tPrecision:\t" << modeName(mode) << "\tTiles:\t"
+		 << stats.tiles << "\tPromoted:\t" << stats.promoted
+		 << "\t(" << 100.0 * stats.promotedFraction() << "\t%)";
+	if (verification)
+		text << "\tMismatches:\t" << verification->mismatches
+			 << "\tMax difference:\t"
+			 << verification->max_difference;
+	return text.str();
+}
+} // namespace precision
@@ -0,0 +1,109 @@
+// PrecisionTiles.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <ProgressReporter.h>
+#include <cstdint>
+#include <string>
+
+namespace precision
+{
+/**
+ * @brief Precision the OpenMP engine renders with.
+ *
+ * DOUBLE is the original kernel for every pixel and the default;
+ * AUTO starts every tile in float and promotes it to double when
+ * float looks untrustworthy there. The promotion test is a
+ * heuristic, not an error bound, so an AUTO image may differ from
+ * the DOUBLE one in a few pixels; `--verify-precision` reports
+ * them.
+ */
+enum class Mode
+{
+	DOUBLE,
+	AUTO
+};
+
+// "double" or "auto"
+const char *modeName(Mode mode);
+bool parseMode(const std::string &name, Mode &mode);
+
+// Edge of the square tiles that are promoted as a whole
+constexpr int TILE_SIZE = 16;
+
+// Float lanes iterated in lockstep, twice the double batch in the
+// same vector registers
+constexpr int FLOAT_BATCH_WIDTH = 2 * kernels::BATCH_WIDTH;
+
+/**
+ * @brief Iterations float is trusted with. A pixel that has not
+ * escaped by then is bounded or close to the set, where the
+ * rounding of float decides the escape time, and its tile is
+ * promoted.
+ */
+constexpr int FLOAT_MAX_ESCAPE = 32;
+
+/**
+ * @brief Closest |z|^2 may get to the radius 4 in float, before or
+ * at the escape. Nearer than that, the rounding could move the
+ * escape by one iteration and the tile is promoted. A fixed margin,
+ * not a bound of the accumulated rounding: an orbit whose float
+ * error grew past it still escapes at the wrong iteration.
+ */
+constexpr float FLOAT_RADIUS_MARGIN = 1e-2f;
+
+struct Stats
+{
+	int64_t tiles = 0;
+	int64_t promoted = 0;
+
+	double promotedFraction() const
+	{
+		return tiles > 0 ? static_cast<double>(promoted) / tiles
+						 : 0.0;
+	}
+};
+
+/**
+ * @brief Computes the image like `kernels::computeOpenMP`, tile by
+ * tile in float where that looks safe.
+ *
+ * Every tile is first iterated in float lanes, with the pixel
+ * coordinates the engines always used. If a pixel stays in the
+ * set for `FLOAT_MAX_ESCAPE` iterations or |z|^2 comes within
+ * `FLOAT_RADIUS_MARGIN` of 4, the tile is recomputed with
+ * `kernels::escapeTime` in double, so promoted tiles are identical
+ * to the double image; float tiles usually are, but are not
+ * guaranteed to be. The tiles are distributed with a
+ * `schedule(runtime)` loop.
+ *
+ * @param progress Optional counter, advanced per tile.
+ * @return Tiles and promoted tiles.
+ */
+Stats computeOpenMP(int *image, int iterations, int width,
+					int height, float step, float min_x,
+					float min_y, kernels::Schedule schedule,
+					progress::Reporter *progress = nullptr);
+
+/**
+ * @brief Differences of an image against the double reference.
+ */
+struct Verification
+{
+	int64_t mismatches = 0;
+	// Largest difference of two escape times
+	int max_difference = 0;
+};
+
+Verification verify(const int *image, const int *reference,
+					int64_t size);
+
+// ",Precision,Tiles,Promoted Tiles,Promoted Fraction,..."
+std::string csvHeaderColumns();
+// `verification` may be null when the image was not verified, the
+// columns stay empty then
+std::string csvColumns(Mode mode, const Stats &stats,
+					   const Verification *verification);
+// One tab separated line for the log
+std::string describe(Mode mode, const Stats &stats,
+					 const Verification *verification);
+} // namespace precision
@@ -0,0 +1,107 @@
+#include "ProgressReporter.h"
+
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+
+namespace progress
+{
+namespace
+{
+double now()
+{
+	return std::chrono::duration<double>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+} // namespace
+
+Reporter::Reporter(int64_t total, double interval_seconds,
+				   const std::string &unit)
+	: total_units(total), interval(interval_seconds), unit(unit)
+{
+}
+
+Reporter::~Reporter()
+{
+	if (thread.joinable())
+		stop();
+}
+
+void Reporter::start()
+{
+	if (thread.joinable())
+		return;
+	start_time = now();
+	stopping = false;
+	thread = std::thread(&Reporter::run, this);
+}
+
+void Reporter::stop()
+{
+	if (!thread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wakeup.notify_all();
+	thread.join();
+	const double elapsed = now() - start_time;
+	report(elapsed, elapsed > 0.0 ? done() / elapsed : 0.0);
+}
+
+void Reporter::run()
+{
+	double last_time = start_time;
+	int64_t last_done = done();
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!wakeup.wait_for(lock,
+							std::chrono::duration<double>(interval),
+							[this] { return stopping; }))
+	{
+		const double time = now();
+		const int64_t current = done();
+		const double rate =
+			time > last_time
+				? (current - last_done) / (time - last_time)
+				: 0.0;
+		report(time - start_time, rate);
+		last_time = time;
+		last_done = current;
+	}
+}
+
+void Reporter::report(double elapsed, double rate)
+{
+	// stdio keeps the line whole next to the engines' own output
+	const std::string line =
+		describe(done(), total_units, elapsed, rate, unit) + "\n";
+	std::fputs(line.c_str(), stderr);
+	std::fflush(stderr);
+}
+
+std::string describe(int64_t done, int64_t total, double elapsed,
+					 double rate, const std::string &unit)
+{
+	std::ostringstream text;
+	text.setf(std::ios::fixed);
+	text.precision(1);
+	const double fraction =
+		total > 0 ? static_cast<double>(done) / total : 0.0;
+	text << "Progress: " << fraction * 100.0 << "% (" << done << "/"
+		 << total << " " << unit << "), ";
+	text.unsetf(std::ios::fixed);
+	text.precision(3);
+	text << rate << " " << unit << "/s";
+	// ETA from the average rate, the current one jumps between
+	// tiles
+	if (done >= total)
+		text << ", done in " << elapsed << " s";
+	else if (done > 0)
+		text << ", ETA " << (total - done) * elapsed / done << " s";
+	else
+		text << ", ETA unknown";
+	return text.str();
+}
+} // namespace progress
@@ -0,0 +1,113 @@
+// ProgressReporter.h
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace progress
+{
+/**
+ * @brief Completed work of a run and a thread that reports it.
+ *
+ * The engines add completed pixels from the compute loop, batched
+ * through `Batch` so that a relaxed atomic add happens about once
+ * per row and thread. While started, a reporter thread prints the
+ * progress, the throughput of the last interval and an ETA from the
+ * average rate to stderr. The count can also be overwritten with
+ * `set`, which MPI rank 0 does with the reduced global count.
+ */
+class Reporter
+{
+  public:
+	/**
+	 * @param total Units of the whole run, e.g. pixels.
+	 * @param interval_seconds Time between two reports.
+	 * @param unit Name of the unit in the report.
+	 */
+	Reporter(int64_t total, double interval_seconds,
+			 const std::string &unit = "pixels");
+	~Reporter();
+
+	Reporter(const Reporter &) = delete;
+	Reporter &operator=(const Reporter &) = delete;
+
+	inline void add(int64_t units)
+	{
+		completed.fetch_add(units, std::memory_order_relaxed);
+	}
+	void set(int64_t units)
+	{
+		completed.store(units, std::memory_order_relaxed);
+	}
+	int64_t done() const
+	{
+		return completed.load(std::memory_order_relaxed);
+	}
+	int64_t total() const { return total_units; }
+
+	// Starts the reporter thread
+	void start();
+	// Stops the thread and prints a final report
+	void stop();
+
+  private:
+	void run();
+	void report(double elapsed, double rate);
+
+	const int64_t total_units;
+	const double interval;
+	const std::string unit;
+	std::atomic<int64_t> completed{0};
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable wakeup;
+	bool stopping = false;
+	double start_time = 0.0;
+};
+
+/**
+ * @brief Per-thread accumulator in front of a `Reporter`.
+ *
+ * Flushes to the shared counter every `flush_units` units and on
+ * destruction; with a null reporter it only counts locally.
+ */
+class Batch
+{
+  public:
+	Batch(Reporter *reporter, int64_t flush_units)
+		: reporter(reporter), flush_units(flush_units)
+	{
+	}
+	~Batch() { flush(); }
+
+	inline void add(int64_t units)
+	{
+		pending += units;
+		if (pending >= flush_units)
+			flush();
+	}
+	void flush()
+	{
+		if (reporter && pending > 0)
+			reporter->add(pending);
+		pending = 0;
+	}
+
+  private:
+	Reporter *reporter;
+	const int64_t flush_units;
+	int64_t pending = 0;
+};
+
+/**
+ * @brief One report line, e.g. "Progress: 42.1% (2520000/6000000
+ * pixels), 1.2e+06 pixels/s, ETA 3.1 s".
+ *
+ * @param rate Current rate in units per second.
+ */
+std::string describe(int64_t done, int64_t total, double elapsed,
+					 double rate, const std::string &unit);
+} // namespace progress
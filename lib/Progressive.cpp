@@ -0,0 +1,241 @@
+#include "Progressive.h"
+
+#include <chrono>
+#include <complex>
+#include <sstream>
+
+namespace progressive
+{
+namespace
+{
+// Escape time of pixel (row, col)
+inline int computePixel(int row, int col, float step, float min_x,
+						float min_y, int iterations)
+{
+	const std::complex<double> c =
+		kernels::pixelPoint(row, col, step, min_x, min_y);
+	return kernels::escapeTime(c, iterations);
+}
+
+/**
+ * @brief Computes or guesses the pixels of the `spacing` grid that
+ * are not on the grid of the level before.
+ */
+void refine(int *image, unsigned char *guessed_mask, int iterations,
+			int width, int height, float step, float min_x,
+			float min_y, int spacing, bool first, Level &level)
+{
+	const int coarse = 2 * spacing;
+	const int rows = (height - 1) / spacing + 1;
+	int64_t computed = 0, guessed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, guessed_mask, iterations)                  \
+	shared(width, height, step, min_x, min_y, spacing, first,      \
+		   coarse, rows)                                           \
+	reduction(+ : computed, guessed)
+#endif
+	for (int r = 0; r < rows; r++)
+	{
+		const int row = r * spacing;
+		const int row0 = row - row % coarse;
+		const int row1 = row0 + coarse;
+		for (int col = 0; col < width; col += spacing)
+		{
+			if (!first && row == row0 && col % coarse == 0)
+				continue;
+			const int col0 = col - col % coarse;
+			const int col1 = col0 + coarse;
+			const int pos = row * width + col;
+			if (!first && row1 < height && col1 < width)
+			{
+				const int corner = image[row0 * width + col0];
+				if (image[row0 * width + col1] == corner &&
+					image[row1 * width + col0] == corner &&
+					image[row1 * width + col1] == corner)
+				{
+					image[pos] = corner;
+					guessed_mask[pos] = 1;
+					guessed++;
+					continue;
+				}
+			}
+			image[pos] = computePixel(row, col, step, min_x, min_y,
+									  iterations);
+			computed++;
+		}
+	}
+	level.computed = computed;
+	level.guessed = guessed;
+}
+
+// Repeats every known pixel over the ones up to the next known
+// pixel
+void fillPreview(int *image, int width, int height, int spacing)
+{
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) default(none)            \
+	firstprivate(image) shared(width, height, spacing)
+#endif
+	for (int row = 0; row < height; row++)
+	{
+		const int known_row = row - row % spacing;
+		for (int col = 0; col < width; col++)
+			if (row != known_row || col % spacing != 0)
+				image[row * width + col] =
+					image[known_row * width + col - col % spacing];
+	}
+}
+} // namespace
+
+int64_t Stats::computed() const
+{
+	int64_t total = 0;
+	for (const Level &level : levels)
+		total += level.computed;
+	return total;
+}
+
+int64_t Stats::guessed() const
+{
+	int64_t total = 0;
+	for (const Level &level : levels)
+		total += level.guessed;
+	return total;
+}
+
+int64_t Stats::corrected() const
+{
+	return levels.empty() ? 0 : levels.back().corrected;
+}
+
+Stats render(int *image, int iterations, int width, int height,
+			 float step, float min_x, float min_y, bool exact,
+			 kernels::Schedule schedule,
+			 const LevelCallback &callback)
+{
+	Stats stats;
+	stats.pixels = static_cast<int64_t>(width) * height;
+	std::vector<unsigned char> guessed_mask(stats.pixels, 0);
+	kernels::installSchedule(schedule);
+	const auto start = std::chrono::steady_clock::now();
+	double callback_seconds = 0.0;
+	// Times the level, hands it to the callback and keeps it
+	auto finish =
+		[&](Level &level,
+			std::chrono::steady_clock::time_point level_start)
+	{
+		const auto level_end = std::chrono::steady_clock::now();
+		level.seconds =
+			std::chrono::duration<double>(level_end - level_start)
+				.count();
+		level.elapsed =
+			std::chrono::duration<double>(level_end - start)
+				.count() -
+			callback_seconds;
+		stats.levels.push_back(level);
+		if (callback)
+		{
+			callback(image, level);
+			callback_seconds +=
+				std::chrono::duration<double>(
+					std::chrono::steady_clock::now() - level_end)
+					.count();
+		}
+	};
+
+	for (int spacing = INITIAL_SPACING; spacing >= 1; spacing /= 2)
+	{
+		const auto level_start = std::chrono::steady_clock::now();
+		Level level;
+		level.spacing = spacing;
+		refine(image, guessed_mask.data(), iterations, width,
+			   height, step, min_x, min_y, spacing,
+			   spacing == INITIAL_SPACING, level);
+		if (spacing > 1)
+			fillPreview(image, width, height, spacing);
+		finish(level, level_start);
+	}
+
+	if (exact)
+	{
+		const auto level_start = std::chrono::steady_clock::now();
+		Level level;
+		level.spacing = 1;
+		level.exact = true;
+		int64_t computed = 0, corrected = 0;
+		unsigned char *const mask = guessed_mask.data();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, mask, iterations)                          \
+	shared(width, height, step, min_x, min_y)                      \
+	reduction(+ : computed, corrected)
+#endif
+		for (int row = 0; row < height; row++)
+			for (int col = 0; col < width; col++)
+			{
+				const int pos = row * width + col;
+				if (!mask[pos])
+					continue;
+				const int escape = computePixel(
+					row, col, step, min_x, min_y, iterations);
+				corrected += escape != image[pos];
+				image[pos] = escape;
+				computed++;
+			}
+		level.computed = computed;
+		level.corrected = corrected;
+		finish(level, level_start);
+	}
+	stats.callback_seconds = callback_seconds;
+	return stats;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Levels,Exact Pass,Computed Pixels,Guessed Pixels,"
+		   "Guessed Fraction,Corrected Pixels,First Level (s),"
+		   "Callbacks (s)";
+}
+
+std::string csvColumns(const Stats &stats)
+{
+	const bool exact =
+		!stats.levels.empty() && stats.levels.back().exact;
+	const double guessed_fraction =
+		stats.pixels > 0
+			? static_cast<double>(stats.guessed()) / stats.pixels
+			: 0.0;
+	std::ostringstream columns;
+	columns << "," << stats.levels.size() - (exact ? 1 : 0) << ","
+			<< (exact ? "on" : "off") << "," << stats.computed()
+			<< "," << stats.guessed() << "," << guessed_fraction
+			<< ",";
+	if (exact)
+		columns << stats.corrected();
+	columns << "," << stats.firstLevelSeconds() << ","
+			<< stats.callback_seconds;
+	return columns.str();
+}
+
+std::string describe(const Stats &stats)
+{
+	std::ostringstream text;
+	for (const Level &level : stats.levels)
+	{
+		if (level.exact)
+			text << "\tExact pass:\t" << level.computed
+				 << "\tcomputed\tCorrected:\t" << level.corrected;
+		else
+			text << "\tLevel:\t" << level.spacing << "\tComputed:\t"
+				 << level.computed << "\tGuessed:\t"
+				 << level.guessed;
+		text << "\tTime:\t" << level.seconds
+			 << "\tseconds\tElapsed:\t" << level.elapsed
+			 << "\tseconds" << std::endl;
+	}
+	text << "\tCallbacks:\t" << stats.callback_seconds
+		 << "\tseconds";
+	return text.str();
+}
+} // namespace progressive
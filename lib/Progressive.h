@@ -0,0 +1,86 @@
+// Progressive.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace progressive
+{
+// Pixel spacing of the first level, halved at every level down to 1
+constexpr int INITIAL_SPACING = 16;
+
+/**
+ * @brief One refinement of the image.
+ */
+struct Level
+{
+	// Every `spacing`-th pixel is known, 1 for the full resolution
+	int spacing = 0;
+	// The final pass recomputing the guessed pixels
+	bool exact = false;
+	int64_t computed = 0;
+	int64_t guessed = 0;
+	// Pixels the exact pass found guessed wrong
+	int64_t corrected = 0;
+	double seconds = 0.0;
+	// Since the start of the render, callbacks excluded
+	double elapsed = 0.0;
+};
+
+/**
+ * @brief Called with the complete image after every level. Pixels
+ * between the known ones repeat the known pixel above and to the
+ * left of them. The image is only valid during the call.
+ */
+using LevelCallback =
+	std::function<void(const int *image, const Level &)>;
+
+struct Stats
+{
+	std::vector<Level> levels;
+	int64_t pixels = 0;
+	double callback_seconds = 0.0;
+
+	int64_t computed() const;
+	// Pixels guessed over the levels, recomputed by the exact pass
+	// if there is one
+	int64_t guessed() const;
+	int64_t corrected() const;
+	// Time to the first complete image
+	double firstLevelSeconds() const
+	{
+		return levels.empty() ? 0.0 : levels.front().elapsed;
+	}
+};
+
+/**
+ * @brief Renders the image coarse to fine with solid guessing.
+ *
+ * The first level computes every `INITIAL_SPACING`-th pixel of
+ * every `INITIAL_SPACING`-th row. Every following level halves the
+ * spacing: a new pixel lies in a cell of the previous level, and if
+ * the four corners of that cell have the same escape time the pixel
+ * is guessed to have it too; otherwise, or at the image edge, it is
+ * computed with `kernels::escapeTime`. Guessed pixels are corners
+ * of the next level like computed ones. With `exact`, a final pass
+ * recomputes every guessed pixel, so the image is that of
+ * `kernels::computeOpenMP`; without it, features thinner than a
+ * cell can be missed. Every level is a `schedule(runtime)` loop
+ * over its rows.
+ *
+ * @param image Output, `width * height` escape times.
+ * @param callback Optional, called after every level.
+ */
+Stats render(int *image, int iterations, int width, int height,
+			 float step, float min_x, float min_y, bool exact,
+			 kernels::Schedule schedule,
+			 const LevelCallback &callback = nullptr);
+
+// ",Levels,Exact Pass,Computed Pixels,Guessed Pixels,..."
+std::string csvHeaderColumns();
+std::string csvColumns(const Stats &stats);
+// One tab separated line per level for the log
+std::string describe(const Stats &stats);
+} // namespace progressive
@@ -0,0 +1,66 @@
+// Random.h
+#pragma once
+#include <cstdint>
+
+namespace rng
+{
+// Weyl increment of SplitMix64, also used to separate the streams
+constexpr uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ull;
+
+/**
+ * @brief Output function of SplitMix64.
+ */
+inline uint64_t mix(uint64_t z)
+{
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+/**
+ * @brief The top 53 bits as a double in [0, 1).
+ */
+inline double toUniform(uint64_t bits)
+{
+	return (bits >> 11) * 0x1.0p-53;
+}
+
+/**
+ * @brief Starting state of stream `stream` of a seed.
+ */
+inline uint64_t streamState(uint64_t seed, uint64_t stream)
+{
+	return seed ^ (GOLDEN_GAMMA * (stream + 1));
+}
+
+/**
+ * @brief A single value in [0, 1) for a stream, without a
+ * generator: its starting state mixed once.
+ */
+inline double hashUniform(uint64_t seed, uint64_t stream)
+{
+	return toUniform(mix(streamState(seed, stream)));
+}
+
+/**
+ * @brief SplitMix64, one independent sequence per stream. Threads
+ * that own disjoint streams draw reproducibly whatever the
+ * schedule.
+ */
+class SplitMix64
+{
+  public:
+	SplitMix64(uint64_t seed, uint64_t stream)
+		: state(streamState(seed, stream))
+	{
+	}
+
+	uint64_t next() { return mix(state += GOLDEN_GAMMA); }
+
+	// Uniform in [0, 1)
+	double uniform() { return toUniform(next()); }
+
+  private:
+	uint64_t state;
+};
+} // namespace rng
@@ -0,0 +1,192 @@
+#include "Supersample.h"
+
+#include <DistanceEstimator.h>
+#include <Random.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <sstream>
+#include <vector>
+
+namespace supersample
+{
+namespace
+{
+// Hash of the seed, the pixel and the subsample, in [0, 1)
+double jitter(uint64_t seed, int64_t pixel, int sample)
+{
+	const uint64_t stream =
+		static_cast<uint64_t>(pixel) * 2 * MAX_SAMPLES_PER_PIXEL +
+		sample;
+	return rng::hashUniform(seed, stream);
+}
+
+// Variance of the executed iterations of the pixel and its
+// neighbours
+double neighbourhoodVariance(const int *escape, int row, int col,
+							 int width, int height, int iterations)
+{
+	double sum = 0.0, squares = 0.0;
+	int count = 0;
+	for (int r = std::max(row - 1, 0);
+		 r <= std::min(row + 1, height - 1); r++)
+		for (int c = std::max(col - 1, 0);
+			 c <= std::min(col + 1, width - 1); c++)
+		{
+			const double value = kernels::executedIterations(
+				escape[r * width + c], iterations);
+			sum += value;
+			squares += value * value;
+			count++;
+		}
+	const double mean = sum / count;
+	return squares / count - mean * mean;
+}
+} // namespace
+
+Stats render(int *escape, float *image, int iterations, int width,
+			 int height, float step, float min_x, float min_y,
+			 int samples_per_pixel, uint64_t seed,
+			 kernels::Schedule schedule)
+{
+	const int64_t pixels = static_cast<int64_t>(width) * height;
+	const int grid =
+		static_cast<int>(std::lround(std::sqrt(samples_per_pixel)));
+	kernels::installSchedule(schedule);
+
+	const auto base_start = std::chrono::steady_clock::now();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(escape, image, iterations)                        \
+		shared(width, height, step, min_x, min_y)
+#endif
+	for (int row = 0; row < height; row++)
+		for (int col = 0; col < width; col++)
+		{
+			const std::complex<double> c =
+				kernels::pixelPoint(row, col, step, min_x, min_y);
+			escape[row * width + col] =
+				kernels::escapeTime(c, iterations);
+			image[row * width + col] =
+				static_cast<float>(escape[row * width + col]);
+		}
+	const auto detect_start = std::chrono::steady_clock::now();
+
+	// Pixels to refine, per row and then in image order
+	std::vector<std::vector<int64_t>> row_refined(height);
+	const double distance_limit =
+		DISTANCE_THRESHOLD * static_cast<double>(step);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(escape, iterations)                               \
+		shared(row_refined, width, height, step, min_x, min_y,     \
+			   distance_limit)
+#endif
+	for (int row = 0; row < height; row++)
+		for (int col = 0; col < width; col++)
+		{
+			const int64_t pos =
+				static_cast<int64_t>(row) * width + col;
+			bool refine = neighbourhoodVariance(
+							  escape, row, col, width, height,
+							  iterations) > VARIANCE_THRESHOLD;
+			// Bounded pixels have no estimate, escaping ones are
+			// followed again with the derivative, cheap out there
+			if (!refine && escape[pos] != 0)
+			{
+				const std::complex<double> c = kernels::pixelPoint(
+					row, col, step, min_x, min_y);
+				refine = distance::exteriorDistance(
+							 c, escape[pos]) < distance_limit;
+			}
+			if (refine)
+				row_refined[row].push_back(pos);
+		}
+	std::vector<int64_t> refined;
+	for (const std::vector<int64_t> &row : row_refined)
+		refined.insert(refined.end(), row.begin(), row.end());
+	const int64_t refined_count =
+		static_cast<int64_t>(refined.size());
+	const auto refine_start = std::chrono::steady_clock::now();
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, iterations, seed, grid)                    \
+		shared(refined, refined_count, width, step, min_x, min_y)
+#endif
+	for (int64_t k = 0; k < refined_count; k++)
+	{
+		const int64_t pos = refined[k];
+		const int row = static_cast<int>(pos / width);
+		const int col = static_cast<int>(pos % width);
+		// The pixel spans half a step around its base point
+		const double x0 =
+			min_x + (col - 0.5) * static_cast<double>(step);
+		const double y0 =
+			min_y + (row - 0.5) * static_cast<double>(step);
+		const double cell = static_cast<double>(step) / grid;
+		int64_t sum = 0;
+		for (int sample = 0; sample < grid * grid; sample++)
+		{
+			const std::complex<double> c(
+				x0 + (sample % grid +
+					  jitter(seed, pos, 2 * sample)) *
+						 cell,
+				y0 + (sample / grid +
+					  jitter(seed, pos, 2 * sample + 1)) *
+						 cell);
+			sum += kernels::escapeTime(c, iterations);
+		}
+		image[pos] = static_cast<float>(static_cast<double>(sum) /
+										(grid * grid));
+	}
+	const auto refine_end = std::chrono::steady_clock::now();
+
+	Stats stats;
+	stats.pixels = pixels;
+	stats.refined = refined_count;
+	stats.samples_per_pixel = grid * grid;
+	stats.base_seconds =
+		std::chrono::duration<double>(detect_start - base_start)
+			.count();
+	stats.detect_seconds =
+		std::chrono::duration<double>(refine_start - detect_start)
+			.count();
+	stats.refine_seconds =
+		std::chrono::duration<double>(refine_end - refine_start)
+			.count();
+	return stats;
+}
+
+std::string csvHeaderColumns()
+{
+	return ",Samples Per Pixel,Refined Pixels,Refined Fraction,"
+		   "Base (s),Detect (s),Refine (s),Sample Cost,Time Cost";
+}
+
+std::string csvColumns(const Stats &stats)
+{
+	std::ostringstream columns;
+	columns << "," << stats.samples_per_pixel << ","
+			<< stats.refined << "," << stats.refinedFraction()
+			<< "," << stats.base_seconds << ","
+			<< stats.detect_seconds << "," << stats.refine_seconds
+			<< "," << stats.sampleCost() << "," << stats.timeCost();
+	return columns.str();
+}
+
+std::string describe(const Stats &stats)
+{
+	std::ostringstream text;
+	text << "\tSamples per pixel:\t" << stats.samples_per_pixel
+		 << "\tRefined:\t" << stats.refined << "\t("
+		 << 100.0 * stats.refinedFraction() << "\t%)\tBase:\t"
+		 << stats.base_seconds << "\tseconds\tDetect:\t"
+		 << stats.detect_seconds << "\tseconds\tRefine:\t"
+		 << stats.refine_seconds << "\tseconds\tSample cost:\t"
+		 << stats.sampleCost() << "\tTime cost:\t"
+		 << stats.timeCost();
+	return text.str();
+}
+} // namespace supersample
@@ -0,0 +1,101 @@
+// Supersample.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <cstdint>
+#include <string>
+
+namespace supersample
+{
+/**
+ * @brief Variance of the executed iterations over a pixel's 3 x 3
+ * neighbourhood above which the pixel is refined. Neighbouring
+ * bands of the exterior differ by one iteration and stay below it;
+ * the filaments, where neighbours differ by tens of iterations or
+ * are bounded, are above.
+ */
+constexpr double VARIANCE_THRESHOLD = 4.0;
+
+/**
+ * @brief Distance estimate, in pixel widths, below which an
+ * escaping pixel is refined: the boundary may cross the pixel.
+ */
+constexpr double DISTANCE_THRESHOLD = 1.0;
+
+// Subsamples of a refined pixel, an 8 x 8 grid
+constexpr int MAX_SAMPLES_PER_PIXEL = 64;
+
+struct Stats
+{
+	int64_t pixels = 0;
+	// Pixels whose value is the mean of their subsamples
+	int64_t refined = 0;
+	int samples_per_pixel = 0;
+	double base_seconds = 0.0;
+	double detect_seconds = 0.0;
+	double refine_seconds = 0.0;
+
+	double refinedFraction() const
+	{
+		return pixels > 0 ? static_cast<double>(refined) / pixels
+						  : 0.0;
+	}
+	// Points iterated over those of a full supersample
+	double sampleCost() const
+	{
+		return pixels > 0 && samples_per_pixel > 0
+				   ? static_cast<double>(
+						 pixels + refined * samples_per_pixel) /
+						 (static_cast<double>(pixels) *
+						  samples_per_pixel)
+				   : 0.0;
+	}
+	/**
+	 * @brief Time over that of a full supersample, estimated as
+	 * `samples_per_pixel` base passes.
+	 */
+	double timeCost() const
+	{
+		return base_seconds > 0.0 && samples_per_pixel > 0
+				   ? (base_seconds + detect_seconds +
+					  refine_seconds) /
+						 (base_seconds * samples_per_pixel)
+				   : 0.0;
+	}
+};
+
+/**
+ * @brief Renders the image and supersamples the pixels that need
+ * it.
+ *
+ * The base pass computes every pixel with `kernels::escapeTime` at
+ * the float coordinates of the engines, so `escape` is the image of
+ * `kernels::computeOpenMP`. A pixel is then refined if the
+ * iteration variance of its neighbourhood exceeds
+ * `VARIANCE_THRESHOLD` or, for an escaping pixel, its
+ * `distance::exteriorDistance` is below `DISTANCE_THRESHOLD`
+ * pixels. A refined pixel is the mean escape time of
+ * `samples_per_pixel` jittered subsamples, one per cell of a square
+ * grid over the pixel, iterated in double. The jitter comes from
+ * `seed` and the pixel index, so the image does not depend on the
+ * thread count. Every pass is an OpenMP loop; the refined pixels
+ * are listed first and shared with `schedule(runtime)`, so the
+ * threads split the expensive ones evenly.
+ *
+ * @param escape Output, `width * height` escape times of the base
+ * pass.
+ * @param image Output, `width * height` mean escape times, bounded
+ * points counting 0 like in the integer image.
+ * @param samples_per_pixel A square number, 4 to
+ * `MAX_SAMPLES_PER_PIXEL`.
+ */
+Stats render(int *escape, float *image, int iterations, int width,
+			 int height, float step, float min_x, float min_y,
+			 int samples_per_pixel, uint64_t seed,
+			 kernels::Schedule schedule);
+
+// ",Samples Per Pixel,Refined Pixels,Refined Fraction,..."
+std::string csvHeaderColumns();
+std::string csvColumns(const Stats &stats);
+// One tab separated line for the log
+std::string describe(const Stats &stats);
+} // namespace supersample
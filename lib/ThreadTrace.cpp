@@ -0,0 +1,161 @@
+#include "ThreadTrace.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace threadtrace
+{
+Recorder::Recorder(int threads, bool enabled,
+				   size_t max_events_per_thread)
+	: active(enabled), max_events(max_events_per_thread),
+	  epoch(std::chrono::steady_clock::now()),
+	  buffers(threads > 0 ? threads : 1)
+{
+	if (!active)
+		return;
+	for (Buffer &buffer : buffers)
+		buffer.events.reserve(std::min<size_t>(max_events, 1024));
+}
+
+void Recorder::record(int thread, const Chunk &chunk)
+{
+	Buffer &buffer = buffers[thread];
+	buffer.chunks++;
+	buffer.pixels += chunk.count;
+	buffer.iterations += chunk.iterations;
+	buffer.busy += chunk.end - chunk.start;
+	if (buffer.events.size() < max_events)
+	{
+		buffer.events.push_back(chunk);
+		return;
+	}
+	// Out of budget, the last event absorbs the chunk
+	Chunk &last = buffer.events.back();
+	last.count += chunk.count;
+	last.iterations += chunk.iterations;
+	last.chunks++;
+	last.end = chunk.end;
+}
+
+void Recorder::regionBegin() { region_start = now(); }
+
+void Recorder::regionEnd()
+{
+	region_seconds += now() - region_start;
+}
+
+std::vector<ThreadSummary> Recorder::threadSummaries() const
+{
+	std::vector<ThreadSummary> summaries;
+	for (size_t t = 0; t < buffers.size(); t++)
+	{
+		const Buffer &buffer = buffers[t];
+		ThreadSummary summary;
+		summary.thread = static_cast<int>(t);
+		summary.chunks = buffer.chunks;
+		summary.pixels = buffer.pixels;
+		summary.iterations = buffer.iterations;
+		summary.busy = buffer.busy;
+		summary.idle = std::max(0.0, region_seconds - buffer.busy);
+		summaries.push_back(summary);
+	}
+	return summaries;
+}
+
+std::string Recorder::traceEvents(int pid) const
+{
+	std::ostringstream json;
+	json << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":"
+		 << pid << ",\"args\":{\"name\":\"rank " << pid << "\"}}";
+	for (size_t t = 0; t < buffers.size(); t++)
+	{
+		json << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"
+			 << pid << ",\"tid\":" << t
+			 << ",\"args\":{\"name\":\"thread " << t << "\"}}";
+		for (const Chunk &chunk : buffers[t].events)
+		{
+			// Trace timestamps are microseconds
+			json << ",\n{\"name\":\"chunk\",\"cat\":\"compute\","
+					"\"ph\":\"X\",\"pid\":"
+				 << pid << ",\"tid\":" << t
+				 << ",\"ts\":" << chunk.start * 1e6
+				 << ",\"dur\":" << (chunk.end - chunk.start) * 1e6
+				 << ",\"args\":{\"first\":" << chunk.first
+				 << ",\"count\":" << chunk.count
+				 << ",\"iterations\":" << chunk.iterations
+				 << ",\"chunks\":" << chunk.chunks << "}}";
+		}
+	}
+	return json.str();
+}
+
+Summary summarize(const std::vector<ThreadSummary> &threads)
+{
+	Summary summary;
+	summary.threads = static_cast<int>(threads.size());
+	double busy_sum = 0.0;
+	for (const ThreadSummary &thread : threads)
+	{
+		summary.chunks += thread.chunks;
+		summary.iterations += thread.iterations;
+		summary.max_busy = std::max(summary.max_busy, thread.busy);
+		busy_sum += thread.busy;
+	}
+	if (summary.threads > 0)
+		summary.mean_busy = busy_sum / summary.threads;
+	if (summary.mean_busy > 0.0)
+		summary.imbalance_ratio =
+			summary.max_busy / summary.mean_busy;
+	return summary;
+}
+
+std::string describe(const Summary &summary,
+					 const std::vector<ThreadSummary> &threads,
+					 const std::string &label)
+{
+	std::ostringstream text;
+	text << "\tThreads:\t" << summary.threads << "\tChunks:\t"
+		 << summary.chunks << "\tTotal iterations:\t"
+		 << summary.iterations << "\tMax busy:\t"
+		 << summary.max_busy << "\tMean busy:\t"
+		 << summary.mean_busy << "\tImbalance ratio:\t"
+		 << summary.imbalance_ratio << "\n";
+	for (const ThreadSummary &thread : threads)
+	{
+		text << "\t\t" << label << " " << thread.thread
+			 << ":\tChunks:\t" << thread.chunks << "\tPixels:\t"
+			 << thread.pixels << "\tIterations:\t"
+			 << thread.iterations << "\tBusy:\t" << thread.busy
+			 << "\tIdle:\t" << thread.idle << "\n";
+	}
+	return text.str();
+}
+
+bool writeChromeTrace(const std::string &path,
+					  const std::vector<std::string> &event_blocks)
+{
+	const std::filesystem::path trace_path(path);
+	if (trace_path.has_parent_path())
+	{
+		std::error_code error;
+		std::filesystem::create_directories(
+			trace_path.parent_path(), error);
+	}
+	std::ofstream trace(path, std::ios::trunc);
+	if (!trace.is_open())
+		return false;
+	trace << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	bool first = true;
+	for (const std::string &block : event_blocks)
+	{
+		if (block.empty())
+			continue;
+		trace << (first ? "" : ",\n") << block;
+		first = false;
+	}
+	trace << "\n]}\n";
+	return trace.good();
+}
+} // namespace threadtrace
@@ -0,0 +1,192 @@
+// ThreadTrace.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace threadtrace
+{
+/**
+ * @brief A run of consecutive pixels computed by one thread.
+ *
+ * Times are seconds since the recorder was created. Once a thread
+ * has used up its event budget further chunks are merged into its
+ * last event, `chunks` counts how many scheduling chunks an event
+ * stands for.
+ */
+struct Chunk
+{
+	int64_t first = 0;
+	int64_t count = 0;
+	int64_t iterations = 0;
+	int64_t chunks = 1;
+	double start = 0.0;
+	double end = 0.0;
+};
+
+/**
+ * @brief What one thread did over all recorded regions.
+ */
+struct ThreadSummary
+{
+	int thread = 0;
+	int64_t chunks = 0;
+	int64_t pixels = 0;
+	int64_t iterations = 0;
+	double busy = 0.0;
+	// Region wall time not spent inside a chunk
+	double idle = 0.0;
+};
+
+/**
+ * @brief Team level view of a set of thread summaries.
+ */
+struct Summary
+{
+	int threads = 0;
+	int64_t chunks = 0;
+	int64_t iterations = 0;
+	double max_busy = 0.0;
+	double mean_busy = 0.0;
+	// Slowest thread busy time over the mean, 1 is perfect balance
+	double imbalance_ratio = 0.0;
+};
+
+/**
+ * @brief Per-thread chunk buffers of a fixed team.
+ *
+ * Every thread only touches its own cache line aligned buffer, so
+ * recording needs neither locks nor atomics; the buffers are read
+ * once the parallel regions are over. A disabled recorder records
+ * nothing and costs a single branch in the kernels.
+ */
+class Recorder
+{
+  public:
+	Recorder(int threads, bool enabled,
+			 size_t max_events_per_thread = 16384);
+
+	bool enabled() const { return active; }
+	int threads() const { return static_cast<int>(buffers.size()); }
+
+	// Seconds since the recorder was created
+	double now() const
+	{
+		return std::chrono::duration<double>(
+				   std::chrono::steady_clock::now() - epoch)
+			.count();
+	}
+
+	// Called only by `thread`
+	void record(int thread, const Chunk &chunk);
+
+	// Brackets a parallel region, the idle time of each thread is
+	// the accumulated region time minus its busy time
+	void regionBegin();
+	void regionEnd();
+
+	std::vector<ThreadSummary> threadSummaries() const;
+
+	/**
+	 * @brief Chrome trace events of every thread, comma separated
+	 * JSON objects without the surrounding array.
+	 *
+	 * @param pid Process id of the timeline, e.g. the MPI rank.
+	 */
+	std::string traceEvents(int pid) const;
+
+  private:
+	struct alignas(64) Buffer
+	{
+		std::vector<Chunk> events;
+		int64_t chunks = 0;
+		int64_t pixels = 0;
+		int64_t iterations = 0;
+		double busy = 0.0;
+	};
+
+	bool active;
+	size_t max_events;
+	std::chrono::steady_clock::time_point epoch;
+	std::vector<Buffer> buffers;
+	double region_start = 0.0;
+	double region_seconds = 0.0;
+};
+
+/**
+ * @brief Merges scheduling chunks of one thread inside a parallel
+ * loop.
+ *
+ * A chunk starts whenever the loop index is not the successor of
+ * the previous one, which is how OpenMP hands out static, dynamic
+ * and guided chunks. The clock is only read at chunk boundaries;
+ * the last chunk is recorded by the destructor, i.e. at the end of
+ * the thread's share of the loop.
+ */
+class ChunkTracker
+{
+  public:
+	ChunkTracker(Recorder &recorder, int thread)
+		: recorder(recorder), thread(thread)
+	{
+	}
+	~ChunkTracker() { close(); }
+
+	inline void add(int64_t pos, int64_t iterations)
+	{
+		if (pos != next || current.count == 0)
+		{
+			close();
+			current.first = pos;
+			current.start = recorder.now();
+		}
+		next = pos + 1;
+		current.count++;
+		current.iterations += iterations;
+	}
+
+  private:
+	void close()
+	{
+		if (current.count == 0)
+			return;
+		current.end = recorder.now();
+		recorder.record(thread, current);
+		current = Chunk();
+	}
+
+	Recorder &recorder;
+	int thread;
+	int64_t next = -1;
+	Chunk current;
+};
+
+/**
+ * @brief Summarises the threads of one or more teams.
+ */
+Summary summarize(const std::vector<ThreadSummary> &threads);
+
+/**
+ * @brief Tab separated log lines, a team line followed by one line
+ * per thread.
+ *
+ * @param label Prefix of the per-thread lines, e.g. "Thread" or
+ * "Rank 1 thread".
+ */
+std::string describe(const Summary &summary,
+					 const std::vector<ThreadSummary> &threads,
+					 const std::string &label = "Thread");
+
+/**
+ * @brief Writes a Chrome trace-event JSON file (chrome://tracing or
+ * https://ui.perfetto.dev).
+ *
+ * @param path The JSON file.
+ * @param event_blocks Output of `Recorder::traceEvents`, one block
+ * per process.
+ * @return `false` if the file could not be written.
+ */
+bool writeChromeTrace(const std::string &path,
+					  const std::vector<std::string> &event_blocks);
+} // namespace threadtrace
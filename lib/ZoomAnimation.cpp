@@ -0,0 +1,135 @@
+#include "ZoomAnimation.h"
+
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <fstream>
+
+namespace animation
+{
+int reuseFactor(double zoom_factor)
+{
+	if (zoom_factor < 2.0 ||
+		zoom_factor != std::floor(zoom_factor) ||
+		zoom_factor > 1 << 30)
+		return 0;
+	const int factor = static_cast<int>(zoom_factor);
+	return (factor & (factor - 1)) == 0 ? factor : 0;
+}
+
+int64_t renderFrame(int *image, int iterations, int width,
+					int height, const Frame &frame,
+					kernels::Schedule schedule, const int *previous,
+					int factor)
+{
+	const bool reuse = previous != nullptr && factor > 1;
+	const int center_col = width / 2, center_row = height / 2;
+	int64_t reused = 0;
+	kernels::installSchedule(schedule);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(runtime) default(none)           \
+	firstprivate(image, iterations, previous, factor, reuse)       \
+	shared(width, height, frame, center_col, center_row)           \
+	reduction(+ : reused)
+#endif
+	for (int pos = 0; pos < height * width; pos++)
+	{
+		const int dx = pos % width - center_col;
+		const int dy = pos / width - center_row;
+		if (reuse && dx % factor == 0 && dy % factor == 0)
+		{
+			image[pos] =
+				previous[(center_row + dy / factor) * width +
+						 center_col + dx / factor];
+			reused++;
+			continue;
+		}
+		const std::complex<double> c(
+			frame.center_x + dx * frame.step,
+			frame.center_y + dy * frame.step);
+		image[pos] = kernels::escapeTime(c, iterations);
+	}
+	return reused;
+}
+
+bool writeFrame(const std::string &path, const int *image,
+				int width, int height)
+{
+	std::ofstream out(path, std::ios::trunc);
+	if (!out.is_open())
+		return false;
+	for (int row = 0; row < height; row++)
+	{
+		for (int col = 0; col < width; col++)
+		{
+			out << image[row * width + col];
+			if (col < width - 1)
+				out << ',';
+		}
+		if (row < height - 1)
+			out << '\n';
+	}
+	return static_cast<bool>(out);
+}
+
+Writer::Writer(int width, int height, size_t depth)
+	: width(width), height(height), depth(depth > 0 ? depth : 1),
+	  thread(&Writer::run, this)
+{
+}
+
+Writer::~Writer()
+{
+	if (thread.joinable())
+		finish();
+}
+
+void Writer::push(std::shared_ptr<const std::vector<int>> image,
+				  const std::string &path)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	changed.wait(lock, [this] { return queue.size() < depth; });
+	queue.push_back(Job{std::move(image), path});
+	changed.notify_all();
+}
+
+std::vector<double> Writer::finish()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		closing = true;
+	}
+	changed.notify_all();
+	if (thread.joinable())
+		thread.join();
+	return write_seconds;
+}
+
+void Writer::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		changed.wait(lock,
+					 [this] { return closing || !queue.empty(); });
+		if (queue.empty())
+			return;
+		// The job stays queued while it is written, so `depth`
+		// counts it and the caller cannot run further ahead
+		const Job job = queue.front();
+		lock.unlock();
+		const auto start = std::chrono::steady_clock::now();
+		const bool written =
+			writeFrame(job.path, job.image->data(), width, height);
+		const double seconds =
+			std::chrono::duration<double>(
+				std::chrono::steady_clock::now() - start)
+				.count();
+		lock.lock();
+		queue.pop_front();
+		write_seconds.push_back(seconds);
+		write_failed = write_failed || !written;
+		changed.notify_all();
+	}
+}
+} // namespace animation
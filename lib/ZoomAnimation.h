@@ -0,0 +1,113 @@
+// ZoomAnimation.h
+#pragma once
+#include <MandelbrotKernels.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace animation
+{
+/**
+ * @brief Grid of one frame.
+ *
+ * Pixel (row, col) of a `width * height` frame maps to
+ * (center_x + (col - width / 2) * step,
+ *  center_y + (row - height / 2) * step), in double. Unlike the
+ * min + col * step mapping of the single images, the centre is a
+ * pixel of every frame, which is what lets zoomed frames share
+ * pixels.
+ */
+struct Frame
+{
+	double center_x = 0.0;
+	double center_y = 0.0;
+	double step = 0.0;
+};
+
+/**
+ * @brief Factor f such that every f-th pixel of the next frame
+ * lands exactly on the grid of the previous one, 0 if the zoom
+ * factor does not allow reuse.
+ *
+ * Only integer powers of two qualify: dividing the step by them is
+ * exact, so a shared pixel gets the same double coordinates in both
+ * frames and therefore the same escape time.
+ */
+int reuseFactor(double zoom_factor);
+
+/**
+ * @brief Computes a frame with a `schedule(runtime)` loop.
+ *
+ * @param previous The frame before, `factor` times coarser around
+ * the same centre; its pixels are copied where the grids coincide.
+ * May be null, then every pixel is computed.
+ * @return Pixels copied from `previous`.
+ */
+int64_t renderFrame(int *image, int iterations, int width,
+					int height, const Frame &frame,
+					kernels::Schedule schedule,
+					const int *previous = nullptr, int factor = 0);
+
+/**
+ * @brief Writes a frame in the engines' text format: one line per
+ * row, comma separated escape times.
+ *
+ * @return `false` if the file could not be written.
+ */
+bool writeFrame(const std::string &path, const int *image,
+				int width, int height);
+
+/**
+ * @brief Writes frames on a thread of its own while the next ones
+ * are computed.
+ *
+ * At most `depth` frames wait for the writer, `push` blocks while
+ * the queue is full, so memory stays bounded at `depth` frames plus
+ * the ones the caller holds.
+ */
+class Writer
+{
+  public:
+	Writer(int width, int height, size_t depth);
+	~Writer();
+
+	Writer(const Writer &) = delete;
+	Writer &operator=(const Writer &) = delete;
+
+	void push(std::shared_ptr<const std::vector<int>> image,
+			  const std::string &path);
+	/**
+	 * @brief Waits for every queued frame and stops the thread.
+	 *
+	 * @return Write time of every frame, in push order.
+	 */
+	std::vector<double> finish();
+	// Whether one of the frames could not be written
+	bool failed() const { return write_failed; }
+
+  private:
+	struct Job
+	{
+		std::shared_ptr<const std::vector<int>> image;
+		std::string path;
+	};
+
+	void run();
+
+	const int width;
+	const int height;
+	const size_t depth;
+	std::deque<Job> queue;
+	std::vector<double> write_seconds;
+	std::mutex mutex;
+	std::condition_variable changed;
+	bool closing = false;
+	bool write_failed = false;
+	std::thread thread;
+};
+} // namespace animation
@@ -0,0 +1,91 @@
+'''
+Reader for the binary image format written by lib/ImageIO.
+
+- A .mbin file holds a band of rows: 4 byte magic "MBI1", then int32
+  width, rows, first row and full image height, then the int32 escape
+  counts in row major order.
+- A .manifest file lists the shards written by the MPI ranks with
+  --sharded-output. It is opened as one logical image, no merge step
+  is needed.
+'''
+
+import os
+import numpy as np
+
+MAGIC = b'MBI1'
+HEADER_SIZE = 20
+
+
+def read_header(path):
+    with open(path, 'rb') as f:
+        header = f.read(HEADER_SIZE)
+    if len(header) != HEADER_SIZE or header[:4] != MAGIC:
+        raise ValueError(f'Not a binary image: {path}')
+    width, rows, first_row, height = np.frombuffer(header[4:], dtype=np.int32)
+    return int(width), int(rows), int(first_row), int(height)
+
+
+def read_manifest(path):
+    info = {'width': 0, 'height': 0, 'iterations': 0, 'shards': []}
+    base = os.path.dirname(path)
+    with open(path) as f:
+        for line in f:
+            fields = line.split()
+            if not fields:
+                continue
+            if fields[0] in ('width', 'height', 'iterations'):
+                info[fields[0]] = int(fields[1])
+            elif fields[0] == 'shard':
+                info['shards'].append({
+                    'path': os.path.join(base, fields[1]),
+                    'first_row': int(fields[2]),
+                    'row_count': int(fields[3]),
+                })
+    info['shards'].sort(key=lambda shard: shard['first_row'])
+    return info
+
+
+class LogicalImage:
+    '''A binary file or a shard manifest seen as one (height, width) image.
+
+    Shards are memory mapped, rows are only read when they are accessed.
+    '''
+
+    def __init__(self, path):
+        if path.endswith('.manifest'):
+            info = read_manifest(path)
+            self.width, self.height = info['width'], info['height']
+            shards = info['shards']
+        else:
+            width, rows, first_row, height = read_header(path)
+            self.width, self.height = width, height
+            shards = [{'path': path, 'first_row': first_row, 'row_count': rows}]
+        self.shards = []
+        for shard in shards:
+            rows = np.memmap(shard['path'], dtype=np.int32, mode='r',
+                             offset=HEADER_SIZE,
+                             shape=(shard['row_count'], self.width))
+            self.shards.append((shard['first_row'], rows))
+
+    @property
+    def shape(self):
+        return (self.height, self.width)
+
+    def rows(self, first_row, row_count):
+        out = np.zeros((row_count, self.width), dtype=np.int32)
+        last_row = first_row + row_count
+        for shard_first, data in self.shards:
+            begin = max(first_row, shard_first)
+            end = min(last_row, shard_first + data.shape[0])
+            if begin < end:
+                out[begin - first_row:end - first_row] = \
+                    data[begin - shard_first:end - shard_first]
+        return out
+
+    def to_array(self):
+        return self.rows(0, self.height)
+
+
+def read_image(path):
+    '''Loads a .mbin file or a shard manifest into a numpy array.'''
+    return LogicalImage(path).to_array()
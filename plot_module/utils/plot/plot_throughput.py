@@ -0,0 +1,89 @@
+'''
+Kernel efficiency plots from the engine CSVs.
+
+Rows written since the executed-iteration columns were added carry
+"Executed Iterations", "GIterations/s" and "GFLOP/s"; older rows
+are skipped; files whose schema changed hold one header line per
+schema. The escape-time histograms come from the *_hist_.csv files.
+'''
+
+import glob
+import io
+import os
+
+import matplotlib.pyplot as plt
+import pandas as pd
+
+DATA = './data/'
+IMAGES = './report/images/'
+
+
+def read_engine_csv(path):
+    # A header line is repeated whenever the schema changed, every
+    # section is parsed with its own header
+    sections, lines = [], []
+    with open(path) as f:
+        for line in f:
+            if line.startswith('DateTime,') and lines:
+                sections.append(lines)
+                lines = []
+            lines.append(line)
+    if lines:
+        sections.append(lines)
+    frames = [pd.read_csv(io.StringIO(''.join(section)), dtype=str)
+              for section in sections]
+    frames = [frame for frame in frames if 'GIterations/s' in frame.columns]
+    if not frames:
+        return pd.DataFrame()
+    frame = pd.concat(frames, ignore_index=True)
+    for column in frame.columns:
+        if column not in ('DateTime', 'Program', 'Scheduling', 'Engine'):
+            frame[column] = pd.to_numeric(frame[column], errors='coerce')
+    return frame
+
+
+def plot_openmp_throughput(frame, name):
+    for (iterations, resolution), group in frame.groupby(['Iterations', 'Resolution']):
+        plt.figure(figsize=(10, 6))
+        for scheduler, runs in group.groupby('Scheduling'):
+            rates = runs.groupby('Threads')['GIterations/s'].median()
+            plt.plot(rates.index, rates.values, marker='o', linestyle='-', label=scheduler)
+        plt.title(f'Throughput vs. Number of Threads - {iterations} iterations, resolution {resolution}')
+        plt.xlabel('Number of Threads')
+        plt.ylabel('GIterations/s')
+        plt.grid(True)
+        plt.tight_layout()
+        plt.legend()
+        plt.savefig(f'{IMAGES}throughput_{name}_{iterations}_{resolution}.png')
+        plt.close()
+
+
+def plot_histogram(path):
+    frame = pd.read_csv(path)
+    frame = frame[frame['DateTime'] != 'DateTime']
+    name = os.path.basename(path).replace('_hist_.csv', '')
+    for (program, iterations, resolution), group in frame.groupby(['Program', 'Iterations', 'Resolution']):
+        # Latest run of the configuration
+        latest = group[group['DateTime'] == group['DateTime'].iloc[-1]]
+        labels = ['bounded' if low == 0 else f'{low}-{high}'
+                  for low, high in zip(latest['Bucket Low'], latest['Bucket High'])]
+        plt.figure(figsize=(10, 6))
+        plt.bar(labels, latest['Pixels'].astype(int))
+        plt.yscale('log')
+        plt.title(f'Escape-time histogram - {program}, {iterations} iterations, resolution {resolution}')
+        plt.xlabel('Escape time')
+        plt.ylabel('Pixels')
+        plt.xticks(rotation=45)
+        plt.tight_layout()
+        plt.savefig(f'{IMAGES}histogram_{name}_{iterations}_{resolution}.png')
+        plt.close()
+
+
+if __name__ == '__main__':
+    os.makedirs(IMAGES, exist_ok=True)
+    for path in glob.glob(f'{DATA}*_openmp_.csv'):
+        frame = read_engine_csv(path)
+        if not frame.empty:
+            plot_openmp_throughput(frame, os.path.basename(path).replace('_.csv', ''))
+    for path in glob.glob(f'{DATA}*_hist_.csv'):
+        plot_histogram(path)
@@ -0,0 +1,344 @@
+#include <omp.h>
+
+#include <BenchStats.h>
+#include <EnergyProbe.h>
+#include <IterationStats.h>
+#include <LogUtils.h>
+#include <MandelbrotKernels.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace MandelbrotSet
+{
+// Ranges of the set
+constexpr float MIN_X = -2.0;
+constexpr float MAX_X = 1.0;
+constexpr float MIN_Y = -1.0;
+constexpr float MAX_Y = 1.0;
+
+// Image ratio
+constexpr float RATIO_X = (MAX_X - MIN_X);
+constexpr float RATIO_Y = (MAX_Y - MIN_Y);
+} // namespace MandelbrotSet
+namespace fs = std::filesystem;
+
+using namespace std;
+using namespace MandelbrotSet;
+
+struct BenchArgs
+{
+	string output_file;
+	vector<string> engines = {"openmp"};
+	vector<int> resolutions = {1000};
+	vector<int> iterations = {1000};
+	vector<int> threads = {omp_get_max_threads()};
+	vector<string> schedules = {"DYNAMIC"};
+	int warmup = 1;
+	int repeat = 5;
+};
+
+vector<string> splitList(const string &list)
+{
+	vector<string> items;
+	stringstream stream(list);
+	string item;
+	while (getline(stream, item, ','))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	return items;
+}
+
+vector<int> splitIntList(const string &list, const string &option)
+{
+	vector<int> values;
+	for (const string &item : splitList(list))
+	{
+		const int value = stoi(item);
+		if (value <= 0)
+		{
+			cerr << option << " values must be positive integers."
+				 << endl;
+			exit(EXIT_FAILURE);
+		}
+		values.push_back(value);
+	}
+	return values;
+}
+
+BenchArgs parseBenchArguments(int argc, char **argv)
+{
+	BenchArgs args;
+	const string fileName = fs::path(argv[0]).filename().string();
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--help")
+			{
+				cout << "Usage: " << fileName
+					 << " <output_file> [--engines seq,openmp] "
+						"[--resolutions <list>] [--iterations "
+						"<list>] "
+						"[--threads <list>] "
+						"[--schedules "
+						"STATIC,DYNAMIC,GUIDED,RUNTIME] "
+						"[--warmup <runs>] [--repeat <runs>]"
+					 << endl;
+				exit(EXIT_SUCCESS);
+			}
+			else if (arg.rfind("--", 0) == 0 && !has_value)
+			{
+				cerr << arg << " requires a value." << endl;
+				exit(EXIT_FAILURE);
+			}
+			else if (arg == "--engines")
+				args.engines = splitList(argv[++i]);
+			else if (arg == "--resolutions")
+				args.resolutions = splitIntList(argv[++i], arg);
+			else if (arg == "--iterations")
+				args.iterations = splitIntList(argv[++i], arg);
+			else if (arg == "--threads")
+				args.threads = splitIntList(argv[++i], arg);
+			else if (arg == "--schedules")
+				args.schedules = splitList(argv[++i]);
+			else if (arg == "--warmup")
+				args.warmup = stoi(argv[++i]);
+			else if (arg == "--repeat")
+				args.repeat = stoi(argv[++i]);
+			else if (args.output_file.empty())
+				args.output_file = arg;
+			else
+			{
+				cerr << "Invalid argument or multiple output "
+						"files specified: "
+					 << arg << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	catch (const exception &e)
+	{
+		cerr << "Error parsing arguments: " << e.what() << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.output_file.empty())
+	{
+		cerr << "Please specify the output file as a parameter."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.warmup < 0 || args.repeat <= 0)
+	{
+		cerr << "--warmup must be >= 0 and --repeat > 0." << endl;
+		exit(EXIT_FAILURE);
+	}
+	for (const string &name : args.schedules)
+	{
+		kernels::Schedule schedule;
+		if (!kernels::parseSchedule(name, schedule))
+		{
+			cerr << "Unknown schedule: " << name << endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (const string &engine : args.engines)
+	{
+		if (engine != "seq" && engine != "openmp")
+		{
+			cerr << "Unknown engine: " << engine << endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	return args;
+}
+
+struct BenchConfig
+{
+	string engine;
+	int resolution_value = 0;
+	int iterations = 0;
+	int threads = 1;
+	string schedule_name;
+};
+
+// Runs the warmup and measured repetitions of one configuration in
+// this process, the image buffer is reused across repetitions. The
+// RAPL counters bracket all measured repetitions at once, a single
+// run can be shorter than their update interval; `run_energy`
+// receives the mean per repetition.
+vector<double> measure(const BenchConfig &config, int *image,
+					   int warmup, int repeat,
+					   const energy::Probe &probe,
+					   energy::Sample &run_energy)
+{
+	const int WIDTH =
+		static_cast<int>(RATIO_X * config.resolution_value);
+	const int HEIGHT =
+		static_cast<int>(RATIO_Y * config.resolution_value);
+	const float STEP = RATIO_X / WIDTH;
+	kernels::Schedule schedule = kernels::Schedule::RUNTIME;
+	kernels::parseSchedule(config.schedule_name, schedule);
+	omp_set_num_threads(config.threads);
+
+	vector<double> samples;
+	energy::Reading energy_before;
+	for (int run = 0; run < warmup + repeat; run++)
+	{
+		if (run == warmup)
+			energy_before = probe.read();
+		const auto start = chrono::steady_clock::now();
+		if (config.engine == "seq")
+			kernels::computeSequential(image, config.iterations,
+									   WIDTH, HEIGHT, STEP, MIN_X,
+									   MIN_Y);
+		else
+			kernels::computeOpenMP(image, config.iterations, WIDTH,
+								   HEIGHT, STEP, MIN_X, MIN_Y,
+								   schedule);
+		const auto end = chrono::steady_clock::now();
+		if (run >= warmup)
+			samples.push_back(
+				chrono::duration<double>(end - start).count());
+	}
+	// Totals over the repetitions, the power is unaffected
+	run_energy = probe.delta(energy_before, probe.read());
+	run_energy.package_joules /= repeat;
+	run_energy.core_joules /= repeat;
+	run_energy.seconds /= repeat;
+	return samples;
+}
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	const BenchArgs args = parseBenchArguments(argc, argv);
+
+	// Every (engine, resolution, iterations, threads, schedule)
+	// combination, the sequential engine has a single configuration
+	vector<BenchConfig> configs;
+	for (const string &engine : args.engines)
+	{
+		const bool is_seq = engine == "seq";
+		for (const int resolution_value : args.resolutions)
+			for (const int iterations : args.iterations)
+				for (const int threads :
+					 is_seq ? vector<int>{1} : args.threads)
+					for (const string &schedule_name :
+						 is_seq ? vector<string>{""}
+								: args.schedules)
+						configs.push_back({engine, resolution_value,
+										   iterations, threads,
+										   schedule_name});
+	}
+
+	//? CSV, the OpenMP schema extended with the repetition summary
+	const string additinonalName = "_bench_";
+	const string csvFile = logutils::createCsvFilename(
+		args.output_file, additinonalName);
+	const string header =
+		"DateTime,Program,Iterations,Resolution,Width,Height,Step,"
+		"Scheduling,Threads,Time (seconds)" +
+		iterstats::csvHeaderColumns() + ",Engine,Warmup" +
+		benchstats::csvHeaderColumns() +
+		energy::csvHeaderColumns("Compute");
+	bool has_header = logutils::csvFileHasHeader(csvFile, header);
+	ofstream csv(csvFile, ios::app);
+	if (!csv.is_open())
+	{
+		cerr << "Unable to open CSV file." << endl;
+		return -1;
+	}
+	if (!has_header)
+	{
+		cout << "Adding header to csv file." << endl;
+		csv << header << endl;
+	}
+	const string log_file = logutils::create_log_file_name(
+		args.output_file, additinonalName);
+	ofstream log(log_file, ios::app);
+
+	// Empty energy columns where powercap is not readable
+	const energy::Probe energy_probe;
+	if (!energy_probe.available())
+		cout << "Energy counters unavailable ("
+			 << energy_probe.status()
+			 << "), energy columns stay empty." << endl;
+
+	unique_ptr<int[]> image;
+	int image_resolution = 0;
+	for (const BenchConfig &config : configs)
+	{
+		const int WIDTH =
+			static_cast<int>(RATIO_X * config.resolution_value);
+		const int HEIGHT =
+			static_cast<int>(RATIO_Y * config.resolution_value);
+		const float STEP = RATIO_X / WIDTH;
+		if (image_resolution != config.resolution_value)
+		{
+			image.reset(new int[HEIGHT * WIDTH]);
+			image_resolution = config.resolution_value;
+		}
+		energy::Sample run_energy;
+		const benchstats::Summary summary = benchstats::summarize(
+			measure(config, image.get(), args.warmup, args.repeat,
+					energy_probe, run_energy));
+		// Every repetition executes the same work
+		const iterstats::Stats iter_stats = iterstats::count(
+			image.get(), static_cast<size_t>(WIDTH) * HEIGHT,
+			config.iterations);
+
+		cout << config.engine << " " << config.schedule_name << " "
+			 << config.threads << " threads, resolution "
+			 << config.resolution_value << ", " << config.iterations
+			 << " iterations: median " << summary.median
+			 << " s, min " << summary.min << " s, stddev "
+			 << summary.stddev << " s, CI95 [" << summary.ci_low
+			 << ", " << summary.ci_high << "], "
+			 << iter_stats.gigaIterationsPerSecond(summary.median)
+			 << " GIterations/s" << endl;
+		if (energy_probe.available())
+			cout << "\tEnergy per run: "
+				 << energy::describe(run_energy) << endl;
+		csv << logutils::getCurrentTimestamp() << "," << fileName
+			<< "," << config.iterations << ","
+			<< config.resolution_value << "," << WIDTH << ","
+			<< HEIGHT << "," << STEP << "," << config.schedule_name
+			<< "," << config.threads << "," << summary.median
+			<< iterstats::csvColumns(iter_stats, summary.median)
+			<< "," << config.engine << "," << args.warmup
+			<< benchstats::csvColumns(summary)
+			<< energy::csvColumns(run_energy) << endl;
+		if (log.is_open())
+		{
+			log << "Date:\t" << logutils::getCurrentTimestamp()
+				<< "\tProgram:\t" << fileName << "\tEngine:\t"
+				<< config.engine << "\tIterations:\t"
+				<< config.iterations << "\tResolution:\t"
+				<< config.resolution_value << "\tScheduling:\t"
+				<< config.schedule_name << "\tThreads:\t"
+				<< config.threads << "\tWarmup:\t" << args.warmup
+				<< "\tRepeat:\t" << args.repeat << "\tMedian:\t"
+				<< summary.median << "\tMin:\t" << summary.min
+				<< "\tStddev:\t" << summary.stddev << "\tseconds"
+				<< endl;
+			if (energy_probe.available())
+				log << "\tEnergy per run:\t"
+					<< energy::describe(run_energy) << endl;
+		}
+	}
+	csv.close();
+	cout << "CSV entries added to " << csvFile << endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,413 @@
+#include <BenchStats.h>
+#include <LogUtils.h>
+#include <MandelbrotKernels.h>
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace MandelbrotSet
+{
+// Ranges of the set
+constexpr float MIN_X = -2.0;
+constexpr float MAX_X = 1.0;
+constexpr float MIN_Y = -1.0;
+constexpr float MAX_Y = 1.0;
+
+// Image ratio
+constexpr float RATIO_X = (MAX_X - MIN_X);
+constexpr float RATIO_Y = (MAX_Y - MIN_Y);
+} // namespace MandelbrotSet
+namespace fs = std::filesystem;
+
+using namespace std;
+using namespace MandelbrotSet;
+
+// Per-pixel cost of every kernel variant on fixed point sets that
+// isolate one cost class each. Runs on a single thread; the points
+// are generated from fixed seeds and a reference render, so every
+// run and every variant sees the same input.
+
+struct MicroArgs
+{
+	string output_file;
+	int points = 1 << 16;
+	vector<int> iterations = {1000};
+	// Resolution of the render the boundary and mixed sets come
+	// from
+	int resolution = 500;
+	int warmup = 1;
+	int repeat = 5;
+};
+
+vector<int> splitIntList(const string &list, const string &option)
+{
+	vector<int> values;
+	stringstream stream(list);
+	string item;
+	while (getline(stream, item, ','))
+	{
+		if (item.empty())
+			continue;
+		const int value = stoi(item);
+		if (value <= 0)
+		{
+			cerr << option << " values must be positive integers."
+				 << endl;
+			exit(EXIT_FAILURE);
+		}
+		values.push_back(value);
+	}
+	return values;
+}
+
+MicroArgs parseMicroArguments(int argc, char **argv)
+{
+	MicroArgs args;
+	const string fileName = fs::path(argv[0]).filename().string();
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--help")
+			{
+				cout << "Usage: " << fileName
+					 << " <output_file> [--points <count>] "
+						"[--iterations <list>] "
+						"[--resolution <resolution>] "
+						"[--warmup <runs>] [--repeat <runs>]"
+					 << endl;
+				exit(EXIT_SUCCESS);
+			}
+			else if (arg.rfind("--", 0) == 0 && !has_value)
+			{
+				cerr << arg << " requires a value." << endl;
+				exit(EXIT_FAILURE);
+			}
+			else if (arg == "--points")
+				args.points = stoi(argv[++i]);
+			else if (arg == "--iterations")
+				args.iterations = splitIntList(argv[++i], arg);
+			else if (arg == "--resolution")
+				args.resolution = stoi(argv[++i]);
+			else if (arg == "--warmup")
+				args.warmup = stoi(argv[++i]);
+			else if (arg == "--repeat")
+				args.repeat = stoi(argv[++i]);
+			else if (args.output_file.empty())
+				args.output_file = arg;
+			else
+			{
+				cerr << "Invalid argument or multiple output "
+						"files specified: "
+					 << arg << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	catch (const exception &e)
+	{
+		cerr << "Error parsing arguments: " << e.what() << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.output_file.empty())
+	{
+		cerr << "Please specify the output file as a parameter."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.points <= 0 || args.resolution <= 0 ||
+		args.warmup < 0 || args.repeat <= 0)
+	{
+		cerr << "--points, --resolution and --repeat must be "
+				"positive, "
+				"--warmup >= 0."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	return args;
+}
+
+struct PointSet
+{
+	string name;
+	vector<double> re, im;
+};
+
+// Main cardioid and period-2 bulb, every point there is bounded
+bool inMainComponents(double x, double y)
+{
+	const double q = (x - 0.25) * (x - 0.25) + y * y;
+	return q * (q + (x - 0.25)) <= 0.25 * y * y ||
+		   (x + 1) * (x + 1) + y * y <= 1.0 / 16;
+}
+
+vector<PointSet> buildPointSets(int points, int iterations,
+								int resolution)
+{
+	mt19937_64 random(20241020);
+	uniform_real_distribution<double> x_range(MIN_X, MAX_X);
+	uniform_real_distribution<double> y_range(MIN_Y, MAX_Y);
+	vector<PointSet> sets(4);
+	sets[0].name = "interior";
+	sets[1].name = "fast-escape";
+	sets[2].name = "boundary";
+	sets[3].name = "mixed";
+
+	// Interior: inside the main components, every iteration runs
+	while (static_cast<int>(sets[0].re.size()) < points)
+	{
+		const double x = x_range(random), y = y_range(random);
+		if (inMainComponents(x, y))
+		{
+			sets[0].re.push_back(x);
+			sets[0].im.push_back(y);
+		}
+	}
+	// Fast escape: the viewport points that leave within 8 steps
+	while (static_cast<int>(sets[1].re.size()) < points)
+	{
+		const double x = x_range(random), y = y_range(random);
+		const int escape = kernels::escapeTime({x, y}, 8);
+		if (escape > 0)
+		{
+			sets[1].re.push_back(x);
+			sets[1].im.push_back(y);
+		}
+	}
+
+	// Reference render with the engines' pixel mapping
+	const int WIDTH = static_cast<int>(RATIO_X * resolution);
+	const int HEIGHT = static_cast<int>(RATIO_Y * resolution);
+	const float STEP = RATIO_X / WIDTH;
+	vector<int> image(static_cast<size_t>(WIDTH) * HEIGHT);
+	kernels::computeOpenMP(image.data(), iterations, WIDTH, HEIGHT,
+						   STEP, MIN_X, MIN_Y,
+						   kernels::Schedule::DYNAMIC);
+	auto pixel = [&](int pos)
+	{
+		return complex<double>((pos % WIDTH) * STEP + MIN_X,
+							   (pos / WIDTH) * STEP + MIN_Y);
+	};
+	// Boundary: pixels with a bounded and an escaping 4-neighbour
+	// side by side, cycled if there are fewer than `points`
+	vector<int> boundary;
+	for (int row = 1; row + 1 < HEIGHT; row++)
+		for (int col = 1; col + 1 < WIDTH; col++)
+		{
+			const int pos = row * WIDTH + col;
+			const bool bounded = image[pos] == 0;
+			if ((image[pos - 1] == 0) != bounded ||
+				(image[pos + 1] == 0) != bounded ||
+				(image[pos - WIDTH] == 0) != bounded ||
+				(image[pos + WIDTH] == 0) != bounded)
+				boundary.push_back(pos);
+		}
+	shuffle(boundary.begin(), boundary.end(), random);
+	for (int i = 0; i < points && !boundary.empty(); i++)
+	{
+		const complex<double> c =
+			pixel(boundary[i % boundary.size()]);
+		sets[2].re.push_back(c.real());
+		sets[2].im.push_back(c.imag());
+	}
+	// Mixed: uniform sample of the real render
+	uniform_int_distribution<int> any_pixel(0, WIDTH * HEIGHT - 1);
+	for (int i = 0; i < points; i++)
+	{
+		const complex<double> c = pixel(any_pixel(random));
+		sets[3].re.push_back(c.real());
+		sets[3].im.push_back(c.imag());
+	}
+	return sets;
+}
+
+// A kernel variant over a whole point set
+using Variant = void (*)(const double *re, const double *im,
+						 int count, int iterations, int *escape);
+
+void complexDouble(const double *re, const double *im, int count,
+				   int iterations, int *escape)
+{
+	for (int i = 0; i < count; i++)
+		escape[i] = kernels::escapeTime({re[i], im[i]}, iterations);
+}
+
+void scalarDouble(const double *re, const double *im, int count,
+				  int iterations, int *escape)
+{
+	for (int i = 0; i < count; i++)
+		escape[i] =
+			kernels::escapeTimeScalar(re[i], im[i], iterations);
+}
+
+void scalarFloat(const double *re, const double *im, int count,
+				 int iterations, int *escape)
+{
+	for (int i = 0; i < count; i++)
+		escape[i] = kernels::escapeTimeScalar(
+			static_cast<float>(re[i]), static_cast<float>(im[i]),
+			iterations);
+}
+
+void scalarDoubleDouble(const double *re, const double *im,
+						int count, int iterations, int *escape)
+{
+	for (int i = 0; i < count; i++)
+		escape[i] = kernels::escapeTimeScalar<dd::Real>(
+			re[i], im[i], iterations);
+}
+
+// The widening to double-double is part of the timed work, it is
+// linear in the points while the kernel is not
+void batchDoubleDouble(const double *re, const double *im,
+					   int count, int iterations, int *escape)
+{
+	const vector<dd::Real> cr(re, re + count), ci(im, im + count);
+	kernels::escapeTimeBatch(cr.data(), ci.data(), count,
+							 iterations, escape);
+}
+
+struct VariantEntry
+{
+	string name;
+	Variant run;
+	// Double variant of the same shape the slowdown is relative to
+	string baseline;
+};
+
+// complex<double> is the reference the others are checked against;
+// a baseline is listed before the variants that use it
+const vector<VariantEntry> VARIANTS = {
+	{"scalar double", scalarDouble, "scalar double"},
+	{"complex<double>", complexDouble, "scalar double"},
+	{"scalar float", scalarFloat, "scalar double"},
+	{"batch double", kernels::escapeTimeBatch, "batch double"},
+	{"scalar double-double", scalarDoubleDouble, "scalar double"},
+	{"batch double-double", batchDoubleDouble, "batch double"},
+};
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	const MicroArgs args = parseMicroArguments(argc, argv);
+
+	//? CSV, one row per (iterations, class, variant)
+	const string additinonalName = "_micro_";
+	const string csvFile = logutils::createCsvFilename(
+		args.output_file, additinonalName);
+	const string header =
+		"DateTime,Program,Iterations,Class,Variant,Points,"
+		"Executed Iterations,Mismatches,Warmup" +
+		benchstats::csvHeaderColumns() +
+		",ns/iteration,ns/pixel,Baseline,Slowdown";
+	bool has_header = logutils::csvFileHasHeader(csvFile, header);
+	ofstream csv(csvFile, ios::app);
+	if (!csv.is_open())
+	{
+		cerr << "Unable to open CSV file." << endl;
+		return -1;
+	}
+	if (!has_header)
+		csv << header << endl;
+	const string log_file = logutils::create_log_file_name(
+		args.output_file, additinonalName);
+	ofstream log(log_file, ios::app);
+
+	for (const int iterations : args.iterations)
+	{
+		const vector<PointSet> sets = buildPointSets(
+			args.points, iterations, args.resolution);
+		for (const PointSet &set : sets)
+		{
+			const int count = static_cast<int>(set.re.size());
+			vector<int> reference(count), escape(count);
+			complexDouble(set.re.data(), set.im.data(), count,
+						  iterations, reference.data());
+			// Median of every variant of this set, for the
+			// slowdowns
+			map<string, double> medians;
+			for (const auto &variant : VARIANTS)
+			{
+				vector<double> samples;
+				for (int run = 0; run < args.warmup + args.repeat;
+					 run++)
+				{
+					const auto start = chrono::steady_clock::now();
+					variant.run(set.re.data(), set.im.data(), count,
+								iterations, escape.data());
+					const auto end = chrono::steady_clock::now();
+					if (run >= args.warmup)
+						samples.push_back(
+							chrono::duration<double>(end - start)
+								.count());
+				}
+				const benchstats::Summary summary =
+					benchstats::summarize(samples);
+				// Work of the variant itself, float may escape
+				// earlier
+				int64_t executed = 0;
+				int mismatches = 0;
+				for (int i = 0; i < count; i++)
+				{
+					executed += kernels::executedIterations(
+						escape[i], iterations);
+					mismatches += escape[i] != reference[i];
+				}
+				const double ns_per_iteration =
+					executed > 0 ? summary.median / executed * 1e9
+								 : 0.0;
+				const double ns_per_pixel =
+					count > 0 ? summary.median / count * 1e9 : 0.0;
+				medians[variant.name] = summary.median;
+				const double baseline = medians[variant.baseline];
+				const double slowdown =
+					baseline > 0.0 ? summary.median / baseline
+								   : 0.0;
+				cout << set.name << "\t" << variant.name << "\t"
+					 << iterations << " iterations:\t"
+					 << ns_per_iteration << " ns/iteration,\t"
+					 << ns_per_pixel << " ns/pixel,\t" << slowdown
+					 << "x " << variant.baseline << ",\t"
+					 << mismatches << " mismatches" << endl;
+				csv << logutils::getCurrentTimestamp() << ","
+					<< fileName << "," << iterations << ","
+					<< set.name << "," << variant.name << ","
+					<< count << "," << executed << "," << mismatches
+					<< "," << args.warmup
+					<< benchstats::csvColumns(summary) << ","
+					<< ns_per_iteration << "," << ns_per_pixel
+					<< "," << variant.baseline << "," << slowdown
+					<< endl;
+				if (log.is_open())
+					log << "Date:\t"
+						<< logutils::getCurrentTimestamp()
+						<< "\tProgram:\t" << fileName
+						<< "\tIterations:\t" << iterations
+						<< "\tClass:\t" << set.name
+						<< "\tVariant:\t" << variant.name
+						<< "\tPoints:\t" << count << "\tMedian:\t"
+						<< summary.median
+						<< "\tseconds\tns/iteration:\t"
+						<< ns_per_iteration << "\tns/pixel:\t"
+						<< ns_per_pixel << "\tSlowdown:\t"
+						<< slowdown << "\tvs\t" << variant.baseline
+						<< "\tMismatches:\t" << mismatches << endl;
+			}
+		}
+	}
+	csv.close();
+	cout << "CSV entries added to " << csvFile << endl;
+	return 0;
+}
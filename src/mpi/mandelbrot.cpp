@@ -8,40 +8,26 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <mpi.h>
 #include <omp.h>
 #include <string>
 #include <sys/stat.h>
+#include <vector>
 
-class NoNumber : public std::exception
-{
-	std::string message;
-
-  public:
-	NoNumber(const std::string &input)
-		: message("NoNumber exception: " + input)
-	{
-	}
-	virtual const char *what() const noexcept override
-	{
-		return message.c_str();
-	}
-};
-
-class Overflow : public std::exception
-{
-	std::string message;
-
-  public:
-	Overflow(const std::string &input)
-		: message("Overflow exception: " + input)
-	{
-	}
-	virtual const char *what() const noexcept override
-	{
-		return message.c_str();
-	}
-};
+#include <Buddhabrot.h>
+#include <FormulaEngine.h>
+#include <HybridLayout.hpp>
+#include <ImageIO.h>
+#include <IterationStats.h>
+#include <LogUtils.h>
+#include <MPICheckpoint.hpp>
+#include <MPIGather.hpp>
+#include <MPIPartition.hpp>
+#include <MPIPhaseTimes.hpp>
+#include <MPIProgress.hpp>
+#include <ProgressReporter.h>
+#include <ThreadTrace.h>
 
 namespace MandelbrotSet
 {
@@ -170,7 +156,7 @@ string create_log_file_name(const std::string &output_file,
 	filename = extractBaseFileName(filename);
 
 	// Define log directory
-	std::string logDir = "data";
+	std::string logDir = "logs";
 
 	// Create 'logs' directory if it doesn't exist
 	struct stat info;
@@ -179,7 +165,7 @@ string create_log_file_name(const std::string &output_file,
 		// Directory does not exist, create it
 		if (mkdir(logDir.c_str(), 0755) != 0)
 		{
-			std::cerr << "Error: Unable to create csv directory '"
+			std::cerr << "Error: Unable to create log directory '"
 					  << logDir << "'." << endl;
 		}
 	}
@@ -191,51 +177,130 @@ string create_log_file_name(const std::string &output_file,
 
 	// Construct log file path
 	std::string logFilePath =
-		logDir + "/" + filename + additionalName + ".csv";
+		logDir + "/" + filename + additionalName + ".log";
 	return logFilePath;
 }
-string create_log_file_name(const std::string &output_file,
-							const std::string &additionalName = "")
+
+void checkMPIError(int errCode, const string &msg)
 {
-	// Extract filename from path
-	std::string filename = getFileName(output_file);
-	// Extract base filename
-	filename = extractBaseFileName(filename);
+	if (errCode != MPI_SUCCESS)
+	{
+		cerr << "MPI Error: " << msg << " Error Code: " << errCode
+			 << endl;
+		MPI_Abort(MPI_COMM_WORLD, errCode);
+	}
+}
 
-	// Define log directory
-	std::string logDir = "logs";
+// Escape iteration of c, 0 if it stays bounded. The magnitude test
+// of this engine is |z|^2 >= 4
+template <typename Formula>
+inline int escapeIteration(const Formula &policy,
+						   const complex<double> &c, int iterations)
+{
+	return formula::escapeTime<Formula, formula::Bailout::NORM>(
+		policy, c, iterations);
+}
 
-	// Create 'logs' directory if it doesn't exist
-	struct stat info;
-	if (stat(logDir.c_str(), &info) != 0)
+// Pixels [tile_start, tile_end) of the image into sub_image, which
+// starts at pixel start_index; compiled once per formula
+template <typename Formula>
+void computeTile(const Formula &policy, int *sub_image,
+				 int ITERATIONS, int WIDTH, float STEP,
+				 int start_index, int tile_start, int tile_end,
+				 threadtrace::Recorder &trace)
+{
+	if (trace.enabled())
 	{
-		// Directory does not exist, create it
-		if (mkdir(logDir.c_str(), 0755) != 0)
+		// Same loop, each thread merges the chunks it is handed
+		trace.regionBegin();
+#pragma omp parallel default(none)                                 \
+	firstprivate(sub_image, ITERATIONS)                            \
+		shared(policy, WIDTH, STEP, start_index, tile_start,       \
+			   tile_end, trace)
 		{
-			std::cerr << "Error: Unable to create log directory '"
-					  << logDir << "'." << endl;
+			threadtrace::ChunkTracker tracker(trace,
+											  omp_get_thread_num());
+#pragma omp for schedule(dynamic) nowait
+			for (int pos = tile_start; pos < tile_end; pos++)
+			{
+				const int row = pos / WIDTH;
+				const int col = pos % WIDTH;
+				const complex<double> c(col * STEP + MIN_X,
+										row * STEP + MIN_Y);
+				const int iter =
+					escapeIteration(policy, c, ITERATIONS);
+				sub_image[pos - start_index] = iter;
+				tracker.add(pos, iter == 0 ? ITERATIONS : iter);
+			}
 		}
+		trace.regionEnd();
+		return;
 	}
-	else if (!(info.st_mode & S_IFDIR))
+#pragma omp parallel for schedule(dynamic) default(none)           \
+	firstprivate(sub_image, ITERATIONS) shared(                    \
+		policy, WIDTH, STEP, start_index, tile_start, tile_end)
+	for (int pos = tile_start; pos < tile_end; pos++)
 	{
-		std::cerr << "Error: '" << logDir
-				  << "' exists but is not a directory." << endl;
+		const int row = pos / WIDTH;
+		const int col = pos % WIDTH;
+		const complex<double> c(col * STEP + MIN_X,
+								row * STEP + MIN_Y);
+		sub_image[pos - start_index] =
+			escapeIteration(policy, c, ITERATIONS);
 	}
-
-	// Construct log file path
-	std::string logFilePath =
-		logDir + "/" + filename + additionalName + ".log";
-	return logFilePath;
 }
 
-void checkMPIError(int errCode, const string &msg)
+// Thread summaries of every rank on root, indexed by rank
+vector<vector<threadtrace::ThreadSummary>> gatherThreadSummaries(
+	const vector<threadtrace::ThreadSummary> &local, MPI_Comm comm,
+	int root)
 {
-	if (errCode != MPI_SUCCESS)
+	constexpr int FIELDS = 5;
+	vector<double> packed;
+	for (const threadtrace::ThreadSummary &thread : local)
 	{
-		cerr << "MPI Error: " << msg << " Error Code: " << errCode
-			 << endl;
-		MPI_Abort(MPI_COMM_WORLD, errCode);
+		packed.insert(packed.end(),
+					  {static_cast<double>(thread.chunks),
+					   static_cast<double>(thread.pixels),
+					   static_cast<double>(thread.iterations),
+					   thread.busy, thread.idle});
 	}
+	int count = static_cast<int>(packed.size());
+	int rank = 0, size = 1;
+	MPI_Comm_rank(comm, &rank);
+	MPI_Comm_size(comm, &size);
+	vector<int> counts(rank == root ? size : 0);
+	MPI_Gather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, root,
+			   comm);
+	vector<int> offsets(counts.size(), 0);
+	int total = 0;
+	for (size_t i = 0; i < counts.size(); i++)
+	{
+		offsets[i] = total;
+		total += counts[i];
+	}
+	vector<double> buffer(rank == root ? total : 0);
+	MPI_Gatherv(packed.data(), count, MPI_DOUBLE, buffer.data(),
+				counts.data(), offsets.data(), MPI_DOUBLE, root,
+				comm);
+	vector<vector<threadtrace::ThreadSummary>> ranks(counts.size());
+	for (size_t r = 0; r < counts.size(); r++)
+	{
+		for (int t = 0; t < counts[r] / FIELDS; t++)
+		{
+			const double *fields =
+				buffer.data() + offsets[r] + t * FIELDS;
+			threadtrace::ThreadSummary thread;
+			thread.thread = t;
+			thread.chunks = static_cast<int64_t>(fields[0]);
+			thread.pixels = static_cast<int64_t>(fields[1]);
+			thread.iterations = static_cast<int64_t>(fields[2]);
+			thread.busy = fields[3];
+			thread.idle = fields[4];
+			ranks[r].push_back(thread);
+		}
+	}
+	return ranks;
 }
 
 // Rewritten isValidOutputPath without using filesystem
@@ -286,27 +351,6 @@ bool isValidOutputPath(const string &output_file)
 	return true;
 }
 
-int castInput(std::string &input)
-{
-	int result{};
-	// Check if there is any alphabetic character in the input
-	// string
-	if (std::any_of(input.begin(), input.end(), ::isalpha))
-	{
-		// If so, throw NoNumber exception
-		throw NoNumber(input);
-	}
-	// Check if the string has more than 10 characters to prevent
-	// integer overflow
-	if (input.length() > 10)
-	{
-		// If so, throw Overflow exception
-		throw Overflow(input);
-	}
-	// Convert string to integer
-	result = std::stoi(input);
-	return result;
-}
 /**
  * @brief Extracts the parent directory from a given file path.
  *
@@ -449,36 +493,118 @@ std::string createCsvFilename(const std::string &output_file,
 	return csvPath;
 }
 /**
- * @brief Checks if a CSV file contains the specified header.
- *
- * @param filePath The path to the CSV file.
- * @param header The expected header string.
- * @return `true` if the header matches; `false` otherwise or if the
- * file cannot be read.
+ * @brief Orbit-density image of `args.buddhabrot_samples` random c
+ * values. Every rank takes every nproc-th sample block and reduces
+ * its threads' histograms; MPI_Reduce sums the ranks on rank 0,
+ * which writes the image in the binary format.
  */
-bool csvFileHasHeader(const std::string &filePath,
-					  const std::string &header)
+int runBuddhabrot(const cmdParse::ParsedArgs &args,
+				  const string &fileName, int nproc, int myid,
+				  int threads_used, int WIDTH, int HEIGHT,
+				  float STEP)
 {
-	std::ifstream file(filePath);
-	if (!file.good() || !file.is_open())
+	const int iterations = args.iterations;
+	const auto start = chrono::steady_clock::now();
+	buddhabrot::Importance importance;
+	if (args.importance)
+		importance = buddhabrot::buildImportance(iterations);
+	buddhabrot::Window window;
+	window.width = WIDTH;
+	window.height = HEIGHT;
+	window.min_x = MIN_X;
+	window.min_y = MIN_Y;
+	window.step = STEP;
+	const int total_pixels = WIDTH * HEIGHT;
+	vector<double> histogram(total_pixels, 0.0);
+	buddhabrot::Stats stats =
+		buddhabrot::accumulate(histogram.data(), window, iterations,
+							   args.buddhabrot_samples, args.seed,
+							   &importance, myid, nproc);
+
+	const auto reduce_start = chrono::steady_clock::now();
+	vector<double> total(myid == 0 ? total_pixels : 0);
+	int err =
+		MPI_Reduce(histogram.data(), total.data(), total_pixels,
+				   MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+	checkMPIError(err, "MPI_Reduce failed.");
+	int64_t counters[3] = {stats.samples, stats.escaped,
+						   stats.orbit_points};
+	err = MPI_Reduce(myid == 0 ? MPI_IN_PLACE : counters, counters,
+					 3, MPI_INT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+	checkMPIError(err, "MPI_Reduce failed.");
+	const double mpi_reduce_seconds =
+		chrono::duration<double>(chrono::steady_clock::now() -
+								 reduce_start)
+			.count();
+	if (myid != 0)
+		return 0;
+	stats.samples = counters[0];
+	stats.escaped = counters[1];
+	stats.orbit_points = counters[2];
+
+	const string output_path =
+		args.output_file + ".buddhabrot.mbin";
+	const vector<int> counts =
+		buddhabrot::toCounts(total.data(), total_pixels);
+	if (!imageio::writeBinary(output_path, counts.data(), WIDTH,
+							  HEIGHT, 0, HEIGHT))
 	{
-		std::cerr << "Error: Cannot open file: " << filePath
-				  << std::endl;
-		exit(EXIT_FAILURE);
+		cerr << "Unable to write " << output_path << endl;
+		return -3;
 	}
+	const double elapsed_seconds =
+		chrono::duration<double>(chrono::steady_clock::now() -
+								 start)
+			.count();
+	cout << stats.escaped << " of " << stats.samples
+		 << " orbits escaped, " << stats.orbit_points
+		 << " points in the image, written to " << output_path
+		 << endl;
+	cout << "Time elapsed: " << fixed << setprecision(2)
+		 << elapsed_seconds << " seconds." << endl;
 
-	std::string firstLine;
-	if (!std::getline(file, firstLine))
+	//? CSV
+	const string csv_filename =
+		createCsvFilename(args.output_file, "_buddhabrot");
+	const string header =
+		"DateTime,Program,Iterations,Resolution,Width,Height,Step,"
+		"NProcesses,Threads,Time (seconds)" +
+		buddhabrot::csvHeaderColumns() + ",MPI Reduce (s)";
+	bool has_header =
+		logutils::csvFileHasHeader(csv_filename, header);
+	ofstream csv_stream(csv_filename, std::ios::app);
+	if (csv_stream.is_open())
 	{
-		std::cerr << "Error: Unable to read from file: " << filePath
-				  << std::endl;
-		return false;
+		if (!has_header)
+			csv_stream << header << endl;
+		csv_stream << defaultfloat << getCurrentTimestamp() << ","
+				   << fileName << "," << iterations << ","
+				   << args.resolution << "," << WIDTH << ","
+				   << HEIGHT << "," << STEP << "," << nproc << ","
+				   << threads_used << "," << elapsed_seconds
+				   << buddhabrot::csvColumns(stats, importance)
+				   << "," << mpi_reduce_seconds << endl;
+		cout << "CSV entry added successfully." << endl;
 	}
-	bool has_header = (firstLine == header);
-	std::cout << "Header present: "
-			  << (has_header ? "true" : "false") << std::endl;
-	return has_header;
+	else
+	{
+		cerr << "Unable to open csv file." << endl;
+	}
+	//? log
+	ofstream log(
+		create_log_file_name(args.output_file, "_buddhabrot_"),
+		std::ios::app);
+	if (log.is_open())
+		log << "\tProgram:\t" << fileName << "\tIterations:\t"
+			<< iterations << "\tResolution:\t" << args.resolution
+			<< "\tNodes:\t" << nproc << "\tTime:\t"
+			<< elapsed_seconds << " seconds" << endl
+			<< buddhabrot::describe(stats, importance)
+			<< "\tMPI reduce (rank 0):\t" << mpi_reduce_seconds
+			<< "\tseconds" << endl;
+	return 0;
 }
+
 int main(int argc, char **argv)
 {
 	// cout.sync_with_stdio(false);
@@ -487,199 +613,573 @@ int main(int argc, char **argv)
 		getFileName(programPath); // Extracted filename
 
 	int err, nproc, myid;
+	phases::PhaseTimes phase_times;
+	const auto init_start = chrono::steady_clock::now();
 	err = MPI_Init(&argc, &argv);
 	checkMPIError(err, "MPI_Init failed.");
 	err = MPI_Comm_size(MPI_COMM_WORLD, &nproc);
 	checkMPIError(err, "MPI_Comm_size failed.");
 	err = MPI_Comm_rank(MPI_COMM_WORLD, &myid);
 	checkMPIError(err, "MPI_Comm_rank failed.");
-	if (argc < 4)
+	// Every rank parses the same command line
+	cmdParse::ParsedArgs args =
+		cmdParse::parse_cmd_arguments(argc, argv);
+	const string output_file = args.output_file;
+	const formula::Params formula_params = formula::makeParams(
+		args.formula, args.julia_re, args.julia_im, args.power);
+	const bool other_formula =
+		!formula::isMandelbrot(formula_params);
+	const int iterations = args.iterations;
+	const int resolution_value = args.resolution;
+	if (iterations <= 0 || resolution_value <= 0)
 	{
 		if (myid == 0)
 		{
-			cerr << "Incorrect number of argumennts!";
 			cerr << "Usage: " << fileName
-				 << " <output_file> <iterations> <resolution_value>"
+				 << " <output_file> --iterations <iterations> "
+					"--resolution <resolution> "
+					"[--threads-per-rank <threads>]"
 				 << endl;
 		}
 		MPI_Finalize();
+		return -2;
+	}
+	const string openmp_only = cmdParse::openmpOnlyOption(args);
+	if (!openmp_only.empty())
+	{
+		if (myid == 0)
+			cerr << openmp_only
+				 << " is only available in the OpenMP engine."
+				 << endl;
+		MPI_Finalize();
 		return -1;
 	}
 
-	int iterations = 0;
-	int resolution_value = 0;
-	string argToString = argv[2];
+	// End-to-end breakdown of this rank, rank 0 reports its own;
+	// the CSV columns follow this order
+	logutils::PhaseRegistry run_phases(
+		{"Init", "Mkdir", "Alloc", "Partition", "Compute", "Stats",
+		 "Wait", "Gather", "Write", "CSV probe"});
 
-	try
+	// Check if the output file path is valid on the root process,
+	// this also creates the output directory
+	logutils::ScopedTimer mkdir_timer(run_phases, "Mkdir");
+	if (myid == 0 && !isValidOutputPath(output_file))
 	{
-		// Convert iterations input to integer
-		argToString = argv[2];
-		iterations = castInput(argToString);
-		if (iterations <= 0)
-		{
-			cerr
-				<< "Please specify a positive number of iterations."
-				<< endl;
-			MPI_Finalize();
-			return -2;
-		}
-	}
-	// Catch custom exceptions
-	catch (const NoNumber &e)
-	{
-		cerr << e.what() << "\n";
 		MPI_Finalize();
-		return -2;
+		return -4;
 	}
-	catch (const Overflow &e)
+	mkdir_timer.stop();
+
+	// Root process outputs number of nodes and resolution_value
+	if (myid == 0)
 	{
-		cerr << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		cout << "Number of nodes: " << nproc << endl;
+		cout << "Resolution: " << resolution_value << endl;
 	}
-	// Catch standard exceptions from stoi
-	catch (const std::invalid_argument &e)
+
+	const int HEIGHT = resolution_value * RATIO_Y;
+	const int WIDTH = resolution_value * RATIO_X;
+	const float STEP = RATIO_X / WIDTH;
+	const int ITERATIONS = iterations;
+
+	const int total_pixels = HEIGHT * WIDTH;
+
+	int *image = nullptr;
+	logutils::ScopedTimer image_timer(run_phases, "Alloc");
+	if (myid == 0 && !args.sharded_output)
 	{
-		cerr << "Invalid argument: " << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		image = new int[total_pixels];
 	}
-	catch (const std::out_of_range &e)
+	image_timer.stop();
+	// Size the OpenMP team so that ranks x threads fills the node
+	const hybrid::Layout layout = hybrid::discoverLayout(
+		MPI_COMM_WORLD, args.threads_per_rank);
+	const bool pinned = hybrid::applyLayout(layout);
+	const int threads_used = layout.threads_per_rank;
+	const vector<string> layout_lines =
+		hybrid::gatherLayouts(layout, MPI_COMM_WORLD, 0);
+	for (const string &line : layout_lines)
+		cout << line << endl;
+	if (!pinned)
 	{
-		cerr << "Out of range error: " << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		cerr << "Rank " << myid
+			 << ": unable to pin threads, running unbound." << endl;
 	}
 
-	// Parse and validate resolution_value input
-	try
+	// Orbit densities share neither the partition nor the gather
+	if (args.buddhabrot_samples > 0)
 	{
-		argToString = argv[3];
-		resolution_value = castInput(argToString);
-		if (resolution_value <= 0)
+		delete[] image;
+		if (other_formula)
 		{
-			cerr << "Please specify a positive resolution_value."
-				 << endl;
+			if (myid == 0)
+				cerr << "--formula " << args.formula
+					 << " is not available with --buddhabrot."
+					 << endl;
 			MPI_Finalize();
-			return -3;
+			return -1;
 		}
+		const int code =
+			runBuddhabrot(args, fileName, nproc, myid, threads_used,
+						  WIDTH, HEIGHT, STEP);
+		err = MPI_Finalize();
+		checkMPIError(err, "MPI_Finalize failed.");
+		return code;
 	}
-	catch (const NoNumber &e)
+
+	auto start_time = chrono::steady_clock::now();
+	// Everything before the partitioning is initialisation
+	run_phases.add(
+		"Init",
+		chrono::duration<double>(start_time - init_start).count() -
+			run_phases.seconds("Mkdir") -
+			run_phases.seconds("Alloc"));
+	logutils::ScopedTimer partition_timer(run_phases, "Partition");
+
+	// Contiguous row ranges, either equal in rows or equal in the
+	// cost predicted by a 1/16 resolution probe render
+	constexpr int PROBE_FACTOR = 16;
+	vector<partition::RowRange> ranges;
+	vector<double> predicted_costs;
+	if (args.partition == "cost")
 	{
-		cerr << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		const partition::Viewport view{WIDTH, HEIGHT, MIN_X,
+									   MIN_Y, STEP,	  ITERATIONS};
+		const vector<double> row_cost = partition::probeRowCost(
+			view, PROBE_FACTOR, MPI_COMM_WORLD, formula_params);
+		ranges = partition::balanceRows(row_cost, nproc);
+		predicted_costs = partition::rangeCosts(row_cost, ranges);
 	}
-	catch (const Overflow &e)
+	else
 	{
-		cerr << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		ranges = partition::equalRows(HEIGHT, nproc);
 	}
-	catch (const std::invalid_argument &e)
+	const int start_index = ranges[myid].first_row * WIDTH;
+	const int end_index =
+		(ranges[myid].first_row + ranges[myid].row_count) * WIDTH;
+	const int pixels_per_process = end_index - start_index;
+	partition_timer.stop();
+	logutils::ScopedTimer sub_image_timer(run_phases, "Alloc");
+	int *sub_image = new int[pixels_per_process]();
+	sub_image_timer.stop();
+
+	auto compute_start = chrono::steady_clock::now();
+	phase_times.seconds[phases::INIT] =
+		chrono::duration<double>(compute_start - init_start)
+			.count();
+	// Rows are computed in tiles so that completed tiles can be
+	// checkpointed, rows restored from a checkpoint are skipped
+	const string checkpoint_dir =
+		checkpoint::checkpointDir(output_file);
+	checkpoint::Writer checkpoint_writer(
+		checkpoint_dir, myid, WIDTH, args.checkpoint_interval);
+	const int local_rows = ranges[myid].row_count;
+	vector<char> row_done(local_rows, 0);
+	int restored_rows = 0;
+	if (checkpoint_writer.enabled())
 	{
-		cerr << "Invalid argument: " << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		const checkpoint::Params params{
+			WIDTH,
+			HEIGHT,
+			ITERATIONS,
+			STEP,
+			formula::kindName(formula_params.kind),
+			formula_params.julia.real(),
+			formula_params.julia.imag(),
+			formula_params.power};
+		for (const checkpoint::Chunk &chunk : checkpoint::prepare(
+				 checkpoint_dir, params, MPI_COMM_WORLD))
+		{
+			const int local_row =
+				chunk.first_row - ranges[myid].first_row;
+			if (local_row < 0 ||
+				local_row + chunk.row_count > local_rows)
+				continue;
+			if (!checkpoint::readChunk(checkpoint_dir, chunk, WIDTH,
+									   sub_image +
+										   local_row * WIDTH))
+				continue;
+			for (int row = local_row;
+				 row < local_row + chunk.row_count; row++)
+			{
+				restored_rows += row_done[row] ? 0 : 1;
+				row_done[row] = 1;
+			}
+		}
 	}
-	catch (const std::out_of_range &e)
+
+	// Per-thread chunk accounting, off unless requested
+	threadtrace::Recorder trace(threads_used, args.thread_stats);
+
+	// Live progress, rank 0 reports the sum of every rank's pixels;
+	// restored rows count as done
+	unique_ptr<progress::Reporter> reporter;
+	unique_ptr<progress::Aggregator> aggregator;
+	int64_t local_done =
+		static_cast<int64_t>(restored_rows) * WIDTH;
+	if (args.progress_interval > 0.0)
 	{
-		cerr << "Out of range error: " << e.what() << "\n";
-		MPI_Finalize();
-		return -2;
+		if (myid == 0)
+			reporter.reset(new progress::Reporter(
+				static_cast<int64_t>(WIDTH) * HEIGHT,
+				args.progress_interval));
+		aggregator.reset(
+			new progress::Aggregator(reporter.get(), MPI_COMM_WORLD,
+									 0, args.progress_interval));
+		if (reporter)
+			reporter->start();
 	}
+	// Called by every rank after its tile loop, returns once every
+	// rank is done
+	auto finishProgress = [&]()
+	{
+		if (aggregator)
+			aggregator->finish(local_done);
+		if (reporter)
+			reporter->stop();
+	};
 
-	// Check if the output file path is valid on the root process
-	if (myid == 0 && !isValidOutputPath(argv[1]))
+	// Tiles are the checkpoint and progress granularity
+	constexpr int TILE_ROWS = 16;
+	const int tile_rows = checkpoint_writer.enabled() || aggregator
+							  ? TILE_ROWS
+							  : local_rows;
+	int tile_first = 0;
+	while (tile_first < local_rows)
 	{
-		MPI_Finalize();
-		return -4;
+		if (row_done[tile_first])
+		{
+			tile_first++;
+			continue;
+		}
+		int tile_last = tile_first;
+		while (tile_last < local_rows &&
+			   tile_last - tile_first < tile_rows &&
+			   !row_done[tile_last])
+			tile_last++;
+		const int tile_start = start_index + tile_first * WIDTH;
+		const int tile_end = start_index + tile_last * WIDTH;
+
+		formula::dispatch(formula_params,
+						  [&](const auto &policy)
+						  {
+							  computeTile(policy, sub_image,
+										  ITERATIONS, WIDTH, STEP,
+										  start_index, tile_start,
+										  tile_end, trace);
+						  });
+		checkpoint_writer.add(ranges[myid].first_row + tile_first,
+							  tile_last - tile_first,
+							  sub_image + tile_first * WIDTH);
+		checkpoint_writer.maybeFlush();
+		local_done +=
+			static_cast<int64_t>(tile_last - tile_first) * WIDTH;
+		if (aggregator)
+			aggregator->poll(local_done);
+		tile_first = tile_last;
 	}
+	checkpoint_writer.flush();
+	auto wait_start = chrono::steady_clock::now();
+	phase_times.seconds[phases::COMPUTE] =
+		chrono::duration<double>(wait_start - compute_start)
+			.count();
+	run_phases.add("Compute", phase_times.seconds[phases::COMPUTE]);
 
-	// Root process outputs number of nodes and resolution_value
-	if (myid == 0)
+	double elapsed_seconds = 0.0;
+	if (args.sharded_output)
 	{
-		cout << "Number of nodes: " << nproc << endl;
-		cout << "Resolution: " << resolution_value << endl;
+		// Every rank writes its own band, no collective is involved
+		const string shard_file =
+			imageio::shardPath(output_file, myid);
+		logutils::ScopedTimer shard_mkdir_timer(run_phases,
+												"Mkdir");
+		mkdir_p(getParentPath(shard_file));
+		const double shard_mkdir_seconds = shard_mkdir_timer.stop();
+		if (!imageio::writeBinary(shard_file, sub_image, WIDTH,
+								  local_rows,
+								  ranges[myid].first_row, HEIGHT))
+		{
+			cerr << "Rank " << myid << ": unable to write shard."
+				 << endl;
+			MPI_Abort(MPI_COMM_WORLD, -3);
+		}
+		if (myid == 0)
+		{
+			// Partitioning is deterministic, rank 0 knows every
+			// band
+			imageio::ImageInfo manifest;
+			manifest.width = WIDTH;
+			manifest.height = HEIGHT;
+			manifest.iterations = ITERATIONS;
+			for (int rank = 0; rank < nproc; rank++)
+			{
+				manifest.shards.push_back(
+					{imageio::shardPath(output_file, rank),
+					 ranges[rank].first_row,
+					 ranges[rank].row_count});
+			}
+			imageio::writeManifest(
+				imageio::manifestPath(output_file), manifest);
+		}
+		auto end_time = chrono::steady_clock::now();
+		phase_times.seconds[phases::WRITE] =
+			chrono::duration<double>(end_time - wait_start).count();
+		run_phases.add("Write", phase_times.seconds[phases::WRITE] -
+									shard_mkdir_seconds);
+		elapsed_seconds =
+			chrono::duration<double>(end_time - start_time).count();
+		finishProgress();
 	}
+	else
+	{
+		// Time spent waiting for the slowest rank is measured
+		// separately from the data transfer itself
+		finishProgress();
+		MPI_Barrier(MPI_COMM_WORLD);
+		auto communication_start = chrono::steady_clock::now();
+		phase_times.seconds[phases::WAIT] =
+			chrono::duration<double>(communication_start -
+									 wait_start)
+				.count();
 
-	const int HEIGHT = resolution_value * RATIO_Y;
-	const int WIDTH = resolution_value * RATIO_X;
-	const float STEP = RATIO_X / WIDTH;
-	const int ITERATIONS = iterations;
-
-	const int total_pixels = HEIGHT * WIDTH;
-	const int pixels_per_process = total_pixels / nproc;
-	const int start_index = myid * pixels_per_process;
-	const int end_index = (myid + 1) * pixels_per_process;
+		// Gather results from all processes to the root process
+		vector<int> recv_counts(nproc), displacements(nproc);
+		for (int rank = 0; rank < nproc; rank++)
+		{
+			recv_counts[rank] = ranges[rank].row_count * WIDTH;
+			displacements[rank] = ranges[rank].first_row * WIDTH;
+		}
+		err = MPI_Gatherv(sub_image, pixels_per_process, MPI_INT,
+						  image, recv_counts.data(),
+						  displacements.data(), MPI_INT, 0,
+						  MPI_COMM_WORLD);
+		checkMPIError(err, "MPI_Gatherv failed.");
+		auto end_time = chrono::steady_clock::now();
+		phase_times.seconds[phases::COMMUNICATION] =
+			chrono::duration<double>(end_time - communication_start)
+				.count();
+		run_phases.add("Wait", phase_times.seconds[phases::WAIT]);
+		run_phases.add("Gather",
+					   phase_times.seconds[phases::COMMUNICATION]);
+		elapsed_seconds =
+			chrono::duration<double>(end_time - start_time).count();
 
-	int *image = nullptr;
-	int *sub_image = new int[pixels_per_process]();
+		if (myid == 0)
+		{
+			// Write the result to a file, opening the stream counts
+			// towards the write phase
+			logutils::ScopedTimer write_timer(run_phases, "Write");
+			ofstream matrix_out;
 
-	if (myid == 0)
-	{
-		image = new int[total_pixels];
+			matrix_out.open(output_file, ios::trunc);
+			std::cout << "LOG: matrix out stream opened"
+					  << std::endl;
+			if (!matrix_out.is_open())
+			{
+				cerr << "Unable to open file." << endl;
+				MPI_Abort(MPI_COMM_WORLD, -3);
+			}
+			auto start_time_out = chrono::steady_clock::now();
+			std::cout << "Starting writing to out file..."
+					  << std::endl;
+			for (int row = 0; row < HEIGHT; row++)
+			{
+				for (int col = 0; col < WIDTH; col++)
+				{
+					matrix_out << image[row * WIDTH + col];
+					if (col < WIDTH - 1)
+						matrix_out << ',';
+				}
+				if (row < HEIGHT - 1)
+					matrix_out << endl;
+			}
+			matrix_out.close();
+			auto end_time_out = chrono::steady_clock::now();
+			double elapsed_seconds_out =
+				chrono::duration<double>(end_time_out -
+										 start_time_out)
+					.count();
+			phase_times.seconds[phases::WRITE] =
+				elapsed_seconds_out;
+			write_timer.stop();
+			std::cout << "Finished writing to out file in "
+					  << elapsed_seconds_out << " seconds"
+					  << std::endl;
+			delete[] image;
+		}
 	}
-	// Setting max threads per node
-	int threads_used = omp_get_max_threads();
-	omp_set_num_threads(threads_used);
 
-	auto start_time = chrono::steady_clock::now();
+	// Phase statistics across ranks, the detail is only gathered
+	// when requested
+	const vector<phases::PhaseSummary> phase_summary =
+		phases::reducePhases(phase_times, MPI_COMM_WORLD, 0);
+	vector<phases::PhaseTimes> rank_phases;
+	if (args.rank_timings)
+		rank_phases =
+			phases::gatherPhases(phase_times, MPI_COMM_WORLD, 0);
 
-#pragma omp parallel for schedule(dynamic) default(none)           \
-	firstprivate(sub_image, ITERATIONS) shared(WIDTH, STEP)
-	for (int pos = start_index; pos < end_index; pos++)
+	// Checkpoint overhead, the checkpoint is dropped once the image
+	// is complete
+	double checkpoint_overhead =
+		checkpoint_writer.overheadSeconds();
+	double checkpoint_overhead_max = 0.0,
+		   checkpoint_overhead_sum = 0.0;
+	int checkpoint_count = checkpoint_writer.checkpoints();
+	int checkpoint_count_max = 0, restored_rows_sum = 0;
+	if (checkpoint_writer.enabled())
 	{
-		const int row = pos / WIDTH;
-		const int col = pos % WIDTH;
-		const complex<double> c(col * STEP + MIN_X,
-								row * STEP + MIN_Y);
+		MPI_Reduce(&checkpoint_overhead, &checkpoint_overhead_max,
+				   1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&checkpoint_overhead, &checkpoint_overhead_sum,
+				   1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&checkpoint_count, &checkpoint_count_max, 1,
+				   MPI_INT, MPI_MAX, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&restored_rows, &restored_rows_sum, 1, MPI_INT,
+				   MPI_SUM, 0, MPI_COMM_WORLD);
+		checkpoint::clear(checkpoint_dir, MPI_COMM_WORLD);
+	}
 
-		int iter = 1;
-		complex<double> z(0, 0);
-		for (; iter <= ITERATIONS; iter++)
+	// Executed work of the rows computed in this run, rows restored
+	// from a checkpoint did not cost anything
+	logutils::ScopedTimer stats_timer(run_phases, "Stats");
+	iterstats::Stats iter_stats;
+	iter_stats.iterations = ITERATIONS;
+	iter_stats.histogram.assign(iterstats::bucketCount(ITERATIONS),
+								0);
+	for (int row = 0; row < local_rows;)
+	{
+		int run_end = row;
+		while (run_end < local_rows && !row_done[run_end])
+			run_end++;
+		if (run_end > row)
+			iterstats::merge(
+				iter_stats,
+				iterstats::count(
+					sub_image + row * WIDTH,
+					static_cast<size_t>(run_end - row) * WIDTH,
+					ITERATIONS));
+		row = run_end + 1;
+	}
+	{
+		long long local_totals[3] = {iter_stats.pixels,
+									 iter_stats.bounded,
+									 iter_stats.executed};
+		long long totals[3] = {0, 0, 0};
+		MPI_Reduce(local_totals, totals, 3, MPI_LONG_LONG, MPI_SUM,
+				   0, MPI_COMM_WORLD);
+		vector<long long> local_histogram(
+			iter_stats.histogram.begin(),
+			iter_stats.histogram.end());
+		vector<long long> histogram(local_histogram.size(), 0);
+		MPI_Reduce(local_histogram.data(), histogram.data(),
+				   static_cast<int>(histogram.size()),
+				   MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (myid == 0)
 		{
-			z = (z * z) + c;
+			iter_stats.pixels = totals[0];
+			iter_stats.bounded = totals[1];
+			iter_stats.executed = totals[2];
+			iter_stats.histogram.assign(histogram.begin(),
+										histogram.end());
+		}
+	}
+	stats_timer.stop();
+	// Rates refer to the slowest rank's compute time
+	const double compute_seconds_max =
+		phase_summary.empty() ? 0.0
+							  : phase_summary[phases::COMPUTE].max;
 
-			// If the magnitude exceeds 2, the point is not in the
-			// Mandelbrot set if (abs(z) >= 2)
-			if (((z.real() * z.real()) + (z.imag() * z.imag())) >=
-				4)
+	// Thread accounting of every rank, the trace is assembled on
+	// rank 0 with one timeline process per rank
+	vector<vector<threadtrace::ThreadSummary>> rank_threads;
+	if (trace.enabled())
+	{
+		rank_threads = gatherThreadSummaries(
+			trace.threadSummaries(), MPI_COMM_WORLD, 0);
+		if (!args.trace_file.empty())
+		{
+			const vector<string> event_blocks =
+				gather::gatherStrings(trace.traceEvents(myid),
+									  MPI_COMM_WORLD, 0);
+			if (myid == 0)
 			{
-				sub_image[pos - start_index] = iter;
-				break;
+				if (threadtrace::writeChromeTrace(args.trace_file,
+												  event_blocks))
+					cout << "Trace written to " << args.trace_file
+						 << endl;
+				else
+					cerr << "Unable to write trace file." << endl;
 			}
 		}
 	}
 
-	// Gather results from all processes to the root process
-	err =
-		MPI_Gather(sub_image, pixels_per_process, MPI_INT, image,
-				   pixels_per_process, MPI_INT, 0, MPI_COMM_WORLD);
-	checkMPIError(err, "MPI_Gather failed.");
-
+	// Predicted (probe) and measured (compute time) imbalance
+	const double predicted_imbalance =
+		partition::imbalancePercent(predicted_costs);
+	const double actual_imbalance =
+		phase_summary.empty()
+			? 0.0
+			: phase_summary[phases::COMPUTE].imbalance_percent;
 	if (myid == 0)
 	{
-		auto end_time = chrono::steady_clock::now();
-		double elapsed_seconds =
-			chrono::duration<double>(end_time - start_time).count();
+		cout << "Partition: " << args.partition
+			 << " predicted imbalance: " << predicted_imbalance
+			 << "% actual imbalance: " << actual_imbalance << "%"
+			 << endl;
+		if (trace.enabled())
+		{
+			vector<threadtrace::ThreadSummary> all_threads;
+			for (const auto &threads : rank_threads)
+				all_threads.insert(all_threads.end(),
+								   threads.begin(), threads.end());
+			const threadtrace::Summary all_summary =
+				threadtrace::summarize(all_threads);
+			cout << "Thread accounting: " << all_summary.threads
+				 << " threads, " << all_summary.chunks
+				 << " chunks, " << all_summary.iterations
+				 << " iterations, imbalance ratio "
+				 << all_summary.imbalance_ratio << endl;
+		}
+		if (checkpoint_writer.enabled())
+		{
+			cout << "Checkpoint: restored " << restored_rows_sum
+				 << " rows, overhead " << checkpoint_overhead_max
+				 << " seconds (max per rank)." << endl;
+		}
+		cout << "Throughput: "
+			 << iter_stats.gigaIterationsPerSecond(
+					compute_seconds_max)
+			 << " GIterations/s, "
+			 << iter_stats.gigaFlopsPerSecond(compute_seconds_max)
+			 << " GFLOP/s." << endl;
 		cout << "Time elapsed: " << fixed << setprecision(2)
 			 << elapsed_seconds << " seconds." << endl;
 		//? Create csv file
 		// Create CSV filename
-		std::string csv_filename = createCsvFilename(argv[1], "");
+		logutils::ScopedTimer probe_timer(run_phases, "CSV probe");
+		// Other formulas get a CSV of their own, their rows do not
+		// compare with the Mandelbrot set
+		std::string csv_filename = createCsvFilename(
+			output_file, other_formula ? "_formula" : "");
 		std::cout << "Created csv file: " << csv_filename
 				  << std::endl;
 
 		// Define header
 		std::string header =
 			"DateTime,Program,Iterations,Resolution,Width,Height,"
-			"Step,NProcesses,Threads,Time (seconds)";
+			"Step,NProcesses,Threads,Time (seconds)" +
+			phases::csvHeaderColumns() +
+			iterstats::csvHeaderColumns() +
+			run_phases.csvHeaderColumns();
+		if (other_formula)
+			header += formula::csvHeaderColumns();
 
 		// Check if CSV has header
-
+		bool has_header =
+			logutils::csvFileHasHeader(csv_filename, header);
 		ofstream csv_stream(csv_filename, std::ios::app);
-		bool has_header = csvFileHasHeader(csv_filename, header);
+		probe_timer.stop();
 		if (csv_stream.is_open())
 		{
 			if (!has_header)
@@ -692,8 +1192,15 @@ int main(int argc, char **argv)
 					   << "," << iterations << ","
 					   << resolution_value << "," << WIDTH << ","
 					   << HEIGHT << "," << STEP << "," << nproc
-					   << "," << "," << threads_used << ","
-					   << elapsed_seconds << endl;
+					   << "," << threads_used << ","
+					   << elapsed_seconds
+					   << phases::csvColumns(phase_summary)
+					   << iterstats::csvColumns(iter_stats,
+												compute_seconds_max)
+					   << run_phases.csvColumns();
+			if (other_formula)
+				csv_stream << formula::csvColumns(formula_params);
+			csv_stream << endl;
 			csv_stream.close();
 			cout << "CSV entry added successfully." << endl;
 
@@ -706,7 +1213,7 @@ int main(int argc, char **argv)
 
 		//? Create log file path
 		string log_file =
-			create_log_file_name(argv[1], "_openMPI_");
+			create_log_file_name(output_file, "_openMPI_");
 		ofstream log(log_file, std::ios::app);
 		std::cout << "LOG: log stream opened" << std::endl;
 		if (log.is_open())
@@ -719,7 +1226,77 @@ int main(int argc, char **argv)
 				<< "\tProcesses per Node:\t"
 				<< (nproc > 0 ? (total_pixels / nproc) : 0)
 				<< "\tTime:\t" << elapsed_seconds << " seconds"
-				<< endl;
+				<< endl
+				<< iterstats::describe(iter_stats,
+									   compute_seconds_max)
+				<< endl
+				<< run_phases.describe();
+			if (other_formula)
+				log << formula::describe(formula_params) << endl;
+			// Rank/thread layout chosen by every rank
+			for (const string &line : layout_lines)
+				log << "\t" << line << endl;
+			log << "\tPartition:\t" << args.partition
+				<< "\tPredicted imbalance:\t" << predicted_imbalance
+				<< "\t%\tActual imbalance:\t" << actual_imbalance
+				<< "\t%" << endl;
+			for (int rank = 0; rank < nproc; rank++)
+			{
+				log << "\tRank:\t" << rank << "\tRows:\t"
+					<< ranges[rank].first_row << "-"
+					<< ranges[rank].first_row +
+						   ranges[rank].row_count
+					<< "\tPredicted cost:\t"
+					<< (predicted_costs.empty()
+							? 0.0
+							: predicted_costs[rank])
+					<< endl;
+			}
+			if (checkpoint_writer.enabled())
+			{
+				log << "\tCheckpoint interval:\t"
+					<< args.checkpoint_interval
+					<< "\tseconds\tCheckpoints:\t"
+					<< checkpoint_count_max << "\tRestored rows:\t"
+					<< restored_rows_sum << "\tOverhead max:\t"
+					<< checkpoint_overhead_max
+					<< "\tseconds\tOverhead mean:\t"
+					<< checkpoint_overhead_sum / nproc
+					<< "\tseconds" << endl;
+			}
+			for (int phase = 0; phase < phases::PHASE_COUNT;
+				 phase++)
+			{
+				const phases::PhaseSummary &summary =
+					phase_summary[phase];
+				log << "\tPhase:\t" << phases::phaseName(phase)
+					<< "\tMin:\t" << summary.min << "\tMean:\t"
+					<< summary.mean << "\tMax:\t" << summary.max
+					<< "\tImbalance:\t" << summary.imbalance_percent
+					<< "\t%\tStraggler:\t" << summary.max_rank
+					<< endl;
+			}
+			if (trace.enabled())
+			{
+				vector<threadtrace::ThreadSummary> all_threads;
+				for (const auto &threads : rank_threads)
+					all_threads.insert(all_threads.end(),
+									   threads.begin(),
+									   threads.end());
+				log << "\tThread accounting:"
+					<< threadtrace::describe(
+						   threadtrace::summarize(all_threads), {});
+				for (int rank = 0; rank < nproc; rank++)
+				{
+					log << "\tRank " << rank << " threads:"
+						<< threadtrace::describe(
+							   threadtrace::summarize(
+								   rank_threads[rank]),
+							   rank_threads[rank],
+							   "Rank " + to_string(rank) +
+								   " thread");
+				}
+			}
 
 			log.close();
 		}
@@ -727,37 +1304,19 @@ int main(int argc, char **argv)
 		{
 			std::cerr << "Unable to open log file." << endl;
 		}
-		// Write the result to a file
-		ofstream matrix_out;
-
-		matrix_out.open(argv[1], ios::trunc);
-		std::cout << "LOG: matrix out stream opened" << std::endl;
-		if (!matrix_out.is_open())
-		{
-			cerr << "Unable to open file." << endl;
-			MPI_Abort(MPI_COMM_WORLD, -3);
-		}
-		auto start_time_out = chrono::steady_clock::now();
-		std::cout << "Starting writing to out file..." << std::endl;
-		for (int row = 0; row < HEIGHT; row++)
+		if (!iterstats::appendHistogramCsv(
+				createCsvFilename(output_file, "_hist_"),
+				getCurrentTimestamp(), fileName, resolution_value,
+				iter_stats))
+			cerr << "Unable to open histogram CSV file." << endl;
+		if (args.rank_timings)
 		{
-			for (int col = 0; col < WIDTH; col++)
-			{
-				matrix_out << image[row * WIDTH + col];
-				if (col < WIDTH - 1)
-					matrix_out << ',';
-			}
-			if (row < HEIGHT - 1)
-				matrix_out << endl;
+			const string detail_file =
+				createCsvFilename(output_file, "_ranks");
+			if (phases::writeRankDetail(detail_file, rank_phases))
+				cout << "Rank detail written to " << detail_file
+					 << endl;
 		}
-		auto end_time_out = chrono::steady_clock::now();
-		double elapsed_seconds_out =
-			chrono::duration<double>(end_time_out - start_time_out)
-				.count();
-		std::cout << "Finished writing to out file in "
-				  << elapsed_seconds << "seconds" << std::endl;
-		matrix_out.close();
-		delete[] image;
 		std::cout << "Exiting..." << std::endl;
 	}
 	delete[] sub_image;
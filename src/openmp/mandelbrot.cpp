@@ -1,213 +1,1303 @@
-#include <omp.h>
-
-#include <LogUtils.h>
-#include <chrono>
-#include <complex>
-#include <filesystem>
-#include <fstream>
-#include <iostream>
-#include <string>
-namespace MandelbrotSet
-{
-// Ranges of the set
-constexpr float MIN_X = -2.0;
-constexpr float MAX_X = 1.0;
-constexpr float MIN_Y = -1.0;
-constexpr float MAX_Y = 1.0;
-
-// Image ratio
-constexpr float RATIO_X = (MAX_X - MIN_X);
-constexpr float RATIO_Y = (MAX_Y - MIN_Y);
-} // namespace MandelbrotSet
-namespace fs = std::filesystem;
-
-#define SCHEDULING_STRING "RUNTIME"
-#define SCHEDULING_TYPE runtime
-#ifdef SCHEDULE_DYNAMIC
-#undef SCHEDULING_STRING
-#undef SCHEDULING_TYPE
-#define SCHEDULING_TYPE dynamic
-#define SCHEDULING_STRING "DYNAMIC"
-#elif defined(SCHEDULE_STATIC)
-#undef SCHEDULING_STRING
-#undef SCHEDULING_TYPE
-#define SCHEDULING_TYPE static
-#define SCHEDULING_STRING "STATIC"
-#elif defined(SCHEDULE_GUIDED)
-#undef SCHEDULING_STRING
-#undef SCHEDULING_TYPE
-#define SCHEDULING_TYPE guided
-#define SCHEDULING_STRING "GUIDED"
-#endif
-
-using namespace std;
-using namespace MandelbrotSet;
-
-void computeMandelbrot(int *image, int _iterations, int _WIDTH,
-					   int _HEIGHT, float _STEP)
-{
-	// region provided by *image is shared among threads, the
-	// pointer is private
-#pragma omp parallel for schedule(SCHEDULING_TYPE) default(none)   \
-	firstprivate(image, _iterations)                               \
-	shared(_WIDTH, _HEIGHT, _STEP)
-	for (int pos = 0; pos < _HEIGHT * _WIDTH; pos++)
-	{
-		image[pos] = 0;
-		const int row = pos / _WIDTH;
-		const int col = pos % _WIDTH;
-		const complex<double> c(col * _STEP + MIN_X,
-								row * _STEP + MIN_Y);
-
-		// z = z^2 + c
-		complex<double> z(0, 0);
-		for (int i = 1; i <= _iterations; i++)
-		{
-			z = z * z + c;
-			// If it is convergent
-			if (abs(z) >= 2)
-			{
-				image[pos] = i;
-				break;
-			}
-		}
-	}
-}
-
-int main(int argc, char **argv)
-{
-	cout.sync_with_stdio(false);
-	fs::path filePath = argv[0];
-	string fileName = filePath.filename().string();
-	// Parse command line arguments
-	cmdParse::ParsedArgs args =
-		cmdParse::parse_cmd_arguments(argc, argv);
-	const int iterations = args.iterations;
-	const int resolution_value = args.resolution;
-	fs::path output_file_path(args.output_file);
-	int threads_used = omp_get_max_threads();
-	if (args.threads_num > 0)
-	{
-		threads_used = args.threads_num;
-		omp_set_num_threads(threads_used);
-	}
-
-	// Image size
-	const int WIDTH =
-		static_cast<int>(MandelbrotSet::RATIO_X * resolution_value);
-	const int HEIGHT =
-		static_cast<int>(MandelbrotSet::RATIO_Y * resolution_value);
-	const float STEP = MandelbrotSet::RATIO_X / WIDTH;
-
-	int *const image = new int[HEIGHT * WIDTH];
-	const size_t image_size = HEIGHT * WIDTH;
-	fill_n(image, image_size, -1);
-	cout << "Calculating Mandelbrot set with " << threads_used
-		 << " threads with " << iterations << " iterations."
-		 << endl;
-
-	const auto start = std::chrono::steady_clock::now();
-	computeMandelbrot(image, iterations, WIDTH, HEIGHT, STEP);
-	const auto end = std::chrono::steady_clock::now();
-
-	chrono::duration<double> duration = end - start;
-	cout << "Time elapsed: " << duration.count() << " seconds."
-		 << endl;
-	//? CSV
-	const string scheduling_type = SCHEDULING_STRING;
-	const string additinonalName = "_openmp_";
-
-	const string csvFile =
-		logutils::createCsvFilename(argv[1], additinonalName);
-	const string header =
-		"DateTime,Program,Iterations,Resolution,Width,Height,Step,"
-		"Scheduling,Threads,Time (seconds)";
-	bool has_header = logutils::csvFileHasHeader(csvFile, header);
-	ofstream csv(csvFile, ios::app);
-	if (csv.is_open())
-	{
-		if (!has_header)
-		{
-			cout << "Adding header to csv file." << endl;
-			csv << header << endl;
-		}
-		csv << logutils::getCurrentTimestamp() << "," << fileName
-			<< "," << iterations << "," << resolution_value << ","
-			<< WIDTH << "," << HEIGHT << "," << STEP << ","
-			<< SCHEDULING_STRING << "," << threads_used << ","
-			<< duration.count() << endl;
-		csv.close();
-		cout << "CSV entry added successfully." << endl;
-	}
-	else
-	{
-		cerr << "Unable to open CSV file." << endl;
-	}
-	//? log
-	const string log_file =
-		logutils::create_log_file_name(argv[1], additinonalName);
-	ofstream log(log_file, ios::app);
-	if (log.is_open())
-	{
-		log << "Date:\t" << __DATE__ << " " << __TIME__
-			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
-			<< iterations << "\tResolution:\t" << resolution_value
-			<< "\tWidth:\t" << WIDTH << "\tHeight:\t" << HEIGHT
-			<< "\tStep:\t" << STEP << "\tScheduling:\t"
-			<< SCHEDULING_STRING << "\tThreads:\t" << threads_used
-			<< "\tTime:\t" << duration.count() << "\tseconds"
-			<< endl;
-		log.close();
-		cout << "Log entry added successfully." << endl;
-	}
-	else
-	{
-		cerr << "Unable to open log file." << endl;
-	}
-
-	try
-	{
-		fs::create_directories(output_file_path.parent_path());
-	}
-	catch (const fs::filesystem_error &e)
-	{
-		cout << "Error creating directories: " << e.what() << endl;
-		return -13;
-	}
-	// Write the result to a file
-	string new_name = to_string(threads_used) + "_threads_" +
-					  to_string(iterations) + "_iterations_" +
-					  to_string(resolution_value) + "_resolution";
-	// Get the original filename stem and extension
-	string filename_stem = output_file_path.stem().string();
-	string extension = output_file_path.extension().string();
-	string new_filename =
-		filename_stem + "_" + new_name + extension;
-	// Update the output_file_path with the new filename
-	output_file_path =
-		output_file_path.parent_path() / new_filename;
-	ofstream matrix_out(output_file_path, ios::trunc);
-	cout << "Writing to file: " << output_file_path << endl << endl;
-	if (!matrix_out.is_open())
-	{
-		cout << "Unable to open file." << endl;
-		return -14;
-	}
-
-	for (int row = 0; row < HEIGHT; row++)
-	{
-		for (int col = 0; col < WIDTH; col++)
-		{
-			matrix_out << image[row * WIDTH + col];
-
-			if (col < WIDTH - 1)
-				matrix_out << ',';
-		}
-		if (row < HEIGHT - 1)
-			matrix_out << endl;
-	}
-	matrix_out.close();
-
-	delete[] image; // It's here for coding style, but useless
-	return 0;
+#include <omp.h>
+
+#include <Buddhabrot.h>
+#include <DeepZoom.h>
+#include <DistanceEstimator.h>
+#include <EnergyProbe.h>
+#include <ImageIO.h>
+#include <IterationStats.h>
+#include <LogUtils.h>
+#include <MandelbrotKernels.h>
+#include <PerfCounters.h>
+#include <PrecisionTiles.h>
+#include <Progressive.h>
+#include <Supersample.h>
+#include <ThreadTrace.h>
+#include <ZoomAnimation.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+namespace MandelbrotSet
+{
+// Ranges of the set
+constexpr float MIN_X = -2.0;
+constexpr float MAX_X = 1.0;
+constexpr float MIN_Y = -1.0;
+constexpr float MAX_Y = 1.0;
+
+// Image ratio
+constexpr float RATIO_X = (MAX_X - MIN_X);
+constexpr float RATIO_Y = (MAX_Y - MIN_Y);
+
+// Ulps of its coordinates a pixel of a runtime viewport or a frame
+// must span at least, in the precision it is mapped with; below
+// that the grid turns into blocks
+constexpr double MIN_VIEWPORT_ULPS = 8.0;
+} // namespace MandelbrotSet
+namespace fs = std::filesystem;
+
+#define SCHEDULING_STRING "RUNTIME"
+#define SCHEDULING_TYPE kernels::Schedule::RUNTIME
+#ifdef SCHEDULE_DYNAMIC
+#undef SCHEDULING_STRING
+#undef SCHEDULING_TYPE
+#define SCHEDULING_TYPE kernels::Schedule::DYNAMIC
+#define SCHEDULING_STRING "DYNAMIC"
+#elif defined(SCHEDULE_STATIC)
+#undef SCHEDULING_STRING
+#undef SCHEDULING_TYPE
+#define SCHEDULING_TYPE kernels::Schedule::STATIC
+#define SCHEDULING_STRING "STATIC"
+#elif defined(SCHEDULE_GUIDED)
+#undef SCHEDULING_STRING
+#undef SCHEDULING_TYPE
+#define SCHEDULING_TYPE kernels::Schedule::GUIDED
+#define SCHEDULING_STRING "GUIDED"
+#endif
+
+using namespace std;
+using namespace MandelbrotSet;
+
+void computeMandelbrot(
+	int *image, int _iterations, int _WIDTH, int _HEIGHT,
+	float _STEP, float _MIN_X = MIN_X, float _MIN_Y = MIN_Y,
+	threadtrace::Recorder *trace = nullptr,
+	progress::Reporter *progress = nullptr,
+	const formula::Params &params = formula::Params())
+{
+	kernels::computeOpenMP(image, _iterations, _WIDTH, _HEIGHT,
+						   _STEP, _MIN_X, _MIN_Y, SCHEDULING_TYPE,
+						   trace, progress, params);
+}
+
+/**
+ * @brief Whether a `width * height` grid of pixels `spacing` apart
+ * around (center_x, center_y) spans `MIN_VIEWPORT_ULPS` ulps of a
+ * precision with machine epsilon `epsilon` per pixel.
+ */
+bool resolvesViewport(double center_x, double center_y,
+					  double spacing, int width, int height,
+					  double epsilon)
+{
+	const double extent =
+		max({fabs(center_x) + spacing * width / 2,
+			 fabs(center_y) + spacing * height / 2,
+			 spacing * max(width, height)});
+	return spacing >= MIN_VIEWPORT_ULPS * epsilon * extent;
+}
+
+/**
+ * @brief Appends the CSV row and the log entry of a mode that
+ * writes files of its own, named with `_openmp_<mode>_`.
+ *
+ * @param scheduling Whether the mode runs the selected schedule and
+ * reports it in a Scheduling column.
+ * @param extra_header Columns after "Time (seconds)", each prefixed
+ * with a comma; `extra_columns` holds the matching values.
+ * @param description Second line of the log entry.
+ */
+void appendModeReport(const cmdParse::ParsedArgs &args,
+					  const string &fileName, const string &mode,
+					  int threads_used, int WIDTH, int HEIGHT,
+					  float STEP, bool scheduling, double seconds,
+					  const string &extra_header,
+					  const string &extra_columns,
+					  const string &description)
+{
+	const string suffix = "_openmp_" + mode + "_";
+	//? CSV
+	const string csvFile =
+		logutils::createCsvFilename(args.output_file, suffix);
+	const string header =
+		string("DateTime,Program,Iterations,Resolution,Width,"
+			   "Height,Step,") +
+		(scheduling ? "Scheduling," : "") +
+		"Threads,Time (seconds)" + extra_header;
+	bool has_header = logutils::csvFileHasHeader(csvFile, header);
+	ofstream csv(csvFile, ios::app);
+	if (csv.is_open())
+	{
+		if (!has_header)
+		{
+			cout << "Adding header to csv file." << endl;
+			csv << header << endl;
+		}
+		csv << logutils::getCurrentTimestamp() << "," << fileName
+			<< "," << args.iterations << "," << args.resolution
+			<< "," << WIDTH << "," << HEIGHT << "," << STEP << ",";
+		if (scheduling)
+			csv << SCHEDULING_STRING << ",";
+		csv << threads_used << "," << seconds << extra_columns
+			<< endl;
+		csv.close();
+		cout << "CSV entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open CSV file." << endl;
+	}
+	//? log
+	const string log_file =
+		logutils::create_log_file_name(args.output_file, suffix);
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+	{
+		log << "Date:\t" << __DATE__ << " " << __TIME__
+			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
+			<< args.iterations << "\tResolution:\t"
+			<< args.resolution << "\tWidth:\t" << WIDTH
+			<< "\tHeight:\t" << HEIGHT << "\tStep:\t" << STEP;
+		if (scheduling)
+			log << "\tScheduling:\t" << SCHEDULING_STRING;
+		log << "\tThreads:\t" << threads_used << "\tTime:\t"
+			<< seconds << "\tseconds" << endl
+			<< description << endl;
+		log.close();
+		cout << "Log entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open log file." << endl;
+	}
+}
+
+/**
+ * @brief Renders `args.frames` frames, each `args.zoom_factor`
+ * times deeper around `args.center_x/y`.
+ *
+ * Frame k + 1 is computed while the writer thread writes frame k,
+ * at most two frames wait for it. With a power-of-two factor, the
+ * pixels shared with the previous frame are copied instead of
+ * iterated.
+ */
+int renderAnimation(const cmdParse::ParsedArgs &args,
+					const string &fileName, int threads_used,
+					int WIDTH, int HEIGHT)
+{
+	const int iterations = args.iterations;
+	const int frames = args.frames;
+	const int factor = animation::reuseFactor(args.zoom_factor);
+	const size_t image_size = static_cast<size_t>(HEIGHT) * WIDTH;
+	cout << "Rendering " << frames << " frames with "
+		 << threads_used << " threads with " << iterations
+		 << " iterations, zoom factor " << args.zoom_factor
+		 << (factor > 0 ? ", reusing shared pixels." : ".") << endl;
+
+	fs::path output_file_path(args.output_file);
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	const string new_name = to_string(threads_used) + "_threads_" +
+							to_string(iterations) + "_iterations_" +
+							to_string(args.resolution) +
+							"_resolution";
+	const string filename_stem = output_file_path.stem().string();
+	const string extension = output_file_path.extension().string();
+
+	animation::Frame frame;
+	frame.center_x = args.center_x;
+	frame.center_y = args.center_y;
+	frame.step = RATIO_X / (args.zoom * WIDTH);
+	// The frames are mapped in double, the deepest one must still
+	// be resolved
+	const double last_step =
+		frame.step / pow(args.zoom_factor, frames - 1);
+	if (!resolvesViewport(frame.center_x, frame.center_y,
+						  min(frame.step, last_step), WIDTH, HEIGHT,
+						  numeric_limits<double>::epsilon()))
+	{
+		cerr << "Frame " << frames << " of --zoom-factor "
+			 << args.zoom_factor << " needs a pixel spacing of "
+			 << last_step
+			 << ", below double resolution; use --deep-zoom "
+				"<re>,<im>,<spacing> or fewer --frames instead."
+			 << endl;
+		return -1;
+	}
+	double zoom = args.zoom;
+	vector<double> zooms, steps, compute_seconds;
+	vector<int64_t> reused;
+	shared_ptr<const vector<int>> previous;
+	animation::Writer writer(WIDTH, HEIGHT, 2);
+	const auto start = std::chrono::steady_clock::now();
+	for (int k = 0; k < frames; k++)
+	{
+		auto image = make_shared<vector<int>>(image_size);
+		const auto frame_start = std::chrono::steady_clock::now();
+		reused.push_back(animation::renderFrame(
+			image->data(), iterations, WIDTH, HEIGHT, frame,
+			SCHEDULING_TYPE, previous ? previous->data() : nullptr,
+			factor));
+		compute_seconds.push_back(
+			chrono::duration<double>(
+				std::chrono::steady_clock::now() - frame_start)
+				.count());
+		zooms.push_back(zoom);
+		steps.push_back(frame.step);
+
+		ostringstream frame_name;
+		frame_name << filename_stem << "_" << new_name << "_frame_"
+				   << setw(4) << setfill('0') << k << extension;
+		const fs::path frame_path =
+			output_file_path.parent_path() / frame_name.str();
+		cout << "Frame " << k << ": zoom " << zoom << ", "
+			 << compute_seconds.back() << " seconds, writing to "
+			 << frame_path << endl;
+		writer.push(image, frame_path.string());
+		previous = image;
+		zoom *= args.zoom_factor;
+		frame.step /= args.zoom_factor;
+	}
+	const vector<double> write_seconds = writer.finish();
+	const chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start;
+	if (writer.failed())
+	{
+		cout << "Unable to write every frame." << endl;
+		return -14;
+	}
+	double total_compute = 0.0, total_write = 0.0;
+	int64_t total_reused = 0;
+	for (int k = 0; k < frames; k++)
+	{
+		total_compute += compute_seconds[k];
+		total_write += write_seconds[k];
+		total_reused += reused[k];
+	}
+	cout << "Time elapsed: " << duration.count() << " seconds, "
+		 << total_compute << " computing and " << total_write
+		 << " writing." << endl
+		 << "Reused pixels: " << total_reused << " of "
+		 << image_size * frames << "." << endl;
+
+	//? CSV, one row per frame
+	const string csvFile = logutils::createCsvFilename(
+		args.output_file, "_openmp_animation_");
+	const string header = "DateTime,Program,Iterations,Resolution,"
+						  "Width,Height,Scheduling,"
+						  "Threads,Frame,Zoom,Step,Center X,Center "
+						  "Y,Compute (s),Write (s),"
+						  "Reused Pixels";
+	bool has_header = logutils::csvFileHasHeader(csvFile, header);
+	ofstream csv(csvFile, ios::app);
+	if (csv.is_open())
+	{
+		if (!has_header)
+		{
+			cout << "Adding header to csv file." << endl;
+			csv << header << endl;
+		}
+		const string timestamp = logutils::getCurrentTimestamp();
+		for (int k = 0; k < frames; k++)
+			csv << timestamp << "," << fileName << "," << iterations
+				<< "," << args.resolution << "," << WIDTH << ","
+				<< HEIGHT << "," << SCHEDULING_STRING << ","
+				<< threads_used << "," << k << "," << zooms[k]
+				<< "," << setprecision(17) << steps[k]
+				<< setprecision(6) << "," << args.center_x << ","
+				<< args.center_y << "," << compute_seconds[k] << ","
+				<< write_seconds[k] << "," << reused[k] << endl;
+		csv.close();
+		cout << "CSV entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open CSV file." << endl;
+	}
+	//? log
+	const string log_file = logutils::create_log_file_name(
+		args.output_file, "_openmp_animation_");
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+	{
+		log << "Date:\t" << __DATE__ << " " << __TIME__
+			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
+			<< iterations << "\tResolution:\t" << args.resolution
+			<< "\tWidth:\t" << WIDTH << "\tHeight:\t" << HEIGHT
+			<< "\tScheduling:\t" << SCHEDULING_STRING
+			<< "\tThreads:\t" << threads_used << "\tTime:\t"
+			<< duration.count() << "\tseconds" << endl
+			<< "\tFrames:\t" << frames << "\tZoom factor:\t"
+			<< args.zoom_factor << "\tCompute:\t" << total_compute
+			<< "\tseconds\tWrite:\t" << total_write
+			<< "\tseconds\tReused pixels:\t" << total_reused
+			<< endl;
+		log.close();
+		cout << "Log entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open log file." << endl;
+	}
+	return 0;
+}
+
+/**
+ * @brief Orbit-density image of `args.buddhabrot_samples` random c
+ * values over the viewport, written in the binary format.
+ */
+int renderBuddhabrot(const cmdParse::ParsedArgs &args,
+					 const string &fileName, int threads_used,
+					 int WIDTH, int HEIGHT, float STEP, float min_x,
+					 float min_y)
+{
+	const int iterations = args.iterations;
+	cout << "Sampling " << args.buddhabrot_samples
+		 << " orbits with " << threads_used << " threads with "
+		 << iterations << " iterations"
+		 << (args.importance ? ", importance sampled." : ".")
+		 << endl;
+	buddhabrot::Window window;
+	window.width = WIDTH;
+	window.height = HEIGHT;
+	window.min_x = min_x;
+	window.min_y = min_y;
+	window.step = STEP;
+
+	const auto start = std::chrono::steady_clock::now();
+	buddhabrot::Importance importance;
+	if (args.importance)
+		importance = buddhabrot::buildImportance(iterations);
+	const size_t image_size = static_cast<size_t>(HEIGHT) * WIDTH;
+	vector<double> histogram(image_size, 0.0);
+	const buddhabrot::Stats stats = buddhabrot::accumulate(
+		histogram.data(), window, iterations,
+		args.buddhabrot_samples, args.seed, &importance);
+	const chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start;
+	cout << "Time elapsed: " << duration.count() << " seconds, "
+		 << stats.sample_seconds << " sampling and "
+		 << stats.reduce_seconds << " reducing." << endl
+		 << stats.escaped << " of " << stats.samples
+		 << " orbits escaped, " << stats.orbit_points
+		 << " points in the image." << endl;
+
+	fs::path output_file_path(args.output_file);
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	const string new_name = to_string(threads_used) + "_threads_" +
+							to_string(iterations) + "_iterations_" +
+							to_string(args.resolution) +
+							"_resolution";
+	output_file_path = output_file_path.parent_path() /
+					   (output_file_path.stem().string() + "_" +
+						new_name + "_buddhabrot.mbin");
+	const vector<int> counts =
+		buddhabrot::toCounts(histogram.data(), image_size);
+	cout << "Writing to file: " << output_file_path << endl << endl;
+	if (!imageio::writeBinary(output_file_path.string(),
+							  counts.data(), WIDTH, HEIGHT, 0,
+							  HEIGHT))
+	{
+		cout << "Unable to open file." << endl;
+		return -14;
+	}
+
+	appendModeReport(args, fileName, "buddhabrot", threads_used,
+					 WIDTH, HEIGHT, STEP, false, duration.count(),
+					 buddhabrot::csvHeaderColumns(),
+					 buddhabrot::csvColumns(stats, importance),
+					 buddhabrot::describe(stats, importance));
+	return 0;
+}
+
+/**
+ * @brief Renders the image and supersamples `args.aa_samples` times
+ * the pixels along the boundary and the filaments. Writes the
+ * escape times of the base pass like a regular run and the mean
+ * escape times next to them.
+ */
+int renderAntialiased(const cmdParse::ParsedArgs &args,
+					  const string &fileName, int threads_used,
+					  int WIDTH, int HEIGHT, float STEP,
+					  float min_x, float min_y)
+{
+	const int iterations = args.iterations;
+	cout << "Calculating Mandelbrot set with " << threads_used
+		 << " threads with " << iterations << " iterations, "
+		 << args.aa_samples << " samples per refined pixel."
+		 << endl;
+	const size_t image_size = static_cast<size_t>(HEIGHT) * WIDTH;
+	vector<int> escape(image_size);
+	vector<float> image(image_size);
+	const auto start = std::chrono::steady_clock::now();
+	const supersample::Stats stats = supersample::render(
+		escape.data(), image.data(), iterations, WIDTH, HEIGHT,
+		STEP, min_x, min_y, args.aa_samples, args.seed,
+		SCHEDULING_TYPE);
+	const chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start;
+	cout << "Time elapsed: " << duration.count() << " seconds."
+		 << endl
+		 << "Anti-aliasing: " << 100.0 * stats.refinedFraction()
+		 << "% of the pixels refined, " << stats.sampleCost()
+		 << " of the samples and about " << stats.timeCost()
+		 << " of the time of a full supersample." << endl;
+
+	fs::path output_file_path(args.output_file);
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	const string new_name = to_string(threads_used) + "_threads_" +
+							to_string(iterations) + "_iterations_" +
+							to_string(args.resolution) +
+							"_resolution";
+	const string stem =
+		output_file_path.stem().string() + "_" + new_name;
+	const string extension = output_file_path.extension().string();
+	const fs::path base_path =
+		output_file_path.parent_path() / (stem + extension);
+	const fs::path aa_path =
+		output_file_path.parent_path() / (stem + "_aa" + extension);
+	cout << "Writing to files: " << base_path << " and " << aa_path
+		 << endl
+		 << endl;
+	ofstream base_out(base_path, ios::trunc);
+	ofstream aa_out(aa_path, ios::trunc);
+	if (!base_out.is_open() || !aa_out.is_open())
+	{
+		cout << "Unable to open file." << endl;
+		return -14;
+	}
+	for (int row = 0; row < HEIGHT; row++)
+	{
+		for (int col = 0; col < WIDTH; col++)
+		{
+			base_out << escape[row * WIDTH + col];
+			aa_out << image[row * WIDTH + col];
+			if (col < WIDTH - 1)
+			{
+				base_out << ',';
+				aa_out << ',';
+			}
+		}
+		if (row < HEIGHT - 1)
+		{
+			base_out << endl;
+			aa_out << endl;
+		}
+	}
+	base_out.close();
+	aa_out.close();
+
+	appendModeReport(args, fileName, "aa", threads_used, WIDTH,
+					 HEIGHT, STEP, true, duration.count(),
+					 supersample::csvHeaderColumns(),
+					 supersample::csvColumns(stats),
+					 supersample::describe(stats));
+	return 0;
+}
+
+/**
+ * @brief Renders the image coarse to fine, writing every level to a
+ * file of its own as soon as it is complete, and the final image
+ * like a regular run.
+ */
+int renderProgressive(const cmdParse::ParsedArgs &args,
+					  const string &fileName, int threads_used,
+					  int WIDTH, int HEIGHT, float STEP,
+					  float min_x, float min_y)
+{
+	const int iterations = args.iterations;
+	fs::path output_file_path(args.output_file);
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	const string new_name = to_string(threads_used) + "_threads_" +
+							to_string(iterations) + "_iterations_" +
+							to_string(args.resolution) +
+							"_resolution";
+	const string stem =
+		output_file_path.stem().string() + "_" + new_name;
+	const string extension = output_file_path.extension().string();
+	cout << "Calculating Mandelbrot set progressively with "
+		 << threads_used << " threads with " << iterations
+		 << " iterations"
+		 << (args.progressive_exact ? ", exact final pass." : ".")
+		 << endl;
+
+	const size_t image_size = static_cast<size_t>(HEIGHT) * WIDTH;
+	vector<int> image(image_size);
+	// The levels are copied and written while the next ones compute
+	animation::Writer writer(WIDTH, HEIGHT, 2);
+	const progressive::LevelCallback write_level =
+		[&](const int *level_image, const progressive::Level &level)
+	{
+		ostringstream level_name;
+		level_name << stem << "_level_";
+		if (level.exact)
+			level_name << "exact";
+		else
+			level_name << setw(2) << setfill('0') << level.spacing;
+		level_name << extension;
+		const fs::path level_path =
+			output_file_path.parent_path() / level_name.str();
+		if (level.exact)
+			cout << "Exact pass: " << level.computed
+				 << " recomputed, " << level.corrected
+				 << " corrected, ";
+		else
+			cout << "Level " << level.spacing << ": "
+				 << level.computed << " computed, " << level.guessed
+				 << " guessed, ";
+		cout << level.elapsed << " seconds elapsed, writing to "
+			 << level_path << endl;
+		writer.push(make_shared<const vector<int>>(
+						level_image, level_image + image_size),
+					level_path.string());
+	};
+	const auto start = std::chrono::steady_clock::now();
+	const progressive::Stats stats = progressive::render(
+		image.data(), iterations, WIDTH, HEIGHT, STEP, min_x, min_y,
+		args.progressive_exact, SCHEDULING_TYPE, write_level);
+	const chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start;
+	writer.finish();
+	if (writer.failed())
+	{
+		cout << "Unable to write every level." << endl;
+		return -14;
+	}
+	cout << "Time elapsed: " << duration.count()
+		 << " seconds, first level " << stats.firstLevelSeconds()
+		 << " seconds." << endl
+		 << "Solid guessing: " << stats.guessed() << " of "
+		 << stats.pixels << " pixels guessed";
+	if (args.progressive_exact)
+		cout << ", " << stats.corrected()
+			 << " corrected by the exact pass";
+	cout << "." << endl;
+
+	const fs::path final_path =
+		output_file_path.parent_path() / (stem + extension);
+	cout << "Writing to file: " << final_path << endl << endl;
+	if (!animation::writeFrame(final_path.string(), image.data(),
+							   WIDTH, HEIGHT))
+	{
+		cout << "Unable to open file." << endl;
+		return -14;
+	}
+
+	appendModeReport(args, fileName, "progressive", threads_used,
+					 WIDTH, HEIGHT, STEP, true, duration.count(),
+					 progressive::csvHeaderColumns(),
+					 progressive::csvColumns(stats),
+					 progressive::describe(stats));
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	// Parse command line arguments
+	cmdParse::ParsedArgs args =
+		cmdParse::parse_cmd_arguments(argc, argv);
+	const int iterations = args.iterations;
+	const int resolution_value = args.resolution;
+	fs::path output_file_path(args.output_file);
+	int threads_used = omp_get_max_threads();
+	if (args.threads_num > 0)
+	{
+		threads_used = args.threads_num;
+		omp_set_num_threads(threads_used);
+	}
+
+	// Image size
+	const int WIDTH =
+		static_cast<int>(MandelbrotSet::RATIO_X * resolution_value);
+	const int HEIGHT =
+		static_cast<int>(MandelbrotSet::RATIO_Y * resolution_value);
+
+	// Escape-time formula, the deep zoom and animation kernels only
+	// know the Mandelbrot set
+	const formula::Params formula_params = formula::makeParams(
+		args.formula, args.julia_re, args.julia_im, args.power);
+	const bool other_formula =
+		!formula::isMandelbrot(formula_params);
+	if (other_formula &&
+		(args.frames > 0 || args.buddhabrot_samples > 0 ||
+		 !args.deep_center_re.empty() || args.distance_estimate ||
+		 args.aa_samples > 0 || args.progressive))
+	{
+		cerr << "--formula " << args.formula
+			 << " is not available with --frames, --buddhabrot, "
+				"--deep-zoom, --distance-estimate, --aa or "
+				"--progressive."
+			 << endl;
+		return -1;
+	}
+
+	// Zoom animations write frames of their own
+	if (args.frames > 0)
+		return renderAnimation(args, fileName, threads_used, WIDTH,
+							   HEIGHT);
+
+	// The engines map pixels in float, the runtime viewport is
+	// refused once its spacing nears the float resolution of its
+	// coordinates
+	if (args.viewport && args.deep_center_re.empty())
+	{
+		const double spacing = RATIO_X / (args.zoom * WIDTH);
+		if (!resolvesViewport(args.center_x, args.center_y, spacing,
+							  WIDTH, HEIGHT,
+							  numeric_limits<float>::epsilon()))
+		{
+			cerr << "--zoom " << args.zoom << " around --center "
+				 << args.center_x << "," << args.center_y
+				 << " needs a pixel spacing of " << spacing
+				 << ", below the float resolution of the engines; "
+					"use "
+					"--deep-zoom <re>,<im>,<spacing> instead."
+				 << endl;
+			return -1;
+		}
+	}
+
+	// Runtime viewport, --zoom times narrower around --center;
+	// without them the fixed one, computed exactly as before
+	const float STEP =
+		args.viewport ? static_cast<float>(MandelbrotSet::RATIO_X /
+										   (args.zoom * WIDTH))
+					  : MandelbrotSet::RATIO_X / WIDTH;
+	const float min_x =
+		args.viewport
+			? static_cast<float>(args.center_x -
+								 RATIO_X / (2 * args.zoom))
+			: MIN_X;
+	const float min_y =
+		args.viewport
+			? static_cast<float>(args.center_y -
+								 RATIO_Y / (2 * args.zoom))
+			: MIN_Y;
+
+	// Orbit densities write an image of their own
+	if (args.buddhabrot_samples > 0)
+		return renderBuddhabrot(args, fileName, threads_used, WIDTH,
+								HEIGHT, STEP, min_x, min_y);
+	// Supersampled images write two images of their own
+	if (args.aa_samples > 0)
+		return renderAntialiased(args, fileName, threads_used,
+								 WIDTH, HEIGHT, STEP, min_x, min_y);
+	// Progressive renders write every level
+	if (args.progressive)
+		return renderProgressive(args, fileName, threads_used,
+								 WIDTH, HEIGHT, STEP, min_x, min_y);
+
+	// Deep zoom replaces the fixed viewport, centred on a high
+	// precision point
+	const bool deep_zoom = !args.deep_center_re.empty();
+	deepzoom::View deep_view;
+	deepzoom::Kernel deep_kernel = deepzoom::Kernel::PERTURBATION;
+	deepzoom::Result deep_result;
+	if (deep_zoom)
+	{
+		try
+		{
+			deep_view = deepzoom::makeView(args.deep_center_re,
+										   args.deep_center_im,
+										   args.deep_spacing);
+		}
+		catch (const exception &e)
+		{
+			cerr << "Invalid --deep-zoom centre: " << e.what()
+				 << endl;
+			return -1;
+		}
+		// "auto" is the one value that is not a kernel name
+		if (!deepzoom::parseKernel(args.deep_kernel, deep_kernel))
+			deep_kernel = deepzoom::selectKernel(deep_view);
+		if (args.viewport)
+			cerr << "--center and --zoom are ignored with "
+					"--deep-zoom."
+				 << endl;
+	}
+	const bool viewport = args.viewport && !deep_zoom;
+	// Distance estimates refine the boundary of the fixed or
+	// runtime viewport
+	if (deep_zoom && args.distance_estimate)
+		cerr << "--distance-estimate is ignored with --deep-zoom."
+			 << endl;
+	const bool distance_mode = args.distance_estimate && !deep_zoom;
+	distance::Stats distance_stats;
+
+	// End-to-end breakdown, the CSV columns follow this order
+	logutils::PhaseRegistry run_phases({"Alloc", "Compute", "Stats",
+										"Mkdir", "Write",
+										"CSV probe"});
+	logutils::ScopedTimer alloc_timer(run_phases, "Alloc");
+	int *const image = new int[HEIGHT * WIDTH];
+	const size_t image_size = HEIGHT * WIDTH;
+	fill_n(image, image_size, -1);
+	alloc_timer.stop();
+	cout << "Calculating Mandelbrot set with " << threads_used
+		 << " threads with " << iterations << " iterations."
+		 << endl;
+
+	// Hardware counters, one group per thread of the compute team
+	unique_ptr<perfcounters::ThreadGroups> counters;
+	perfcounters::Sample compute_counters, write_counters;
+	vector<perfcounters::Sample> compute_thread_counters;
+	if (args.perf_counters)
+	{
+		counters.reset(
+			new perfcounters::ThreadGroups(threads_used));
+		if (!counters->available())
+			cerr << "Hardware counters unavailable ("
+				 << counters->status()
+				 << "), continuing without them." << endl;
+		else if (!counters->status().empty())
+			cerr << "Some hardware counters unavailable: "
+				 << counters->status() << endl;
+	}
+
+	// Per-thread chunk accounting, off unless requested
+	if ((deep_zoom || distance_mode) && args.thread_stats)
+		cerr << "Thread accounting is not available with "
+				"--deep-zoom "
+				"or --distance-estimate, continuing without it."
+			 << endl;
+	threadtrace::Recorder trace(threads_used, args.thread_stats &&
+												  !deep_zoom &&
+												  !distance_mode);
+	// Float tiles only when asked for, they are not bit-identical
+	// to the double kernel; the thread accounting records the pixel
+	// loop of the double kernel
+	precision::Mode precision_mode = precision::Mode::DOUBLE;
+	precision::parseMode(args.precision, precision_mode);
+	if (precision_mode == precision::Mode::AUTO && trace.enabled())
+	{
+		cerr << "Thread accounting runs the double kernel." << endl;
+		precision_mode = precision::Mode::DOUBLE;
+	}
+	// The float tiles only iterate the Mandelbrot set
+	if (other_formula)
+		precision_mode = precision::Mode::DOUBLE;
+	const bool float_tiles =
+		!deep_zoom && !distance_mode &&
+		precision_mode == precision::Mode::AUTO;
+	precision::Stats precision_stats;
+	// Live progress on stderr, off unless requested
+	unique_ptr<progress::Reporter> reporter;
+	if (args.progress_interval > 0.0)
+		reporter.reset(new progress::Reporter(
+			image_size, args.progress_interval));
+
+	// RAPL energy of the whole machine, skipped when not readable
+	unique_ptr<energy::Probe> energy_probe;
+	energy::Reading energy_before;
+	energy::Sample compute_energy, write_energy;
+	if (args.energy)
+	{
+		energy_probe.reset(new energy::Probe());
+		if (!energy_probe->available())
+		{
+			cerr << "Energy counters unavailable ("
+				 << energy_probe->status()
+				 << "), continuing without them." << endl;
+			energy_probe.reset();
+		}
+	}
+
+	if (energy_probe)
+		energy_before = energy_probe->read();
+	if (counters)
+		counters->start();
+	if (reporter)
+		reporter->start();
+	const auto start = std::chrono::steady_clock::now();
+	if (deep_zoom)
+		deep_result = deepzoom::render(
+			image, iterations, WIDTH, HEIGHT, deep_view,
+			deep_kernel, SCHEDULING_TYPE, reporter.get());
+	else if (distance_mode)
+		distance_stats = distance::computeOpenMP(
+			image, iterations, WIDTH, HEIGHT, STEP, min_x, min_y,
+			args.distance_margin, SCHEDULING_TYPE, reporter.get());
+	else if (float_tiles)
+		precision_stats = precision::computeOpenMP(
+			image, iterations, WIDTH, HEIGHT, STEP, min_x, min_y,
+			SCHEDULING_TYPE, reporter.get());
+	else
+		computeMandelbrot(image, iterations, WIDTH, HEIGHT, STEP,
+						  min_x, min_y, &trace, reporter.get(),
+						  formula_params);
+	const auto end = std::chrono::steady_clock::now();
+	if (reporter)
+		reporter->stop();
+	if (energy_probe)
+		compute_energy = energy_probe->delta(energy_before,
+											 energy_probe->read());
+	if (counters)
+	{
+		compute_counters = counters->stop();
+		compute_thread_counters = counters->threadSamples();
+	}
+
+	chrono::duration<double> duration = end - start;
+	run_phases.add("Compute", duration.count());
+	cout << "Time elapsed: " << duration.count() << " seconds."
+		 << endl;
+	if (deep_zoom)
+		cout << "Deep zoom: "
+			 << deepzoom::kernelName(deep_result.kernel)
+			 << " kernel, " << deep_result.references
+			 << " reference orbits, " << deep_result.glitched
+			 << " glitched and " << deep_result.unresolved
+			 << " unresolved pixels." << endl;
+	if (float_tiles)
+		cout << "Precision: "
+			 << 100.0 * precision_stats.promotedFraction()
+			 << "% of " << precision_stats.tiles
+			 << " tiles promoted to double." << endl;
+	// Against a double render outside of the timed phases; distance
+	// estimates are always benchmarked against it
+	unique_ptr<precision::Verification> verification;
+	double reference_seconds = 0.0;
+	if ((args.verify_precision || distance_mode) && !deep_zoom)
+	{
+		vector<int> reference(image_size);
+		const auto reference_start =
+			std::chrono::steady_clock::now();
+		computeMandelbrot(reference.data(), iterations, WIDTH,
+						  HEIGHT, STEP, min_x, min_y, nullptr,
+						  nullptr, formula_params);
+		reference_seconds =
+			chrono::duration<double>(
+				std::chrono::steady_clock::now() - reference_start)
+				.count();
+		verification.reset(
+			new precision::Verification(precision::verify(
+				image, reference.data(), image_size)));
+		cout << "Verification: " << verification->mismatches
+			 << " pixels differ from the double render, by at most "
+			 << verification->max_difference << " iterations."
+			 << endl;
+	}
+	if (distance_mode)
+		cout << "Distance estimate: " << distance_stats.filled
+			 << " of " << distance_stats.blocks
+			 << " blocks filled, " << distance_stats.enclosed
+			 << " enclosed, "
+			 << 100.0 * distance_stats.computedFraction()
+			 << "% of the pixels iterated; brute force took "
+			 << reference_seconds << " seconds." << endl;
+	// Executed work, derived from the escape times after the
+	// timing. Distance estimates fill pixels without iterating them
+	// and float tiles iterate promoted pixels twice, the escape
+	// times do not tell their work
+	logutils::ScopedTimer stats_timer(run_phases, "Stats");
+	iterstats::Stats iter_stats =
+		iterstats::count(image, image_size, iterations);
+	iter_stats.executed_known = !distance_mode && !float_tiles;
+	stats_timer.stop();
+	if (iter_stats.executed_known)
+		cout << "Throughput: "
+			 << iter_stats.gigaIterationsPerSecond(duration.count())
+			 << " GIterations/s, "
+			 << iter_stats.gigaFlopsPerSecond(duration.count())
+			 << " GFLOP/s." << endl;
+
+	logutils::ScopedTimer mkdir_timer(run_phases, "Mkdir");
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	mkdir_timer.stop();
+	// Write the result to a file
+	string new_name = to_string(threads_used) + "_threads_" +
+					  to_string(iterations) + "_iterations_" +
+					  to_string(resolution_value) + "_resolution";
+	// Get the original filename stem and extension
+	string filename_stem = output_file_path.stem().string();
+	string extension = output_file_path.extension().string();
+	string new_filename =
+		filename_stem + "_" + new_name + extension;
+	// Update the output_file_path with the new filename
+	output_file_path =
+		output_file_path.parent_path() / new_filename;
+	logutils::ScopedTimer write_timer(run_phases, "Write");
+	ofstream matrix_out(output_file_path, ios::trunc);
+	cout << "Writing to file: " << output_file_path << endl << endl;
+	if (!matrix_out.is_open())
+	{
+		cout << "Unable to open file." << endl;
+		return -14;
+	}
+
+	if (energy_probe)
+		energy_before = energy_probe->read();
+	if (counters)
+		counters->start();
+	for (int row = 0; row < HEIGHT; row++)
+	{
+		for (int col = 0; col < WIDTH; col++)
+		{
+			matrix_out << image[row * WIDTH + col];
+
+			if (col < WIDTH - 1)
+				matrix_out << ',';
+		}
+		if (row < HEIGHT - 1)
+			matrix_out << endl;
+	}
+	matrix_out.close();
+	if (counters)
+		write_counters = counters->stop();
+	if (energy_probe)
+		write_energy = energy_probe->delta(energy_before,
+										   energy_probe->read());
+	write_timer.stop();
+
+	//? CSV
+	const string scheduling_type = SCHEDULING_STRING;
+	// Deep zooms, other formulas, runtime viewports and distance
+	// estimates get a CSV of their own, their rows do not compare
+	// with the fixed viewport
+	const string additinonalName =
+		deep_zoom		? "_openmp_deep_"
+		: distance_mode ? "_openmp_distance_"
+		: other_formula ? "_openmp_formula_"
+		: viewport		? "_openmp_view_"
+						: "_openmp_";
+
+	const string header =
+		"DateTime,Program,Iterations,Resolution,Width,Height,Step,"
+		"Scheduling,Threads,Time (seconds)" +
+		iterstats::csvHeaderColumns() +
+		run_phases.csvHeaderColumns();
+	const string viewport_columns = ",Center X,Center Y,Zoom";
+	const string main_header =
+		deep_zoom		? header + deepzoom::csvHeaderColumns()
+		: other_formula ? header + formula::csvHeaderColumns() +
+							  viewport_columns
+		: viewport ? header + viewport_columns
+				   : header;
+	// A distance estimate's row goes to the distance CSV below,
+	// with the statistics of its blocks
+	if (!distance_mode)
+	{
+		logutils::ScopedTimer probe_timer(run_phases, "CSV probe");
+		const string csvFile =
+			logutils::createCsvFilename(argv[1], additinonalName);
+		bool has_header =
+			logutils::csvFileHasHeader(csvFile, main_header);
+		ofstream csv(csvFile, ios::app);
+		probe_timer.stop();
+		if (csv.is_open())
+		{
+			if (!has_header)
+			{
+				cout << "Adding header to csv file." << endl;
+				csv << main_header << endl;
+			}
+			csv << logutils::getCurrentTimestamp() << ","
+				<< fileName << "," << iterations << ","
+				<< resolution_value << "," << WIDTH << "," << HEIGHT
+				<< "," << STEP << "," << SCHEDULING_STRING << ","
+				<< threads_used << "," << duration.count()
+				<< iterstats::csvColumns(iter_stats,
+										 duration.count())
+				<< run_phases.csvColumns();
+			if (deep_zoom)
+				csv << deepzoom::csvColumns(deep_view, deep_result);
+			if (other_formula)
+				csv << formula::csvColumns(formula_params);
+			if (viewport || other_formula)
+				csv << "," << args.center_x << "," << args.center_y
+					<< "," << args.zoom;
+			csv << endl;
+			csv.close();
+			cout << "CSV entry added successfully." << endl;
+		}
+		else
+		{
+			cerr << "Unable to open CSV file." << endl;
+		}
+	}
+	//? log
+	const string log_file =
+		logutils::create_log_file_name(argv[1], additinonalName);
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+	{
+		log << "Date:\t" << __DATE__ << " " << __TIME__
+			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
+			<< iterations << "\tResolution:\t" << resolution_value
+			<< "\tWidth:\t" << WIDTH << "\tHeight:\t" << HEIGHT
+			<< "\tStep:\t" << STEP << "\tScheduling:\t"
+			<< SCHEDULING_STRING << "\tThreads:\t" << threads_used
+			<< "\tTime:\t" << duration.count() << "\tseconds"
+			<< endl
+			<< iterstats::describe(iter_stats, duration.count())
+			<< endl
+			<< run_phases.describe();
+		if (deep_zoom)
+			log << deepzoom::describe(deep_view, deep_result)
+				<< endl;
+		if (other_formula)
+			log << formula::describe(formula_params) << endl;
+		if (viewport)
+			log << "\tCenter:\t" << args.center_x << ","
+				<< args.center_y << "\tZoom:\t" << args.zoom
+				<< endl;
+		log.close();
+		cout << "Log entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open log file." << endl;
+	}
+	//? Escape-time histogram, one row per bucket
+	const string histCsvFile =
+		logutils::createCsvFilename(argv[1], "_openmp_hist_");
+	if (!iterstats::appendHistogramCsv(
+			histCsvFile, logutils::getCurrentTimestamp(), fileName,
+			resolution_value, iter_stats))
+		cerr << "Unable to open histogram CSV file." << endl;
+	//? Thread accounting, summary in the log and optional timeline
+	if (trace.enabled())
+	{
+		const vector<threadtrace::ThreadSummary> thread_summaries =
+			trace.threadSummaries();
+		const threadtrace::Summary trace_summary =
+			threadtrace::summarize(thread_summaries);
+		const string trace_text =
+			threadtrace::describe(trace_summary, thread_summaries);
+		cout << "Thread accounting:" << endl << trace_text;
+		ofstream trace_log(log_file, ios::app);
+		if (trace_log.is_open())
+			trace_log << "\tThread accounting:" << trace_text;
+		if (!args.trace_file.empty())
+		{
+			if (threadtrace::writeChromeTrace(
+					args.trace_file, {trace.traceEvents(0)}))
+				cout << "Trace written to " << args.trace_file
+					 << endl;
+			else
+				cerr << "Unable to write trace file." << endl;
+		}
+	}
+
+	//? Hardware counters, a CSV of their own so that the regular
+	//? OpenMP CSV keeps its schema
+	if (counters)
+	{
+		const string perfCsvFile =
+			logutils::createCsvFilename(argv[1], "_openmp_perf_");
+		const string perf_header =
+			header + perfcounters::csvHeaderColumns("Compute") +
+			perfcounters::csvHeaderColumns("Write");
+		bool has_perf_header =
+			logutils::csvFileHasHeader(perfCsvFile, perf_header);
+		ofstream perf_csv(perfCsvFile, ios::app);
+		if (perf_csv.is_open())
+		{
+			if (!has_perf_header)
+				perf_csv << perf_header << endl;
+			perf_csv << logutils::getCurrentTimestamp() << ","
+					 << fileName << "," << iterations << ","
+					 << resolution_value << "," << WIDTH << ","
+					 << HEIGHT << "," << STEP << ","
+					 << SCHEDULING_STRING << "," << threads_used
+					 << "," << duration.count()
+					 << iterstats::csvColumns(iter_stats,
+											  duration.count())
+					 << run_phases.csvColumns()
+					 << perfcounters::csvColumns(compute_counters)
+					 << perfcounters::csvColumns(write_counters)
+					 << endl;
+		}
+		else
+		{
+			cerr << "Unable to open hardware counter CSV file."
+				 << endl;
+		}
+		ofstream perf_log(log_file, ios::app);
+		if (perf_log.is_open())
+		{
+			perf_log << "\tCompute counters:\t"
+					 << perfcounters::describe(compute_counters)
+					 << endl;
+			for (size_t t = 0; t < compute_thread_counters.size();
+				 t++)
+				perf_log << "\t\tThread " << t << ":\t"
+						 << perfcounters::describe(
+								compute_thread_counters[t])
+						 << endl;
+			perf_log << "\tWrite counters:\t"
+					 << perfcounters::describe(write_counters)
+					 << endl;
+		}
+	}
+
+	//? Distance estimates, the main row with the statistics of the
+	//? blocks
+	if (distance_mode)
+	{
+		const string distanceCsvFile = logutils::createCsvFilename(
+			argv[1], "_openmp_distance_");
+		const string distance_header =
+			header + distance::csvHeaderColumns();
+		logutils::ScopedTimer probe_timer(run_phases, "CSV probe");
+		bool has_distance_header = logutils::csvFileHasHeader(
+			distanceCsvFile, distance_header);
+		ofstream distance_csv(distanceCsvFile, ios::app);
+		probe_timer.stop();
+		if (distance_csv.is_open())
+		{
+			if (!has_distance_header)
+				distance_csv << distance_header << endl;
+			distance_csv
+				<< logutils::getCurrentTimestamp() << ","
+				<< fileName << "," << iterations << ","
+				<< resolution_value << "," << WIDTH << "," << HEIGHT
+				<< "," << STEP << "," << SCHEDULING_STRING << ","
+				<< threads_used << "," << duration.count()
+				<< iterstats::csvColumns(iter_stats,
+										 duration.count())
+				<< run_phases.csvColumns()
+				<< distance::csvColumns(
+					   args.distance_margin, distance_stats,
+					   *verification, duration.count(),
+					   reference_seconds)
+				<< endl;
+		}
+		else
+		{
+			cerr << "Unable to open distance CSV file." << endl;
+		}
+		ofstream distance_log(log_file, ios::app);
+		if (distance_log.is_open())
+			distance_log
+				<< distance::describe(args.distance_margin,
+									  distance_stats, *verification,
+									  duration.count(),
+									  reference_seconds)
+				<< endl;
+	}
+
+	//? Precision, a CSV of its own like the hardware counters
+	if (float_tiles || (verification && !distance_mode))
+	{
+		const string precisionCsvFile = logutils::createCsvFilename(
+			argv[1], "_openmp_precision_");
+		const string precision_header =
+			header + precision::csvHeaderColumns();
+		bool has_precision_header = logutils::csvFileHasHeader(
+			precisionCsvFile, precision_header);
+		ofstream precision_csv(precisionCsvFile, ios::app);
+		if (precision_csv.is_open())
+		{
+			if (!has_precision_header)
+				precision_csv << precision_header << endl;
+			precision_csv
+				<< logutils::getCurrentTimestamp() << ","
+				<< fileName << "," << iterations << ","
+				<< resolution_value << "," << WIDTH << "," << HEIGHT
+				<< "," << STEP << "," << SCHEDULING_STRING << ","
+				<< threads_used << "," << duration.count()
+				<< iterstats::csvColumns(iter_stats,
+										 duration.count())
+				<< run_phases.csvColumns()
+				<< precision::csvColumns(precision_mode,
+										 precision_stats,
+										 verification.get())
+				<< endl;
+		}
+		else
+		{
+			cerr << "Unable to open precision CSV file." << endl;
+		}
+		ofstream precision_log(log_file, ios::app);
+		if (precision_log.is_open())
+			precision_log << precision::describe(precision_mode,
+												 precision_stats,
+												 verification.get())
+						  << endl;
+	}
+
+	//? Energy, a CSV of its own like the hardware counters
+	if (energy_probe)
+	{
+		cout << "Compute energy: "
+			 << energy::describe(compute_energy) << endl;
+		const string energyCsvFile =
+			logutils::createCsvFilename(argv[1], "_openmp_energy_");
+		const string energy_header =
+			header + energy::csvHeaderColumns("Compute") +
+			energy::csvHeaderColumns("Write");
+		bool has_energy_header = logutils::csvFileHasHeader(
+			energyCsvFile, energy_header);
+		ofstream energy_csv(energyCsvFile, ios::app);
+		if (energy_csv.is_open())
+		{
+			if (!has_energy_header)
+				energy_csv << energy_header << endl;
+			energy_csv << logutils::getCurrentTimestamp() << ","
+					   << fileName << "," << iterations << ","
+					   << resolution_value << "," << WIDTH << ","
+					   << HEIGHT << "," << STEP << ","
+					   << SCHEDULING_STRING << "," << threads_used
+					   << "," << duration.count()
+					   << iterstats::csvColumns(iter_stats,
+												duration.count())
+					   << run_phases.csvColumns()
+					   << energy::csvColumns(compute_energy)
+					   << energy::csvColumns(write_energy) << endl;
+		}
+		else
+		{
+			cerr << "Unable to open energy CSV file." << endl;
+		}
+		ofstream energy_log(log_file, ios::app);
+		if (energy_log.is_open())
+			energy_log << "\tCompute energy:\t"
+					   << energy::describe(compute_energy) << endl
+					   << "\tWrite energy:\t"
+					   << energy::describe(write_energy) << endl;
+	}
+
+	delete[] image; // It's here for coding style, but useless
+	return 0;
 }
\ No newline at end of file
@@ -1,178 +1,409 @@
-#include <LogUtils.h>
-#include <chrono>
-#include <complex>
-#include <filesystem>
-#include <fstream>
-#include <iostream>
-
-namespace MandelbrotSet
-{
-// Ranges of the set
-constexpr float MIN_X = -2.0;
-constexpr float MAX_X = 1.0;
-constexpr float MIN_Y = -1.0;
-constexpr float MAX_Y = 1.0;
-
-// Image ratio
-constexpr float RATIO_X = (MAX_X - MIN_X);
-constexpr float RATIO_Y = (MAX_Y - MIN_Y);
-
-} // namespace MandelbrotSet
-namespace fs = std::filesystem;
-
-using namespace std;
-
-int main(int argc, char **argv)
-{
-	cout.sync_with_stdio(false);
-	fs::path filePath = argv[0];
-	string fileName = filePath.filename().string();
-	if (argc < 3)
-	{
-		cout << "Usage: " << fileName
-			 << " <output_file> <iterations>" << endl;
-		return -1;
-	}
-	if (argc < 2)
-	{
-		cout << "Please specify the output file as a parameter."
-			 << endl;
-		return -1;
-	}
-	// Parse command line arguments
-	cmdParse::ParsedArgs args =
-		cmdParse::parse_cmd_arguments(argc, argv);
-	const int iterations = args.iterations;
-	const int resolution_value = args.resolution;
-	const fs::path output_file_path(args.output_file);
-
-	// Image size
-	const int WIDTH =
-		static_cast<int>(MandelbrotSet::RATIO_X * resolution_value);
-	const int HEIGHT =
-		static_cast<int>(MandelbrotSet::RATIO_Y * resolution_value);
-
-	const float STEP = MandelbrotSet::RATIO_X / WIDTH;
-
-	if (iterations <= 0)
-	{
-		cout << "Please specify a positive number of iterations."
-			 << endl;
-		return -2;
-	}
-
-	int *const image = new int[HEIGHT * WIDTH];
-	cout << "Calculating Mandelbrot set with " << iterations
-		 << " iterations." << endl;
-	const auto start = chrono::steady_clock::now();
-
-	//! Calculate the Mandelbrot set
-	int row = 0, col = 0;
-	for (int pos = 0; pos < HEIGHT * WIDTH; pos++)
-	{
-		image[pos] = 0;
-		row = pos / WIDTH;
-		col = pos % WIDTH;
-		const complex<double> c(col * STEP + MandelbrotSet::MIN_X,
-								row * STEP + MandelbrotSet::MIN_Y);
-
-		// z = z^2 + c
-		complex<double> z(0, 0);
-		for (int i = 1; i <= iterations; i++)
-		{
-			z = z * z + c;
-			// If it is convergent
-			if (abs(z) >= 2)
-			{
-				image[pos] = i;
-				break;
-			}
-		}
-	}
-	const auto end = chrono::steady_clock::now();
-	const string csvFile =
-		logutils::createCsvFilename(argv[1], "_seq_");
-	const string header = "DateTime,Program,Iterations,"
-						  "Resolution,Width,Height,Step,"
-						  "Scheduling,Time (seconds)";
-	bool has_header = logutils::csvFileHasHeader(csvFile, header);
-
-	chrono::duration<double> duration = end - start;
-	cout << endl
-		 << "Time elapsed: " << duration.count() << " seconds."
-		 << endl;
-
-	const string log_file =
-		logutils::create_log_file_name(argv[1], "_seq_");
-	ofstream csv(csvFile, ios::app);
-	if (csv.is_open())
-	{
-		if (!has_header)
-		{
-			cout << "Adding header to csv file." << endl;
-			csv << header << endl;
-		}
-		csv << logutils::getCurrentTimestamp() << "," << fileName
-			<< "," << iterations << "," << resolution_value << ","
-			<< WIDTH << "," << HEIGHT << "," << STEP << "," << ""
-			<< "," << duration.count() << endl;
-		csv.close();
-		cout << "CSV entry added successfully." << endl;
-	}
-	else
-	{
-		cerr << "Unable to open CSV file." << endl;
-	}
-	ofstream log(log_file, ios::app);
-	if (log.is_open())
-	{
-		log << "Date:\t" << __DATE__ << " " << __TIME__
-			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
-			<< iterations << "\tResolution:\t" << resolution_value
-			<< "\tWidth:\t" << WIDTH << "\tHeight:\t" << HEIGHT
-			<< "\tStep:\t" << STEP << "\tScheduling:\t"
-			<< "\tTime:\t" << duration.count() << "\tseconds"
-			<< endl;
-		log.close();
-		cout << "Log entry added successfully." << endl;
-	}
-	else
-	{
-		cerr << "Unable to open log file." << endl;
-	}
-
-	try
-	{
-		fs::create_directories(output_file_path.parent_path());
-	}
-	catch (const fs::filesystem_error &e)
-	{
-		cout << "Error creating directories: " << e.what() << endl;
-		return -13;
-	}
-	// Write the result to a file
-	ofstream matrix_out(output_file_path, ios::trunc);
-	cout << "Writing to file: " << argv[1] << endl;
-	if (!matrix_out.is_open())
-	{
-		cout << "Unable to open file." << endl;
-		return -14;
-	}
-
-	for (int row = 0; row < HEIGHT; row++)
-	{
-		for (int col = 0; col < WIDTH; col++)
-		{
-			matrix_out << image[row * WIDTH + col];
-
-			if (col < WIDTH - 1)
-				matrix_out << ',';
-		}
-		if (row < HEIGHT - 1)
-			matrix_out << endl;
-	}
-	matrix_out.close();
-
-	delete[] image; // It's here for coding style, but useless
-	return 0;
+#include <EnergyProbe.h>
+#include <IterationStats.h>
+#include <LogUtils.h>
+#include <MandelbrotKernels.h>
+#include <PerfCounters.h>
+#include <ThreadTrace.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace MandelbrotSet
+{
+// Ranges of the set
+constexpr float MIN_X = -2.0;
+constexpr float MAX_X = 1.0;
+constexpr float MIN_Y = -1.0;
+constexpr float MAX_Y = 1.0;
+
+// Image ratio
+constexpr float RATIO_X = (MAX_X - MIN_X);
+constexpr float RATIO_Y = (MAX_Y - MIN_Y);
+
+} // namespace MandelbrotSet
+namespace fs = std::filesystem;
+
+using namespace std;
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	if (argc < 3)
+	{
+		cout << "Usage: " << fileName
+			 << " <output_file> <iterations>" << endl;
+		return -1;
+	}
+	if (argc < 2)
+	{
+		cout << "Please specify the output file as a parameter."
+			 << endl;
+		return -1;
+	}
+	// Parse command line arguments
+	cmdParse::ParsedArgs args =
+		cmdParse::parse_cmd_arguments(argc, argv);
+	const int iterations = args.iterations;
+	const int resolution_value = args.resolution;
+	const fs::path output_file_path(args.output_file);
+	const formula::Params formula_params = formula::makeParams(
+		args.formula, args.julia_re, args.julia_im, args.power);
+	const bool other_formula =
+		!formula::isMandelbrot(formula_params);
+	const string openmp_only = cmdParse::openmpOnlyOption(args);
+	if (!openmp_only.empty())
+	{
+		cout << openmp_only
+			 << " is only available in the OpenMP engine." << endl;
+		return -1;
+	}
+	if (args.buddhabrot_samples > 0)
+	{
+		cout << "--buddhabrot is only available in the OpenMP and "
+				"MPI "
+				"engines."
+			 << endl;
+		return -1;
+	}
+
+	// Image size
+	const int WIDTH =
+		static_cast<int>(MandelbrotSet::RATIO_X * resolution_value);
+	const int HEIGHT =
+		static_cast<int>(MandelbrotSet::RATIO_Y * resolution_value);
+
+	const float STEP = MandelbrotSet::RATIO_X / WIDTH;
+
+	if (iterations <= 0)
+	{
+		cout << "Please specify a positive number of iterations."
+			 << endl;
+		return -2;
+	}
+
+	// End-to-end breakdown, the CSV columns follow this order
+	logutils::PhaseRegistry run_phases({"Alloc", "Compute", "Stats",
+										"Mkdir", "Write",
+										"CSV probe"});
+	logutils::ScopedTimer alloc_timer(run_phases, "Alloc");
+	int *const image = new int[HEIGHT * WIDTH];
+	alloc_timer.stop();
+	cout << "Calculating Mandelbrot set with " << iterations
+		 << " iterations." << endl;
+
+	// Hardware counters of the calling thread
+	unique_ptr<perfcounters::ThreadGroups> counters;
+	perfcounters::Sample compute_counters, write_counters;
+	if (args.perf_counters)
+	{
+		counters.reset(new perfcounters::ThreadGroups(1));
+		if (!counters->available())
+			cerr << "Hardware counters unavailable ("
+				 << counters->status()
+				 << "), continuing without them." << endl;
+		else if (!counters->status().empty())
+			cerr << "Some hardware counters unavailable: "
+				 << counters->status() << endl;
+	}
+
+	// Row accounting of the single thread, off unless requested
+	threadtrace::Recorder trace(1, args.thread_stats);
+	// Live progress on stderr, off unless requested
+	unique_ptr<progress::Reporter> reporter;
+	if (args.progress_interval > 0.0)
+		reporter.reset(new progress::Reporter(
+			static_cast<int64_t>(HEIGHT) * WIDTH,
+			args.progress_interval));
+
+	// RAPL energy of the whole machine, skipped when not readable
+	unique_ptr<energy::Probe> energy_probe;
+	energy::Reading energy_before;
+	energy::Sample compute_energy, write_energy;
+	if (args.energy)
+	{
+		energy_probe.reset(new energy::Probe());
+		if (!energy_probe->available())
+		{
+			cerr << "Energy counters unavailable ("
+				 << energy_probe->status()
+				 << "), continuing without them." << endl;
+			energy_probe.reset();
+		}
+	}
+
+	if (energy_probe)
+		energy_before = energy_probe->read();
+	if (counters)
+		counters->start();
+	if (reporter)
+		reporter->start();
+	const auto start = chrono::steady_clock::now();
+
+	//! Calculate the Mandelbrot set
+	kernels::computeSequential(image, iterations, WIDTH, HEIGHT,
+							   STEP, MandelbrotSet::MIN_X,
+							   MandelbrotSet::MIN_Y, &trace,
+							   reporter.get(), formula_params);
+	const auto end = chrono::steady_clock::now();
+	if (reporter)
+		reporter->stop();
+	if (energy_probe)
+		compute_energy = energy_probe->delta(energy_before,
+											 energy_probe->read());
+	if (counters)
+		compute_counters = counters->stop();
+
+	chrono::duration<double> duration = end - start;
+	run_phases.add("Compute", duration.count());
+	cout << endl
+		 << "Time elapsed: " << duration.count() << " seconds."
+		 << endl;
+	// Executed work, derived from the escape times after the timing
+	logutils::ScopedTimer stats_timer(run_phases, "Stats");
+	const iterstats::Stats iter_stats =
+		iterstats::count(image, HEIGHT * WIDTH, iterations);
+	stats_timer.stop();
+	cout << "Throughput: "
+		 << iter_stats.gigaIterationsPerSecond(duration.count())
+		 << " GIterations/s, "
+		 << iter_stats.gigaFlopsPerSecond(duration.count())
+		 << " GFLOP/s." << endl;
+
+	logutils::ScopedTimer mkdir_timer(run_phases, "Mkdir");
+	try
+	{
+		fs::create_directories(output_file_path.parent_path());
+	}
+	catch (const fs::filesystem_error &e)
+	{
+		cout << "Error creating directories: " << e.what() << endl;
+		return -13;
+	}
+	mkdir_timer.stop();
+	// Write the result to a file
+	logutils::ScopedTimer write_timer(run_phases, "Write");
+	ofstream matrix_out(output_file_path, ios::trunc);
+	cout << "Writing to file: " << argv[1] << endl;
+	if (!matrix_out.is_open())
+	{
+		cout << "Unable to open file." << endl;
+		return -14;
+	}
+
+	if (energy_probe)
+		energy_before = energy_probe->read();
+	if (counters)
+		counters->start();
+	for (int row = 0; row < HEIGHT; row++)
+	{
+		for (int col = 0; col < WIDTH; col++)
+		{
+			matrix_out << image[row * WIDTH + col];
+
+			if (col < WIDTH - 1)
+				matrix_out << ',';
+		}
+		if (row < HEIGHT - 1)
+			matrix_out << endl;
+	}
+	matrix_out.close();
+	if (counters)
+		write_counters = counters->stop();
+	if (energy_probe)
+		write_energy = energy_probe->delta(energy_before,
+										   energy_probe->read());
+	write_timer.stop();
+
+	logutils::ScopedTimer probe_timer(run_phases, "CSV probe");
+	// Other formulas get a CSV of their own, their rows do not
+	// compare with the Mandelbrot set
+	const string additinonalName =
+		other_formula ? "_seq_formula_" : "_seq_";
+	const string csvFile =
+		logutils::createCsvFilename(argv[1], additinonalName);
+	const string header = "DateTime,Program,Iterations,"
+						  "Resolution,Width,Height,Step,"
+						  "Scheduling,Time (seconds)" +
+						  iterstats::csvHeaderColumns() +
+						  run_phases.csvHeaderColumns();
+	const string main_header =
+		other_formula ? header + formula::csvHeaderColumns()
+					  : header;
+	bool has_header =
+		logutils::csvFileHasHeader(csvFile, main_header);
+	ofstream csv(csvFile, ios::app);
+	probe_timer.stop();
+
+	const string log_file =
+		logutils::create_log_file_name(argv[1], additinonalName);
+	if (csv.is_open())
+	{
+		if (!has_header)
+		{
+			cout << "Adding header to csv file." << endl;
+			csv << main_header << endl;
+		}
+		csv << logutils::getCurrentTimestamp() << "," << fileName
+			<< "," << iterations << "," << resolution_value << ","
+			<< WIDTH << "," << HEIGHT << "," << STEP << ","
+			<< ""
+			<< "," << duration.count()
+			<< iterstats::csvColumns(iter_stats, duration.count())
+			<< run_phases.csvColumns();
+		if (other_formula)
+			csv << formula::csvColumns(formula_params);
+		csv << endl;
+		csv.close();
+		cout << "CSV entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open CSV file." << endl;
+	}
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+	{
+		log << "Date:\t" << __DATE__ << " " << __TIME__
+			<< "\tProgram:\t" << fileName << "\t\tIterations:\t"
+			<< iterations << "\tResolution:\t" << resolution_value
+			<< "\tWidth:\t" << WIDTH << "\tHeight:\t" << HEIGHT
+			<< "\tStep:\t" << STEP << "\tScheduling:\t"
+			<< "\tTime:\t" << duration.count() << "\tseconds"
+			<< endl
+			<< iterstats::describe(iter_stats, duration.count())
+			<< endl
+			<< run_phases.describe();
+		if (other_formula)
+			log << formula::describe(formula_params) << endl;
+		log.close();
+		cout << "Log entry added successfully." << endl;
+	}
+	else
+	{
+		cerr << "Unable to open log file." << endl;
+	}
+	//? Escape-time histogram, one row per bucket
+	const string histCsvFile =
+		logutils::createCsvFilename(argv[1], "_seq_hist_");
+	if (!iterstats::appendHistogramCsv(
+			histCsvFile, logutils::getCurrentTimestamp(), fileName,
+			resolution_value, iter_stats))
+		cerr << "Unable to open histogram CSV file." << endl;
+	//? Row accounting, summary in the log and optional timeline
+	if (trace.enabled())
+	{
+		const vector<threadtrace::ThreadSummary> thread_summaries =
+			trace.threadSummaries();
+		const string trace_text = threadtrace::describe(
+			threadtrace::summarize(thread_summaries),
+			thread_summaries);
+		cout << "Thread accounting:" << endl << trace_text;
+		ofstream trace_log(log_file, ios::app);
+		if (trace_log.is_open())
+			trace_log << "\tThread accounting:" << trace_text;
+		if (!args.trace_file.empty())
+		{
+			if (threadtrace::writeChromeTrace(
+					args.trace_file, {trace.traceEvents(0)}))
+				cout << "Trace written to " << args.trace_file
+					 << endl;
+			else
+				cerr << "Unable to write trace file." << endl;
+		}
+	}
+
+	//? Hardware counters, a CSV of their own so that the regular
+	//? sequential CSV keeps its schema
+	if (counters)
+	{
+		const string perfCsvFile =
+			logutils::createCsvFilename(argv[1], "_seq_perf_");
+		const string perf_header =
+			header + perfcounters::csvHeaderColumns("Compute") +
+			perfcounters::csvHeaderColumns("Write");
+		bool has_perf_header =
+			logutils::csvFileHasHeader(perfCsvFile, perf_header);
+		ofstream perf_csv(perfCsvFile, ios::app);
+		if (perf_csv.is_open())
+		{
+			if (!has_perf_header)
+				perf_csv << perf_header << endl;
+			perf_csv << logutils::getCurrentTimestamp() << ","
+					 << fileName << "," << iterations << ","
+					 << resolution_value << "," << WIDTH << ","
+					 << HEIGHT << "," << STEP << ","
+					 << ""
+					 << "," << duration.count()
+					 << iterstats::csvColumns(iter_stats,
+											  duration.count())
+					 << run_phases.csvColumns()
+					 << perfcounters::csvColumns(compute_counters)
+					 << perfcounters::csvColumns(write_counters)
+					 << endl;
+		}
+		else
+		{
+			cerr << "Unable to open hardware counter CSV file."
+				 << endl;
+		}
+		ofstream perf_log(log_file, ios::app);
+		if (perf_log.is_open())
+		{
+			perf_log << "\tCompute counters:\t"
+					 << perfcounters::describe(compute_counters)
+					 << endl
+					 << "\tWrite counters:\t"
+					 << perfcounters::describe(write_counters)
+					 << endl;
+		}
+	}
+
+	//? Energy, a CSV of its own like the hardware counters
+	if (energy_probe)
+	{
+		cout << "Compute energy: "
+			 << energy::describe(compute_energy) << endl;
+		const string energyCsvFile =
+			logutils::createCsvFilename(argv[1], "_seq_energy_");
+		const string energy_header =
+			header + energy::csvHeaderColumns("Compute") +
+			energy::csvHeaderColumns("Write");
+		bool has_energy_header = logutils::csvFileHasHeader(
+			energyCsvFile, energy_header);
+		ofstream energy_csv(energyCsvFile, ios::app);
+		if (energy_csv.is_open())
+		{
+			if (!has_energy_header)
+				energy_csv << energy_header << endl;
+			energy_csv << logutils::getCurrentTimestamp() << ","
+					   << fileName << "," << iterations << ","
+					   << resolution_value << "," << WIDTH << ","
+					   << HEIGHT << "," << STEP << ","
+					   << ""
+					   << "," << duration.count()
+					   << iterstats::csvColumns(iter_stats,
+												duration.count())
+					   << run_phases.csvColumns()
+					   << energy::csvColumns(compute_energy)
+					   << energy::csvColumns(write_energy) << endl;
+		}
+		else
+		{
+			cerr << "Unable to open energy CSV file." << endl;
+		}
+		ofstream energy_log(log_file, ios::app);
+		if (energy_log.is_open())
+			energy_log << "\tCompute energy:\t"
+					   << energy::describe(compute_energy) << endl
+					   << "\tWrite energy:\t"
+					   << energy::describe(write_energy) << endl;
+	}
+
+	delete[] image; // It's here for coding style, but useless
+	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include <omp.h>
+
+#include <ImageIO.h>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// Every shard is copied by its own thread with pwrite, the output
+// file is preallocated so the writes never overlap
+bool mergeBinary(const imageio::ImageInfo &image,
+				 const string &output_file)
+{
+	const int fd = open(output_file.c_str(),
+						O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0)
+	{
+		cerr << "Unable to open file: " << output_file << endl;
+		return false;
+	}
+	const off_t row_bytes =
+		static_cast<off_t>(sizeof(int32_t)) * image.width;
+	char header[imageio::BINARY_HEADER_SIZE];
+	const int32_t fields[4] = {image.width, image.height, 0,
+							   image.height};
+	memcpy(header, imageio::BINARY_MAGIC,
+		   sizeof(imageio::BINARY_MAGIC));
+	memcpy(header + sizeof(imageio::BINARY_MAGIC), fields,
+		   sizeof(fields));
+	bool ok = pwrite(fd, header, sizeof(header), 0) ==
+				  static_cast<ssize_t>(sizeof(header)) &&
+			  ftruncate(fd, imageio::BINARY_HEADER_SIZE +
+								row_bytes * image.height) == 0;
+
+	const int shard_count = static_cast<int>(image.shards.size());
+#pragma omp parallel for schedule(dynamic) default(none)           \
+	shared(image, fd, row_bytes, shard_count) reduction(&& : ok)
+	for (int i = 0; i < shard_count; i++)
+	{
+		const imageio::ShardInfo &shard = image.shards[i];
+		vector<int> rows(static_cast<size_t>(shard.row_count) *
+						 image.width);
+		if (!imageio::readRows(image, shard.first_row,
+							   shard.row_count, rows.data()))
+		{
+			ok = false;
+			continue;
+		}
+		const off_t offset = imageio::BINARY_HEADER_SIZE +
+							 row_bytes * shard.first_row;
+		const ssize_t bytes =
+			static_cast<ssize_t>(row_bytes * shard.row_count);
+		// A failure must survive the thread's later shards
+		if (pwrite(fd, rows.data(), bytes, offset) != bytes)
+			ok = false;
+	}
+	close(fd);
+	return ok;
+}
+
+// The text format of the engines, bands are formatted in parallel
+// and written in order
+bool mergeText(const imageio::ImageInfo &image,
+			   const string &output_file)
+{
+	ofstream matrix_out(output_file, ios::trunc);
+	if (!matrix_out.is_open())
+	{
+		cerr << "Unable to open file: " << output_file << endl;
+		return false;
+	}
+	const int shard_count = static_cast<int>(image.shards.size());
+	vector<string> bands(shard_count);
+	bool ok = true;
+#pragma omp parallel for ordered schedule(dynamic) default(none)   \
+	shared(image, bands, shard_count, matrix_out) reduction(&& : ok)
+	for (int i = 0; i < shard_count; i++)
+	{
+		const imageio::ShardInfo &shard = image.shards[i];
+		vector<int> rows(static_cast<size_t>(shard.row_count) *
+						 image.width);
+		if (!imageio::readRows(image, shard.first_row,
+							   shard.row_count, rows.data()))
+			ok = false;
+		string band;
+		for (int row = 0; row < shard.row_count; row++)
+		{
+			for (int col = 0; col < image.width; col++)
+			{
+				band += to_string(rows[row * image.width + col]);
+				if (col < image.width - 1)
+					band += ',';
+			}
+			if (shard.first_row + row < image.height - 1)
+				band += '\n';
+		}
+#pragma omp ordered
+		matrix_out << band;
+	}
+	return ok && matrix_out.good();
+}
+
+int main(int argc, char **argv)
+{
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	if (argc < 3)
+	{
+		cerr << "Usage: " << fileName
+			 << " <manifest> <output_file> [--text]" << endl;
+		return -1;
+	}
+	const string manifest = argv[1];
+	const string output_file = argv[2];
+	const bool text = argc > 3 && string(argv[3]) == "--text";
+
+	const imageio::ImageInfo image = imageio::openImage(manifest);
+	if (image.width <= 0 || image.shards.empty())
+	{
+		cerr << "Unable to open manifest: " << manifest << endl;
+		return -2;
+	}
+	cout << "Merging " << image.shards.size() << " shards ("
+		 << image.width << "x" << image.height << ") with "
+		 << omp_get_max_threads() << " threads." << endl;
+	const bool ok = text ? mergeText(image, output_file)
+						 : mergeBinary(image, output_file);
+	if (!ok)
+	{
+		cerr << "Merge failed." << endl;
+		return -3;
+	}
+	cout << "Merged image written to " << output_file << endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,214 @@
+#include <omp.h>
+
+#include <ImageIO.h>
+#include <PointQuery.h>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// Points read, queried and written at a time
+constexpr int64_t DEFAULT_CHUNK = 1 << 20;
+
+// Parses a whole integer, `false` if `text` is not one
+bool parseInteger(const string &text, int64_t &value)
+{
+	try
+	{
+		size_t end = 0;
+		value = stoll(text, &end);
+		return end == text.size();
+	}
+	catch (const exception &)
+	{
+		return false;
+	}
+}
+
+/*
+ * Streams escape times of arbitrary points.
+ *
+ * The input is a sequence of points, each two native doubles (real,
+ * imaginary). The output is one 1 x count binary image, one row per
+ * point. When the input is a regular file its size gives the count,
+ * the header is written first and every chunk of points streams its
+ * rows; stdin, or a pipe, is answered chunk by chunk as well but
+ * the results are kept until the input ends, 4 bytes per point. "-"
+ * reads stdin or writes stdout, messages go to stderr.
+ */
+int main(int argc, char **argv)
+{
+	fs::path filePath = argv[0];
+	string fileName = filePath.filename().string();
+	if (argc < 3)
+	{
+		cerr
+			<< "Usage: " << fileName
+			<< " <points|-> <output|-> [--iterations <iterations>] "
+			   "[--threads <threads>] [--chunk <points>]"
+			<< endl;
+		return -1;
+	}
+	const string input_file = argv[1];
+	const string output_file = argv[2];
+	int64_t iterations = 1000;
+	int64_t threads = 0;
+	int64_t chunk = DEFAULT_CHUNK;
+	for (int i = 3; i < argc; i += 2)
+	{
+		const string flag = argv[i];
+		int64_t *value = flag == "--iterations" ? &iterations
+						 : flag == "--threads"	? &threads
+						 : flag == "--chunk"	? &chunk
+												: nullptr;
+		if (value == nullptr)
+		{
+			cerr << "Unknown option: " << flag << endl;
+			return -1;
+		}
+		if (i + 1 >= argc)
+		{
+			cerr << flag << " requires a value." << endl;
+			return -1;
+		}
+		if (!parseInteger(argv[i + 1], *value) || *value <= 0 ||
+			*value > INT32_MAX)
+		{
+			cerr << flag << " must be a positive integer, not "
+				 << argv[i + 1] << "." << endl;
+			return -1;
+		}
+	}
+	if (threads > 0)
+		omp_set_num_threads(static_cast<int>(threads));
+
+	ifstream input_stream;
+	if (input_file != "-")
+	{
+		input_stream.open(input_file, ios::binary);
+		if (!input_stream.is_open())
+		{
+			cerr << "Unable to open file: " << input_file << endl;
+			return -2;
+		}
+	}
+	istream &in = input_file == "-" ? cin : input_stream;
+	ofstream output_stream;
+	if (output_file != "-")
+	{
+		output_stream.open(output_file, ios::binary | ios::trunc);
+		if (!output_stream.is_open())
+		{
+			cerr << "Unable to open file: " << output_file << endl;
+			return -3;
+		}
+	}
+	ostream &out = output_file == "-" ? cout : output_stream;
+
+	// Points of a regular file, -1 when the count is only known at
+	// the end of the input
+	int64_t expected = -1;
+	error_code error;
+	if (input_file != "-" && fs::is_regular_file(input_file, error))
+	{
+		expected = static_cast<int64_t>(fs::file_size(input_file)) /
+				   static_cast<int64_t>(sizeof(complex<double>));
+		if (expected > INT32_MAX)
+		{
+			cerr << "More points than the binary format can index."
+				 << endl;
+			return -4;
+		}
+		if (!imageio::writeBinaryHeader(
+				out, 1, static_cast<int>(expected), 0,
+				static_cast<int>(expected)))
+		{
+			cerr << "Unable to write the results." << endl;
+			return -5;
+		}
+	}
+
+	vector<complex<double>> points(chunk);
+	vector<int> escape(chunk);
+	// Results of an input of unknown size
+	vector<int> results;
+	int64_t answered = 0;
+	double query_seconds = 0.0;
+	while (in)
+	{
+		in.read(reinterpret_cast<char *>(points.data()),
+				static_cast<streamsize>(sizeof(complex<double>)) *
+					chunk);
+		const int64_t count = in.gcount() / sizeof(complex<double>);
+		if (in.gcount() % sizeof(complex<double>) != 0)
+			cerr << "Ignoring a truncated point at the end of the "
+					"input."
+				 << endl;
+		if (count == 0)
+			break;
+		const auto start = chrono::steady_clock::now();
+		pointquery::query(points.data(), count,
+						  static_cast<int>(iterations),
+						  escape.data());
+		query_seconds += chrono::duration<double>(
+							 chrono::steady_clock::now() - start)
+							 .count();
+		if (expected >= 0)
+		{
+			if (answered + count > expected)
+			{
+				cerr << "The input grew while it was read." << endl;
+				return -4;
+			}
+			out.write(reinterpret_cast<const char *>(escape.data()),
+					  static_cast<streamsize>(sizeof(int)) * count);
+			if (!out)
+			{
+				cerr << "Unable to write the results." << endl;
+				return -5;
+			}
+		}
+		else
+		{
+			if (answered + count > INT32_MAX)
+			{
+				cerr << "More points than the binary format can "
+						"index."
+					 << endl;
+				return -4;
+			}
+			results.insert(results.end(), escape.begin(),
+						   escape.begin() + count);
+		}
+		answered += count;
+	}
+	if (expected >= 0 && answered != expected)
+	{
+		cerr << "The input shrank while it was read." << endl;
+		return -4;
+	}
+	if (expected < 0 &&
+		!imageio::writeBinary(out, results.data(), 1,
+							  static_cast<int>(answered), 0,
+							  static_cast<int>(answered)))
+	{
+		cerr << "Unable to write the results." << endl;
+		return -5;
+	}
+	out.flush();
+	cerr << "Answered " << answered << " points with "
+		 << omp_get_max_threads() << " threads in " << query_seconds
+		 << " seconds";
+	if (query_seconds > 0.0)
+		cerr << " (" << answered / query_seconds / 1e6
+			 << " million points/s)";
+	cerr << "." << endl;
+	return 0;
+}
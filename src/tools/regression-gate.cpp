@@ -0,0 +1,327 @@
+#include <BenchStats.h>
+#include <LogUtils.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// Compares a fresh run (a benchmark harness CSV or any engine CSV)
+// against the stored CSVs in data/. Rows are matched by their
+// configuration columns, the ones missing from a file are ignored,
+// and a change beyond the threshold counts only if it is also
+// statistically significant. Exits with 1 on a regression.
+
+// Columns that identify a configuration; the program name is not
+// one of them, so a new build is compared against the old numbers
+const vector<string> KEY_COLUMNS = {
+	"Engine",  "Iterations", "Resolution", "Scheduling",
+	"Threads", "Processes",	 "NProcesses", "CUDAThreads"};
+
+struct GateArgs
+{
+	string candidate_file;
+	vector<string> baseline_files;
+	// Percent change of the median that is reported at all
+	double threshold = 5.0;
+};
+
+vector<string> splitList(const string &list, char separator = ',')
+{
+	vector<string> items;
+	stringstream stream(list);
+	string item;
+	while (getline(stream, item, separator))
+		items.push_back(item);
+	return items;
+}
+
+GateArgs parseGateArguments(int argc, char **argv)
+{
+	GateArgs args;
+	const string fileName = fs::path(argv[0]).filename().string();
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--help")
+			{
+				cout << "Usage: " << fileName
+					 << " <candidate.csv> --baseline "
+						"<csv>[,<csv>...] "
+						"[--threshold <percent>]"
+					 << endl;
+				exit(EXIT_SUCCESS);
+			}
+			else if (arg.rfind("--", 0) == 0 && !has_value)
+			{
+				cerr << arg << " requires a value." << endl;
+				exit(EXIT_FAILURE);
+			}
+			else if (arg == "--baseline")
+			{
+				for (const string &file : splitList(argv[++i]))
+					if (!file.empty())
+						args.baseline_files.push_back(file);
+			}
+			else if (arg == "--threshold")
+				args.threshold = stod(argv[++i]);
+			else if (args.candidate_file.empty())
+				args.candidate_file = arg;
+			else
+			{
+				cerr << "Invalid argument or multiple candidate "
+						"files specified: "
+					 << arg << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	catch (const exception &e)
+	{
+		cerr << "Error parsing arguments: " << e.what() << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.candidate_file.empty() || args.baseline_files.empty())
+	{
+		cerr << "Please specify the candidate CSV and at least one "
+				"--baseline CSV."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.threshold < 0.0)
+	{
+		cerr << "--threshold must be >= 0." << endl;
+		exit(EXIT_FAILURE);
+	}
+	return args;
+}
+
+// The timings of one configuration in one file
+struct Group
+{
+	map<string, string> key;
+	vector<double> times;
+	// Set for benchmark harness rows, which carry their own summary
+	bool summarized = false;
+	benchstats::Summary summary;
+
+	benchstats::Summary result() const
+	{
+		return summarized ? summary : benchstats::summarize(times);
+	}
+};
+
+double column(const map<string, string> &row, const string &name)
+{
+	const auto it = row.find(name);
+	return it == row.end() || it->second.empty() ? 0.0
+												 : stod(it->second);
+}
+
+// Every configuration of a CSV, a header line starts a new schema
+// section. Harness rows keep the summary of their latest row, plain
+// engine rows collect one sample each.
+bool readGroups(const string &path, vector<Group> &groups)
+{
+	ifstream csv(path);
+	if (!csv.is_open())
+		return false;
+	string line;
+	vector<string> header;
+	while (getline(csv, line))
+	{
+		if (!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if (line.rfind("DateTime,", 0) == 0)
+		{
+			header = splitList(line);
+			continue;
+		}
+		vector<string> values = splitList(line);
+		if (header.empty() || values.size() > header.size())
+			continue;
+		// getline drops trailing empty fields
+		values.resize(header.size());
+		map<string, string> row;
+		for (size_t c = 0; c < header.size(); c++)
+			row[header[c]] = values[c];
+		if (row.find("Time (seconds)") == row.end())
+			continue;
+		map<string, string> key;
+		for (const string &name : KEY_COLUMNS)
+			if (row.count(name))
+				key[name] = row[name];
+		Group *group = nullptr;
+		for (Group &existing : groups)
+			if (existing.key == key)
+				group = &existing;
+		if (!group)
+		{
+			groups.push_back({key, {}, false, {}});
+			group = &groups.back();
+		}
+		try
+		{
+			if (row.count("Samples") && row.count("Mean (s)"))
+			{
+				benchstats::Summary &summary = group->summary;
+				summary.samples =
+					static_cast<int>(column(row, "Samples"));
+				summary.median = column(row, "Median (s)");
+				summary.min = column(row, "Min (s)");
+				summary.max = column(row, "Max (s)");
+				summary.mean = column(row, "Mean (s)");
+				summary.stddev = column(row, "Stddev (s)");
+				group->summarized = true;
+			}
+			else
+				group->times.push_back(
+					column(row, "Time (seconds)"));
+		}
+		catch (const exception &)
+		{
+			cerr << "Skipping malformed row in " << path << endl;
+		}
+	}
+	return true;
+}
+
+// Both keys agree on every column they have in common
+bool matches(const map<string, string> &a,
+			 const map<string, string> &b)
+{
+	for (const auto &entry : a)
+	{
+		const auto it = b.find(entry.first);
+		if (it != b.end() && it->second != entry.second)
+			return false;
+	}
+	return true;
+}
+
+string describeKey(const map<string, string> &key)
+{
+	string text;
+	for (const string &name : KEY_COLUMNS)
+	{
+		const auto it = key.find(name);
+		if (it == key.end() || it->second.empty())
+			continue;
+		text += (text.empty() ? "" : " ") + name + "=" + it->second;
+	}
+	return text;
+}
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	const GateArgs args = parseGateArguments(argc, argv);
+
+	vector<Group> candidates, baselines;
+	if (!readGroups(args.candidate_file, candidates))
+	{
+		cerr << "Unable to open candidate CSV: "
+			 << args.candidate_file << endl;
+		return EXIT_FAILURE;
+	}
+	for (const string &file : args.baseline_files)
+	{
+		if (!readGroups(file, baselines))
+		{
+			cerr << "Unable to open baseline CSV: " << file << endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	int regressions = 0, improvements = 0, unchanged = 0,
+		unmatched = 0;
+	ostringstream report;
+	report << "Regression gate:\t"
+		   << logutils::getCurrentTimestamp() << "\tCandidate:\t"
+		   << args.candidate_file << "\tThreshold:\t"
+		   << args.threshold << "\t%" << endl;
+	for (const Group &candidate : candidates)
+	{
+		// A single matching group keeps its own summary, several
+		// ones (e.g. from different files) are pooled by their
+		// times
+		Group pooled;
+		int matched = 0;
+		for (const Group &baseline : baselines)
+		{
+			if (!matches(candidate.key, baseline.key))
+				continue;
+			if (matched++ == 0)
+				pooled = baseline;
+			else
+			{
+				if (pooled.summarized)
+					pooled.times = {pooled.summary.median};
+				pooled.summarized = false;
+				if (baseline.summarized)
+					pooled.times.push_back(baseline.summary.median);
+				else
+					pooled.times.insert(pooled.times.end(),
+										baseline.times.begin(),
+										baseline.times.end());
+			}
+		}
+		if (matched == 0)
+		{
+			unmatched++;
+			continue;
+		}
+		const benchstats::Summary base = pooled.result();
+		const benchstats::Summary fresh = candidate.result();
+		const benchstats::Comparison comparison =
+			benchstats::compare(base, fresh);
+		const double percent = comparison.change * 100.0;
+		string verdict = "unchanged";
+		if (std::fabs(percent) >= args.threshold &&
+			comparison.significant)
+		{
+			verdict = percent > 0.0 ? "REGRESSION" : "improvement";
+			(percent > 0.0 ? regressions : improvements)++;
+		}
+		else
+			unchanged++;
+		report << "\t" << verdict << "\t"
+			   << describeKey(candidate.key) << "\tBaseline:\t"
+			   << base.median << "\ts (n=" << base.samples
+			   << ")\tCandidate:\t" << fresh.median
+			   << "\ts (n=" << fresh.samples << ")\tChange:\t"
+			   << percent << "\t%";
+		if (comparison.tested)
+			report << "\tt:\t" << comparison.t << "\tdf:\t"
+				   << comparison.degrees_of_freedom;
+		else
+			report << "\tuntested, single samples";
+		report << endl;
+	}
+	report << "\tSummary:\t" << regressions << "\tregressions\t"
+		   << improvements << "\timprovements\t" << unchanged
+		   << "\tunchanged\t" << unmatched << "\twithout baseline"
+		   << endl;
+	cout << report.str();
+	const string log_file = logutils::create_log_file_name(
+		args.candidate_file, "_regress_");
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+		log << report.str();
+	if (regressions + improvements + unchanged == 0)
+	{
+		cerr << "No configuration of the candidate has a baseline."
+			 << endl;
+		return EXIT_FAILURE;
+	}
+	return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,349 @@
+#include <BenchStats.h>
+#include <LogUtils.h>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// Strong and weak scaling series of the OpenMP binary (threads) or
+// the MPI binary (local ranks with one thread each). Every point is
+// a separate process; its time is the "Time (seconds)" column of
+// the CSV row it appends, read back from a scratch directory.
+
+struct ScalingArgs
+{
+	string output_file;
+	string engine = "openmp";
+	string binary;
+	string launcher = "mpirun";
+	vector<int> workers = {1, 2, 4, 8};
+	vector<string> series = {"strong", "weak"};
+	int resolution = 1000;
+	int iterations = 1000;
+	int repeat = 3;
+};
+
+vector<string> splitList(const string &list, char separator = ',')
+{
+	vector<string> items;
+	stringstream stream(list);
+	string item;
+	while (getline(stream, item, separator))
+	{
+		if (!item.empty())
+			items.push_back(item);
+	}
+	return items;
+}
+
+ScalingArgs parseScalingArguments(int argc, char **argv)
+{
+	ScalingArgs args;
+	const string fileName = fs::path(argv[0]).filename().string();
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const string arg = argv[i];
+			const bool has_value = i + 1 < argc;
+			if (arg == "--help")
+			{
+				cout
+					<< "Usage: " << fileName
+					<< " <output_file> [--engine openmp|mpi] "
+					   "[--binary <exe>] [--launcher <mpirun ...>] "
+					   "[--workers <list>] [--series strong,weak] "
+					   "[--resolution <resolution>] "
+					   "[--iterations <iterations>] [--repeat "
+					   "<runs>]"
+					<< endl;
+				exit(EXIT_SUCCESS);
+			}
+			else if (arg.rfind("--", 0) == 0 && !has_value)
+			{
+				cerr << arg << " requires a value." << endl;
+				exit(EXIT_FAILURE);
+			}
+			else if (arg == "--engine")
+				args.engine = argv[++i];
+			else if (arg == "--binary")
+				args.binary = argv[++i];
+			else if (arg == "--launcher")
+				args.launcher = argv[++i];
+			else if (arg == "--workers")
+			{
+				args.workers.clear();
+				for (const string &item : splitList(argv[++i]))
+					args.workers.push_back(stoi(item));
+			}
+			else if (arg == "--series")
+				args.series = splitList(argv[++i]);
+			else if (arg == "--resolution")
+				args.resolution = stoi(argv[++i]);
+			else if (arg == "--iterations")
+				args.iterations = stoi(argv[++i]);
+			else if (arg == "--repeat")
+				args.repeat = stoi(argv[++i]);
+			else if (args.output_file.empty())
+				args.output_file = arg;
+			else
+			{
+				cerr << "Invalid argument or multiple output "
+						"files specified: "
+					 << arg << endl;
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	catch (const exception &e)
+	{
+		cerr << "Error parsing arguments: " << e.what() << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.output_file.empty())
+	{
+		cerr << "Please specify the output file as a parameter."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.engine != "openmp" && args.engine != "mpi")
+	{
+		cerr << "Unknown engine: " << args.engine << endl;
+		exit(EXIT_FAILURE);
+	}
+	for (const string &name : args.series)
+	{
+		if (name != "strong" && name != "weak")
+		{
+			cerr << "Unknown series: " << name << endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (const int workers : args.workers)
+	{
+		if (workers <= 0)
+		{
+			cerr << "--workers values must be positive integers."
+				 << endl;
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (args.resolution <= 0 || args.iterations <= 0 ||
+		args.repeat <= 0)
+	{
+		cerr << "--resolution, --iterations and --repeat must be "
+				"positive."
+			 << endl;
+		exit(EXIT_FAILURE);
+	}
+	if (args.binary.empty())
+		args.binary = args.engine == "mpi"
+						  ? "./bin/mandelbrot_mpi.exe"
+						  : "./bin/mandelbrot_g++_DYNAMIC.exe";
+	// The single-worker baseline is always measured
+	bool has_baseline = false;
+	for (const int workers : args.workers)
+		has_baseline = has_baseline || workers == 1;
+	if (!has_baseline)
+		args.workers.insert(args.workers.begin(), 1);
+	return args;
+}
+
+// Last "Time (seconds)" value of a CSV written by one of the
+// binaries, negative if there is none
+double lastRunSeconds(const string &csv_file)
+{
+	ifstream csv(csv_file);
+	string line, last_row;
+	int time_column = -1;
+	while (getline(csv, line))
+	{
+		if (line.rfind("DateTime,", 0) == 0)
+		{
+			const vector<string> columns = splitList(line);
+			time_column = -1;
+			for (size_t c = 0; c < columns.size(); c++)
+				if (columns[c] == "Time (seconds)")
+					time_column = static_cast<int>(c);
+		}
+		else if (!line.empty())
+			last_row = line;
+	}
+	const vector<string> values = splitList(last_row);
+	if (time_column < 0 ||
+		time_column >= static_cast<int>(values.size()))
+		return -1.0;
+	return stod(values[time_column]);
+}
+
+struct ScalingRun
+{
+	string series;
+	int workers = 1;
+	int resolution = 0;
+	benchstats::Summary summary;
+	benchstats::ScalingPoint point;
+};
+
+string quoted(const string &text) { return "'" + text + "'"; }
+
+// Runs one point `repeat` times, the child output goes to a log in
+// the scratch directory
+benchstats::Summary measure(const ScalingArgs &args,
+							const fs::path &scratch, int workers,
+							int resolution)
+{
+	const fs::path out_file = scratch / "out" / "scaling.out";
+	const string csv_file =
+		(scratch / "data" /
+		 (args.engine == "mpi" ? "scaling.csv"
+							   : "scaling_openmp_.csv"))
+			.string();
+	ostringstream command;
+	if (args.engine == "mpi")
+		command << args.launcher << " -np " << workers << " "
+				<< quoted(fs::absolute(args.binary).string()) << " "
+				<< quoted(out_file.string())
+				<< " --threads-per-rank 1";
+	else
+		command << quoted(fs::absolute(args.binary).string()) << " "
+				<< quoted(out_file.string()) << " --threads "
+				<< workers;
+	command << " --iterations " << args.iterations
+			<< " --resolution " << resolution << " >> "
+			<< quoted((scratch / "runs.log").string()) << " 2>&1";
+
+	vector<double> samples;
+	for (int run = 0; run < args.repeat; run++)
+	{
+		if (system(command.str().c_str()) != 0)
+		{
+			cerr << "Run failed, see " << (scratch / "runs.log")
+				 << ": " << command.str() << endl;
+			exit(EXIT_FAILURE);
+		}
+		const double seconds = lastRunSeconds(csv_file);
+		if (seconds < 0.0)
+		{
+			cerr << "No timing found in " << csv_file << endl;
+			exit(EXIT_FAILURE);
+		}
+		samples.push_back(seconds);
+	}
+	return benchstats::summarize(samples);
+}
+
+int main(int argc, char **argv)
+{
+	cout.sync_with_stdio(false);
+	const string fileName = fs::path(argv[0]).filename().string();
+	const ScalingArgs args = parseScalingArguments(argc, argv);
+	if (!fs::exists(args.binary))
+	{
+		cerr << "Binary not found: " << args.binary << endl;
+		return -1;
+	}
+	const fs::path scratch =
+		fs::temp_directory_path() /
+		("mandelbrot_scaling_" + to_string(getpid()));
+	fs::create_directories(scratch / "out");
+
+	vector<ScalingRun> runs;
+	for (const string &series : args.series)
+	{
+		const bool weak = series == "weak";
+		double baseline_seconds = 0.0;
+		for (const int workers : args.workers)
+		{
+			// Weak scaling keeps the pixels per worker constant,
+			// both image sides grow with sqrt(p)
+			const int resolution =
+				weak ? static_cast<int>(
+						   lround(args.resolution * sqrt(workers)))
+					 : args.resolution;
+			cout << series << " scaling, " << workers
+				 << " workers, resolution " << resolution << "..."
+				 << endl;
+			ScalingRun run;
+			run.series = series;
+			run.workers = workers;
+			run.resolution = resolution;
+			run.summary =
+				measure(args, scratch, workers, resolution);
+			if (workers == 1)
+				baseline_seconds = run.summary.median;
+			runs.push_back(run);
+		}
+		for (ScalingRun &run : runs)
+			if (run.series == series)
+				run.point = benchstats::scalingPoint(
+					run.workers, baseline_seconds,
+					run.summary.median, weak);
+	}
+	fs::remove_all(scratch);
+
+	//? CSV, one row per point of every series
+	const string additinonalName = "_scaling_";
+	const string csvFile = logutils::createCsvFilename(
+		args.output_file, additinonalName);
+	const string header =
+		"DateTime,Program,Binary,Engine,Series,Workers,Iterations,"
+		"Resolution,Pixels,Repeat,Median (s),Min (s),Stddev (s),"
+		"Speedup,Efficiency,Karp-Flatt";
+	bool has_header = logutils::csvFileHasHeader(csvFile, header);
+	ofstream csv(csvFile, ios::app);
+	if (!csv.is_open())
+	{
+		cerr << "Unable to open CSV file." << endl;
+		return -1;
+	}
+	if (!has_header)
+		csv << header << endl;
+	const string timestamp = logutils::getCurrentTimestamp();
+	ostringstream report;
+	report << "Scaling report:\t" << timestamp << "\tBinary:\t"
+		   << args.binary << "\tEngine:\t" << args.engine
+		   << "\tIterations:\t" << args.iterations << "\tRepeat:\t"
+		   << args.repeat << endl;
+	for (const ScalingRun &run : runs)
+	{
+		// The binaries render a 3:2 image of the set's range
+		const long long pixels =
+			3LL * run.resolution * 2LL * run.resolution;
+		csv << timestamp << "," << fileName << "," << args.binary
+			<< "," << args.engine << "," << run.series << ","
+			<< run.workers << "," << args.iterations << ","
+			<< run.resolution << "," << pixels << "," << args.repeat
+			<< "," << run.summary.median << "," << run.summary.min
+			<< "," << run.summary.stddev << "," << run.point.speedup
+			<< "," << run.point.efficiency << ",";
+		if (run.workers > 1)
+			csv << run.point.karp_flatt;
+		csv << endl;
+		report << "\tSeries:\t" << run.series << "\tWorkers:\t"
+			   << run.workers << "\tResolution:\t" << run.resolution
+			   << "\tMedian:\t" << run.summary.median
+			   << "\tseconds\tSpeedup:\t" << run.point.speedup
+			   << "\tEfficiency:\t" << run.point.efficiency;
+		if (run.workers > 1)
+			report << "\tKarp-Flatt:\t" << run.point.karp_flatt;
+		report << endl;
+	}
+	csv.close();
+	cout << report.str();
+	const string log_file = logutils::create_log_file_name(
+		args.output_file, additinonalName);
+	ofstream log(log_file, ios::app);
+	if (log.is_open())
+		log << report.str();
+	cout << "CSV entries added to " << csvFile << endl;
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <ImageIO.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+using namespace std;
+
+/*
+ * Merges manifests with merge_shards.exe and checks its exit
+ * status: a complete manifest must merge, one with a truncated or a
+ * missing shard must fail. The broken shard comes first and a
+ * single thread merges, so a later good shard would hide the
+ * failure if it were overwritten.
+ */
+
+constexpr int WIDTH = 8;
+constexpr int SHARDS = 4;
+constexpr int ROWS_PER_SHARD = 3;
+
+// Writes the shards and their manifest under `dir`
+string writeImage(const fs::path &dir)
+{
+	fs::create_directories(dir);
+	imageio::ImageInfo image;
+	image.width = WIDTH;
+	image.height = SHARDS * ROWS_PER_SHARD;
+	image.iterations = 100;
+	for (int s = 0; s < SHARDS; s++)
+	{
+		vector<int> rows(WIDTH * ROWS_PER_SHARD, s + 1);
+		imageio::ShardInfo shard;
+		shard.path =
+			(dir / ("shard_" + to_string(s) + ".mbin")).string();
+		shard.first_row = s * ROWS_PER_SHARD;
+		shard.row_count = ROWS_PER_SHARD;
+		if (!imageio::writeBinary(shard.path, rows.data(), WIDTH,
+								  ROWS_PER_SHARD, shard.first_row,
+								  image.height))
+		{
+			cerr << "Unable to write " << shard.path << endl;
+			exit(EXIT_FAILURE);
+		}
+		image.shards.push_back(shard);
+	}
+	const string manifest = (dir / "image.manifest").string();
+	imageio::writeManifest(manifest, image);
+	return manifest;
+}
+
+// Exit status of the merge tool, -1 if it did not exit normally
+int merge(const string &tool, const string &manifest, bool text)
+{
+	const string command = "OMP_NUM_THREADS=1 " + tool + " " +
+						   manifest + " " + manifest +
+						   (text ? ".txt --text" : ".mbin") +
+						   " > /dev/null 2>&1";
+	const int status = system(command.c_str());
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int main(int argc, char **argv)
+{
+	const string tool =
+		argc > 1 ? argv[1] : "./bin/merge_shards.exe";
+	const fs::path root =
+		fs::temp_directory_path() / "merge-shards-test";
+	fs::remove_all(root);
+	int failures = 0;
+	auto expect = [&](const string &name, bool success, int status)
+	{
+		if ((status == 0) != success)
+		{
+			cerr << "FAIL: " << name << " exited with " << status
+				 << endl;
+			failures++;
+		}
+		else
+			cout << "ok: " << name << endl;
+	};
+
+	const string complete = writeImage(root / "complete");
+	expect("complete binary", true, merge(tool, complete, false));
+	expect("complete text", true, merge(tool, complete, true));
+
+	const string truncated = writeImage(root / "truncated");
+	fs::resize_file(root / "truncated" / "shard_0.mbin",
+					imageio::BINARY_HEADER_SIZE +
+						sizeof(int) * WIDTH);
+	expect("truncated shard binary", false,
+		   merge(tool, truncated, false));
+	expect("truncated shard text", false,
+		   merge(tool, truncated, true));
+
+	const string missing = writeImage(root / "missing");
+	fs::remove(root / "missing" / "shard_0.mbin");
+	expect("missing shard binary", false,
+		   merge(tool, missing, false));
+	expect("missing shard text", false, merge(tool, missing, true));
+
+	fs::remove_all(root);
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}